@@ -28,6 +28,7 @@
  */
 
 #include <stdlib.h>  /* for workaround_locale_bug() */
+#include <errno.h>
 
 #include "linkparser.h"
 
@@ -148,8 +149,29 @@ rlink_make_oldstyle_dict( dict_file, pp_file, cons_file, affix_file )
  *  Create a new LinkParser::Dictionary with data files for the given +language+, or
  *  using the specified data files.
  *
+ *  The +options+ are the default parse options for sentences parsed with the
+ *  new Dictionary. They're compiled once, into the frozen ParseOptions 
+ *  returned by #parse_options, so changing them afterward means making a new
+ *  Dictionary. The +options+ can also include:
  *
+ *  [:cache]
+ *    Keep the results of up to this many bytes' worth of recent parses, so that
+ *    repeated sentences aren't parsed again. See #cache_stats.
  *
+ *     dict = LinkParser::Dictionary.new( 'en', :cache => 4 * 1024 * 1024 )
+ *
+ *  [:store]
+ *    The path of a file to keep parses in, so that they're reused by later
+ *    runs as well. Only one process at a time adds to a store; any others
+ *    that open it only read it. Parses made with different dictionary files
+ *    are never reused.
+ *
+ *     dict = LinkParser::Dictionary.new( 'en', :store => 'parses.lgstore' )
+ *
+ *  [:word_cache]
+ *    The number of words to remember how to split up and look up, so that
+ *    common words are tokenized once rather than in every sentence. The
+ *    default is 4096; 0 turns the word cache off. See #word_cache_stats.
  */
 static VALUE
 rlink_dict_initialize( argc, argv, self )
@@ -194,7 +216,8 @@ rlink_dict_initialize( argc, argv, self )
 		  case 4:
 		  case 5:
 			debugMsg(( "Four or five args: old-style explicit dict files." ));
-			dict = rlink_make_oldstyle_dict( arg1, arg2, arg3, arg4, arg5 );
+			dict = rlink_make_oldstyle_dict( arg1, arg2, arg3, arg4 );
+			opthash = arg5;
 			break;
 		
 		  /* Anything else is an error */	
@@ -220,9 +243,41 @@ rlink_dict_initialize( argc, argv, self )
 
 		DATA_PTR( self ) = dict;
 
-		/* If they passed in an options hash, save it for later. */
-		if ( RTEST(opthash) ) rb_iv_set( self, "@options", opthash );
-		else rb_iv_set( self, "@options", rb_hash_new() );
+		/* The cache sizes and store path aren't parse options, so take them
+		   out of the options hash before saving it. */
+		if ( RTEST(opthash) ) {
+			VALUE cache_size, store_path, word_cache_size;
+
+			opthash = rb_obj_dup( opthash );
+			cache_size = rb_hash_delete( opthash, ID2SYM(rb_intern("cache")) );
+			if ( RTEST(cache_size) ) {
+				debugMsg(( "Enabling a parse cache of %ld bytes", NUM2LONG(cache_size) ));
+				dictionary_set_parse_cache_size( dict, NUM2LONG(cache_size) );
+			}
+
+			word_cache_size = rb_hash_delete( opthash, ID2SYM(rb_intern("word_cache")) );
+			if ( !NIL_P(word_cache_size) ) {
+				debugMsg(( "Setting the word cache to %d words", NUM2INT(word_cache_size) ));
+				dictionary_set_word_cache_size( dict, NUM2INT(word_cache_size) );
+			}
+
+			store_path = rb_hash_delete( opthash, ID2SYM(rb_intern("store")) );
+			if ( RTEST(store_path) ) {
+				store_path = rb_obj_as_string( store_path );
+				SafeStringValue( store_path );
+				debugMsg(( "Opening the parse store %s", STR2CSTR(store_path) ));
+				if ( dictionary_open_parse_store(dict, STR2CSTR(store_path)) < 0 )
+					rb_raise( rlink_eLpError, "Couldn't open the parse store %s",
+						STR2CSTR(store_path) );
+			}
+		}
+
+		/* If they passed in an options hash, save it for later, and compile
+		   it into the ParseOptions every sentence starts from. */
+		if ( !RTEST(opthash) ) opthash = rb_hash_new();
+		rb_iv_set( self, "@options", rb_obj_freeze(opthash) );
+		rb_iv_set( self, "@parse_options", 
+			rb_obj_freeze(rb_class_new_instance(1, &opthash, rlink_cParseOptions)) );
 	}
 
 	else {
@@ -266,11 +321,122 @@ rlink_get_max_cost( self )
 }
 
 
+/*
+ *  call-seq:
+ *     dictionary.cache_stats   -> hash
+ *
+ *  Returns a Hash describing the Dictionary's parse cache: its size limit
+ *  (+:max_bytes+), the bytes it currently holds, the number of sentences
+ *  it holds, and its hits, misses, evictions and hit rate. All of them are
+ *  zero if the Dictionary was created without a +:cache+ option. The
+ *  +:store_hits+ and +:store_records+ entries count the sentences found in
+ *  the +:store+ file and the ones it holds for this Dictionary.
+ *
+ *     dict.cache_stats[:hit_rate]   # -> 0.75
+ */
+static VALUE
+rlink_get_cache_stats( self )
+	VALUE self;
+{
+	Dictionary dict = get_dict( self );
+	VALUE stats = rb_hash_new();
+	long hits = dictionary_get_parse_cache_hits( dict );
+	long misses = dictionary_get_parse_cache_misses( dict );
+	double hit_rate = 0.0;
+
+	if ( hits + misses > 0 ) hit_rate = (double)hits / (double)(hits + misses);
+
+	rb_hash_aset( stats, ID2SYM(rb_intern("max_bytes")),
+		LONG2NUM(dictionary_get_parse_cache_size( dict )) );
+	rb_hash_aset( stats, ID2SYM(rb_intern("bytes")),
+		LONG2NUM(dictionary_get_parse_cache_bytes( dict )) );
+	rb_hash_aset( stats, ID2SYM(rb_intern("entries")),
+		LONG2NUM(dictionary_get_parse_cache_entries( dict )) );
+	rb_hash_aset( stats, ID2SYM(rb_intern("hits")), LONG2NUM(hits) );
+	rb_hash_aset( stats, ID2SYM(rb_intern("misses")), LONG2NUM(misses) );
+	rb_hash_aset( stats, ID2SYM(rb_intern("evictions")),
+		LONG2NUM(dictionary_get_parse_cache_evictions( dict )) );
+	rb_hash_aset( stats, ID2SYM(rb_intern("hit_rate")), rb_float_new(hit_rate) );
+	rb_hash_aset( stats, ID2SYM(rb_intern("store_hits")),
+		LONG2NUM(dictionary_get_parse_store_hits( dict )) );
+	rb_hash_aset( stats, ID2SYM(rb_intern("store_records")),
+		LONG2NUM(dictionary_get_parse_store_records( dict )) );
+
+	return stats;
+}
+
+
+/*
+ *  call-seq:
+ *     dictionary.word_cache_stats   -> hash
+ *
+ *  Returns a Hash describing the Dictionary's word cache: the number of
+ *  words it holds at most (+:max_entries+), and its hits, misses and hit
+ *  rate. There's a lookup for each word the tokenizer splits up and for
+ *  each word it looks up.
+ *
+ *     dict.word_cache_stats[:hit_rate]   # -> 0.96
+ */
+static VALUE
+rlink_get_word_cache_stats( self )
+	VALUE self;
+{
+	Dictionary dict = get_dict( self );
+	VALUE stats = rb_hash_new();
+	long hits = dictionary_get_word_cache_hits( dict );
+	long misses = dictionary_get_word_cache_misses( dict );
+	double hit_rate = 0.0;
+
+	if ( hits + misses > 0 ) hit_rate = (double)hits / (double)(hits + misses);
+
+	rb_hash_aset( stats, ID2SYM(rb_intern("max_entries")),
+		INT2NUM(dictionary_get_word_cache_size( dict )) );
+	rb_hash_aset( stats, ID2SYM(rb_intern("hits")), LONG2NUM(hits) );
+	rb_hash_aset( stats, ID2SYM(rb_intern("misses")), LONG2NUM(misses) );
+	rb_hash_aset( stats, ID2SYM(rb_intern("hit_rate")), rb_float_new(hit_rate) );
+
+	return stats;
+}
+
+
+/*
+ *  call-seq:
+ *     dictionary.unknown_word_stats   -> hash
+ *
+ *  Returns a Hash describing how the Dictionary's parses with 
+ *  ParseOptions#unknown_word_disjuncts set have gone: how many of them cut 
+ *  down the disjuncts of an unknown word (+:limited+), how many of those 
+ *  had to fall back to all of them (+:fallbacks+), and the 
+ *  +:fallback_rate+.
+ *
+ *     dict.unknown_word_stats[:fallback_rate]   # -> 0.08
+ */
+static VALUE
+rlink_get_unknown_word_stats( self )
+	VALUE self;
+{
+	Dictionary dict = get_dict( self );
+	VALUE stats = rb_hash_new();
+	long limited = dictionary_get_unknown_word_limits( dict );
+	long fallbacks = dictionary_get_unknown_word_fallbacks( dict );
+	double fallback_rate = 0.0;
+
+	if ( limited > 0 ) fallback_rate = (double)fallbacks / (double)limited;
+
+	rb_hash_aset( stats, ID2SYM(rb_intern("limited")), LONG2NUM(limited) );
+	rb_hash_aset( stats, ID2SYM(rb_intern("fallbacks")), LONG2NUM(fallbacks) );
+	rb_hash_aset( stats, ID2SYM(rb_intern("fallback_rate")), rb_float_new(fallback_rate) );
+
+	return stats;
+}
+
+
 /*
  * parse( sentence_string )
+ * parse( words )
  * --
- * Parse the specified +sentence_string+ with the receiving Dictionary and
- * return a LinkParser::Sentence.
+ * Parse the specified +sentence_string+ (or Array of already-tokenized
+ * +words+) with the receiving Dictionary and return a LinkParser::Sentence.
  */
 static VALUE 
 rlink_parse( argc, argv, self )
@@ -301,6 +467,114 @@ rlink_parse( argc, argv, self )
 
 
 
+/* The number of sentences a stream reads ahead of the one being parsed */
+#define RLINK_STREAM_PENDING 16
+
+struct rlink_stream_args {
+	VALUE           self;
+	VALUE           options;
+	Sentence_stream stream;
+};
+
+/* Parse and yield each sentence of a stream in turn. */
+static VALUE
+rlink_parse_stream_each( argp )
+	VALUE argp;
+{
+	struct rlink_stream_args *args = (struct rlink_stream_args *)argp;
+	VALUE sentence;
+	VALUE sargs[2];
+	char *text;
+
+	for ( ;; ) {
+		/* Wait for the reader without holding up the other threads, one 
+		   of which may be the one writing the stream */
+		while ( !sentence_stream_ready(args->stream) )
+			rb_thread_wait_fd( sentence_stream_wait_fd(args->stream) );
+		if ( (text = sentence_stream_next(args->stream)) == NULL ) break;
+
+		sargs[0] = rb_str_new2( text );
+		sargs[1] = args->self;
+		sentence = rb_class_new_instance( 2, sargs, rlink_cSentence );
+		rb_funcall( sentence, rb_intern("parse"), 1, args->options );
+		rb_yield( sentence );
+	}
+
+	if ( sentence_stream_error(args->stream) ) {
+		errno = sentence_stream_error( args->stream );
+		rb_sys_fail( "parse_stream" );
+	}
+
+	return args->self;
+}
+
+
+/* Stop the stream's reader, however the parsing ended. */
+static VALUE
+rlink_parse_stream_done( argp )
+	VALUE argp;
+{
+	struct rlink_stream_args *args = (struct rlink_stream_args *)argp;
+
+	sentence_stream_delete( args->stream );
+	return Qnil;
+}
+
+
+/*
+ * parse_stream( io, options={} ) {|sentence| ... }
+ * --
+ * Read text from +io+ (an IO, or anything else with a #fileno, or a file 
+ * descriptor) until it runs out, split it into sentences, and yield each one 
+ * to the block as a parsed LinkParser::Sentence, in the order they appear. 
+ * The +options+ are the same as for #parse.
+ * 
+ * The text is read in chunks, and split into sentences in C by a reader 
+ * that keeps a few sentences ahead of the one being parsed, so reading 
+ * overlaps with parsing and only a chunk of the text is held at a time. 
+ * The descriptor is read directly, so anything the +io+ has already 
+ * buffered is skipped, and it's left open afterward. Other threads keep 
+ * running while it waits for text, so the +io+ can be a pipe that one of 
+ * them is writing.
+ * 
+ * A sentence ends at a blank line, or at a '.', '!' or '?' that's followed 
+ * by a capitalized word; a '.' after an initial or a common abbreviation 
+ * like "Mr." doesn't end one.
+ */
+static VALUE
+rlink_parse_stream( argc, argv, self )
+	int argc;
+	VALUE *argv;
+	VALUE self;
+{
+	VALUE io, options, fileno;
+	struct rlink_stream_args args;
+
+	rb_scan_args( argc, argv, "11", &io, &options );
+	if ( !rb_block_given_p() )
+		rb_raise( rb_eLocalJumpError, "no block given" );
+
+	if ( FIXNUM_P(io) )
+		fileno = io;
+	else if ( rb_respond_to(io, rb_intern("fileno")) )
+		fileno = rb_funcall( io, rb_intern("fileno"), 0 );
+	else
+		rb_raise( rb_eTypeError, "can't read sentences from a %s", 
+			rb_class2name(CLASS_OF( io )) );
+
+	args.self = self;
+	args.options = rlink_make_parse_options( rb_iv_get(self, "@parse_options"), options );
+	args.stream = sentence_stream_create( NUM2INT(fileno), RLINK_STREAM_PENDING );
+	if ( !args.stream )
+		rb_raise( rlink_eLpError, "Couldn't start reading sentences" );
+
+	return rb_ensure( rlink_parse_stream_each, (VALUE)&args, 
+		rlink_parse_stream_done, (VALUE)&args );
+}
+
+
+
+
 
 /* 
  * Document-class: LinkParser::Dictionary
@@ -327,8 +601,13 @@ rlink_init_dict(void)
 	rb_define_method( rlink_cDictionary, "initialize", rlink_dict_initialize, -1 );
 
 	rb_define_method( rlink_cDictionary, "max_cost", rlink_get_max_cost, 0 );
+	rb_define_method( rlink_cDictionary, "cache_stats", rlink_get_cache_stats, 0 );
+	rb_define_method( rlink_cDictionary, "word_cache_stats", rlink_get_word_cache_stats, 0 );
+	rb_define_method( rlink_cDictionary, "unknown_word_stats", rlink_get_unknown_word_stats, 0 );
 	rb_define_method( rlink_cDictionary, "parse", rlink_parse, -1 );
+	rb_define_method( rlink_cDictionary, "parse_stream", rlink_parse_stream, -1 );
 
 	rb_define_attr( rlink_cDictionary, "options", 1, 0 );
+	rb_define_attr( rlink_cDictionary, "parse_options", 1, 0 );
 }
 
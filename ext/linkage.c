@@ -34,7 +34,8 @@
  *  Forward declarations
  * -------------------------------------------------- */
 
-static VALUE rlink_linkage_make_cnode_array( CNode * );
+static VALUE rlink_linkage_make_cnode_array( const CNode * );
+static void rlink_linkage_flatten_cnodes( VALUE, const CNode *, VALUE, long * );
 
 
 /* --------------------------------------------------
@@ -55,6 +56,13 @@ rlink_linkage_alloc()
 	
 	ptr->linkage	= NULL;
 	ptr->sentence	= Qnil;
+	ptr->index		= 0;
+	ptr->reparses	= 0;
+	ptr->options	= Qnil;
+	ptr->words		= Qnil;
+	ptr->links		= Qnil;
+	ptr->dictionary	= Qnil;
+	ptr->memsize	= 0;
 	
 	debugMsg(( "Initialized an rlink_LINKAGE <%p>", ptr ));
 	return ptr;
@@ -72,6 +80,10 @@ rlink_linkage_gc_mark( ptr )
 	
 	if ( ptr ) {
 		rb_gc_mark( ptr->sentence );
+		rb_gc_mark( ptr->options );
+		rb_gc_mark( ptr->words );
+		rb_gc_mark( ptr->links );
+		rb_gc_mark( ptr->dictionary );
 	}
 	
 	else {
@@ -88,9 +100,14 @@ rlink_linkage_gc_free( ptr )
 	rlink_LINKAGE *ptr;
 {
 	if ( ptr ) {
-		linkage_delete( (Linkage)ptr->linkage );
+		if ( ptr->linkage ) linkage_delete( (Linkage)ptr->linkage );
+		rlink_track_memory( &ptr->memsize, 0 );
 		ptr->linkage = NULL;
 		ptr->sentence = Qnil;
+		ptr->options = Qnil;
+		ptr->words = Qnil;
+		ptr->links = Qnil;
+		ptr->dictionary = Qnil;
 	}
 	
 	else {
@@ -118,6 +135,35 @@ check_linkage( self )
 }
 
 
+/*
+ * Build the link-grammar linkage for a Linkage made by 
+ * rlink_make_lazy_linkage(), using the parse options of its sentence, 
+ * unless the sentence has been parsed again since.
+ */
+static void
+rlink_linkage_materialize( ptr )
+	rlink_LINKAGE *ptr;
+{
+	rlink_SENTENCE *sent_ptr = rlink_get_sentence( ptr->sentence );
+	Linkage linkage;
+
+	debugMsg(( "Materializing linkage %d of Sentence <%p>", ptr->index, sent_ptr ));
+	if ( ptr->reparses != sent_ptr->reparses )
+		rb_raise( rlink_eLpError, "Linkage is from an earlier parse of its sentence" );
+	ptr->options = sent_ptr->options;
+	linkage = linkage_create( ptr->index, (Sentence)sent_ptr->sentence,
+		rlink_get_parseopts(ptr->options) );
+	if ( !linkage ) rlink_raise_lp_error();
+
+	ptr->linkage = linkage;
+	rlink_track_memory( &ptr->memsize, linkage_memory_in_use(linkage) );
+
+	/* The sentence may have been parsed again, or compacted */
+	rlink_track_memory( &sent_ptr->memsize, 
+		sentence_memory_in_use((Sentence)sent_ptr->sentence) );
+}
+
+
 /*
  * Fetch the data pointer and check it for sanity.
  */
@@ -130,11 +176,28 @@ get_linkage( self )
 	debugMsg(( "Fetching a Linkage (%p).", ptr ));
 	if ( !ptr )
 		rb_raise( rb_eRuntimeError, "uninitialized Linkage" );
+	if ( !ptr->linkage && NIL_P(ptr->sentence) )
+		rb_raise( rlink_eLpError, "Linkage has been freed" );
+	if ( !ptr->linkage )
+		rlink_linkage_materialize( ptr );
 
 	return ptr;
 }
 
 
+/*
+ * Make sure the sentence a linkage was made from, if it had one, hasn't 
+ * been freed; the constituent tree is worked out from the sentence's words.
+ */
+static void
+check_linkage_sentence( ptr )
+	rlink_LINKAGE *ptr;
+{
+	if ( !NIL_P(ptr->sentence) )
+		rlink_get_sentence( ptr->sentence );
+}
+
+
 /*
  * Publicly-usable linkage-fetcher
  */
@@ -146,6 +209,29 @@ rlink_get_linkage( self )
 
 
 
+/*
+ * Make a LinkParser::Linkage for the linkage at +index+ of the given 
+ * (parsed) sentence without building it. The link-grammar linkage is only 
+ * created when one of the Linkage's methods first needs it.
+ */
+VALUE
+rlink_make_lazy_linkage( index, sentence )
+	int index;
+	VALUE sentence;
+{
+	rlink_LINKAGE *ptr = rlink_linkage_alloc();
+	rlink_SENTENCE *sent_ptr = rlink_get_sentence( sentence );
+
+	ptr->index = index;
+	ptr->sentence = sentence;
+	ptr->reparses = sent_ptr->reparses;
+
+	return Data_Wrap_Struct( rlink_cLinkage, rlink_linkage_gc_mark, 
+		rlink_linkage_gc_free, ptr );
+}
+
+
+
 /* --------------------------------------------------
  * Class Methods
  * -------------------------------------------------- */
@@ -165,6 +251,42 @@ rlink_linkage_s_alloc( klass )
 }
 
 
+/*
+ *  call-seq:
+ *     LinkParser::Linkage.from_packed( packed, dictionary )   -> LinkParser::Linkage
+ *
+ *  Rebuild a linkage from the String returned by Linkage#to_packed, using
+ *  the given +dictionary+ (and its parse options) to display it. The new
+ *  Linkage has no sentence, so its #constituent_tree is empty.
+ *
+ *     packed = dict.parse( "The flag was wet." ).linkages.first.to_packed
+ *     linkage = LinkParser::Linkage.from_packed( packed, dict )
+ */
+static VALUE
+rlink_linkage_s_from_packed( klass, packed, dictionary )
+	VALUE klass, packed, dictionary;
+{
+	Dictionary dict = rlink_get_dict( dictionary );
+	VALUE options = rb_iv_get( dictionary, "@parse_options" );
+	rlink_LINKAGE *ptr;
+	Linkage linkage;
+
+	StringValue( packed );
+	linkage = linkage_unpack( RSTRING(packed)->ptr, RSTRING(packed)->len, dict, 
+		rlink_get_parseopts(options) );
+	if ( !linkage )
+		rb_raise( rlink_eLpError, "Invalid packed linkage" );
+
+	ptr = rlink_linkage_alloc();
+	ptr->linkage = linkage;
+	ptr->dictionary = dictionary;
+	ptr->options = options;
+	rlink_track_memory( &ptr->memsize, linkage_memory_in_use(linkage) );
+
+	return Data_Wrap_Struct( klass, rlink_linkage_gc_mark, rlink_linkage_gc_free, ptr );
+}
+
+
 /* --------------------
  * Instance methods
  * -------------------- */
@@ -175,8 +297,9 @@ rlink_linkage_s_alloc( klass )
  *
  *  Create a new LinkParser::Linkage object out of the linkage indicated by
  *  +index+ (a positive Integer) from the specified sentence (a 
- *  LinkParser::Sentence). The optional options hash can be used to override
- *  the parse options of the Sentence for the new linkage.
+ *  LinkParser::Sentence). The optional options hash (or ParseOptions object)
+ *  can be used to override the parse options of the Sentence for the new
+ *  linkage.
  */
 static VALUE
 rlink_linkage_init( argc, argv, self )
@@ -194,12 +317,14 @@ rlink_linkage_init( argc, argv, self )
 		
 		i = rb_scan_args( argc, argv, "21", &index, &sentence, &options );
 
-		defopts = rb_hash_new(); /*rb_funcall( sentence, rb_intern("options"), 0 );*/
+		sent_ptr = (rlink_SENTENCE *)rlink_get_sentence( sentence );
+
+		defopts = sent_ptr->options;
+		if ( NIL_P(defopts) )
+			defopts = rb_iv_get( sent_ptr->dictionary, "@parse_options" );
 		options = rlink_make_parse_options( defopts, options );
 		opts = rlink_get_parseopts( options );
 
-		sent_ptr = (rlink_SENTENCE *)rlink_get_sentence( sentence );
-
 		link_index = NUM2INT(index);
 		max_index = sentence_num_valid_linkages((Sentence)sent_ptr->sentence) - 1;
 		if ( link_index > max_index )
@@ -213,6 +338,11 @@ rlink_linkage_init( argc, argv, self )
 		
 		ptr->linkage = linkage;
 		ptr->sentence = sentence;
+		ptr->index = link_index;
+		ptr->options = options;
+		rlink_track_memory( &ptr->memsize, linkage_memory_in_use(linkage) );
+		rlink_track_memory( &sent_ptr->memsize, 
+			sentence_memory_in_use((Sentence)sent_ptr->sentence) );
 	}
 	
 	else {
@@ -225,6 +355,33 @@ rlink_linkage_init( argc, argv, self )
 
 
 
+/*
+ *  call-seq:
+ *     to_packed   -> str
+ *
+ *  Return the linkage packed into a compact binary String, for handing to
+ *  another process or keeping. It holds the words, links, domains, costs and
+ *  violation of every sublinkage, and can be turned back into a Linkage with
+ *  LinkParser::Linkage.from_packed by the same version of the library on the
+ *  same kind of machine.
+ */
+static VALUE
+rlink_linkage_to_packed( self )
+	VALUE self;
+{
+	rlink_LINKAGE *ptr = get_linkage( self );
+	char *packed;
+	int size;
+	VALUE rval;
+
+	packed = linkage_pack( (Linkage)ptr->linkage, &size );
+	rval = rb_str_new( packed, size );
+	linkage_pack_delete( packed );
+
+	return rval;
+}
+
+
 /*
  *  call-seq:
  *     diagram   -> str
@@ -562,7 +719,8 @@ rlink_linkage_get_link_domain_names( self, index )
  *
  *  Return the Array of word spellings or individual word spelling for the 
  *  current sublinkage. These are the "inflected" spellings, such as "dog.n". 
- *  The original spellings can be obtained by calls to Sentence#words.
+ *  The original spellings can be obtained by calls to Sentence#words. The
+ *  Array is built the first time it's asked for, and is frozen.
  */
 static VALUE
 rlink_linkage_get_words( self )
@@ -573,15 +731,86 @@ rlink_linkage_get_words( self )
 	int count, i;
 	VALUE words_ary;
 	
+	if ( RTEST(ptr->words) ) return ptr->words;
+
 	count = linkage_get_num_words( (Linkage)ptr->linkage );
 	words = linkage_get_words( (Linkage)ptr->linkage );
 	words_ary = rb_ary_new2( count );
 	
 	for ( i = 0; i < count; i++ ) {
-		rb_ary_store( words_ary, i, rb_str_new2(words[i]) );
+		rb_ary_store( words_ary, i, rb_obj_freeze(rb_str_new2(words[i])) );
 	}
 	
-	return words_ary;
+	ptr->words = rb_obj_freeze( words_ary );
+	return ptr->words;
+}
+
+
+/*
+ * Return the description of the link type of the given +label+ from 
+ * LinkParser::Linkage::LinkTypes, ignoring its subscripts.
+ */
+static VALUE
+rlink_linkage_link_desc( label )
+	const char *label;
+{
+	VALUE link_types = rb_const_get( rlink_cLinkage, rb_intern("LinkTypes") );
+	char type[ 8 ];
+	int i = 0;
+
+	for ( ; *label && i < (int)sizeof(type) - 1; label++ )
+		if ( *label >= 'A' && *label <= 'Z' ) type[i++] = *label;
+	type[i] = '\0';
+	if ( i == 0 ) return Qnil;
+
+	return rb_hash_aref( link_types, ID2SYM(rb_intern(type)) );
+}
+
+
+/*
+ *  call-seq:
+ *     links   -> array
+ *
+ *  Return an Array of LinkParser::Linkage::Link structs describing the links 
+ *  of the current sublinkage. The Array is built in one pass the first time 
+ *  it's asked for, and it and its Links are frozen.
+ */
+static VALUE
+rlink_linkage_get_links( self )
+	VALUE self;
+{
+	rlink_LINKAGE *ptr = get_linkage( self );
+	Linkage linkage = (Linkage)ptr->linkage;
+	int current = linkage_get_current_sublinkage( linkage );
+	int count, i;
+	VALUE words, links_ary, link;
+	const char *label;
+
+	if ( !RTEST(ptr->links) ) ptr->links = rb_ary_new();
+	links_ary = rb_ary_entry( ptr->links, current );
+	if ( RTEST(links_ary) ) return links_ary;
+
+	words = rlink_linkage_get_words( self );
+	count = linkage_get_num_links( linkage );
+	links_ary = rb_ary_new2( count );
+
+	for ( i = 0; i < count; i++ ) {
+		label = linkage_get_link_label( linkage, i );
+		link = rb_struct_new( rlink_sLinkageLink,
+			rb_ary_entry( words, linkage_get_link_lword(linkage, i) ),
+			rb_ary_entry( words, linkage_get_link_rword(linkage, i) ),
+			INT2FIX( linkage_get_link_length(linkage, i) ),
+			rb_obj_freeze( rb_str_new2(label) ),
+			rb_obj_freeze( rb_str_new2(linkage_get_link_llabel(linkage, i)) ),
+			rb_obj_freeze( rb_str_new2(linkage_get_link_rlabel(linkage, i)) ),
+			rlink_linkage_link_desc( label )
+		  );
+		rb_ary_store( links_ary, i, rb_obj_freeze(link) );
+	}
+
+	rb_obj_freeze( links_ary );
+	rb_ary_store( ptr->links, current, links_ary );
+	return links_ary;
 }
 
 
@@ -607,6 +836,7 @@ rlink_linkage_compute_union( self )
 	before = linkage_get_num_sublinkages( (Linkage)ptr->linkage );
 	linkage_compute_union( (Linkage)ptr->linkage );
 	after = linkage_get_num_sublinkages( (Linkage)ptr->linkage );
+	rlink_track_memory( &ptr->memsize, linkage_memory_in_use((Linkage)ptr->linkage) );
 	
 	return (after > before) ? Qtrue : Qfalse;
 }
@@ -802,23 +1032,22 @@ rlink_linkage_constituent_tree( self )
 	VALUE self;
 {
 	rlink_LINKAGE *ptr = get_linkage( self );
-	CNode *ctree = NULL;
-	VALUE rval = Qnil;
+	const CNode *ctree = NULL;
 	
-	ctree = linkage_constituent_tree( (Linkage)ptr->linkage );
-	rval = rlink_linkage_make_cnode_array( ctree );
+	check_linkage_sentence( ptr );
+	ctree = linkage_get_constituent_tree( (Linkage)ptr->linkage );
+	rlink_track_memory( &ptr->memsize, linkage_memory_in_use((Linkage)ptr->linkage) );
 	
-	linkage_free_constituent_tree( ctree );
-	return rval;
+	return rlink_linkage_make_cnode_array( ctree );
 }
 
 static VALUE
 rlink_linkage_make_cnode_array( ctree )
-	CNode *ctree;
+	const CNode *ctree;
 {
 	VALUE nodes = rb_ary_new();
 	VALUE rnode;
-	CNode *cnode = ctree;
+	const CNode *cnode = ctree;
 	
 	/*	
 		struct CNode_s {
@@ -848,6 +1077,66 @@ rlink_linkage_make_cnode_array( ctree )
 }
 
 
+/*
+ *  call-seq:
+ *     linkage.constituents   -> array
+ *
+ *  Return the Linkage's constituent tree flattened into an Array in 
+ *  pre-order, with one <tt>[label, parent, start, end]</tt> Array for each 
+ *  node. The +parent+ is the index of the node's parent in the Array (+nil+
+ *  for the root), and +start+ and +end+ are the first and last words the 
+ *  node spans. Phrase labels are Symbols; the leaves are labelled with 
+ *  their words, as Strings.
+ *
+ *     sent = dict.parse( "He is a big dog." )
+ *     sent.linkages.first.constituents
+ *     # => [[:S, nil, 0, 5], [:NP, 0, 0, 0], ["He", 1, 0, 0], [:VP, 0, 1, 4], ...
+ */
+static VALUE
+rlink_linkage_constituents( self )
+	VALUE self;
+{
+	rlink_LINKAGE *ptr = get_linkage( self );
+	const CNode *ctree = NULL;
+	VALUE nodes = rb_ary_new();
+	long count = 0;
+
+	check_linkage_sentence( ptr );
+	ctree = linkage_get_constituent_tree( (Linkage)ptr->linkage );
+	rlink_track_memory( &ptr->memsize, linkage_memory_in_use((Linkage)ptr->linkage) );
+	rlink_linkage_flatten_cnodes( nodes, ctree, Qnil, &count );
+
+	return nodes;
+}
+
+/* Append the nodes of the given list of siblings, and of their subtrees, to
+   +nodes+ in pre-order. */
+static void
+rlink_linkage_flatten_cnodes( nodes, cnode, parent, count )
+	VALUE nodes, parent;
+	const CNode *cnode;
+	long *count;
+{
+	const CNode *child;
+	VALUE label;
+	const char *name;
+	long index;
+
+	for ( ; cnode; cnode = linkage_constituent_node_get_next(cnode) ) {
+		name = linkage_constituent_node_get_label( cnode );
+		child = linkage_constituent_node_get_child( cnode );
+		label = child ? ID2SYM( rb_intern(name) ) : rb_obj_freeze( rb_str_new2(name) );
+		index = (*count)++;
+
+		rb_ary_push( nodes, rb_ary_new3(4, label, parent,
+			INT2FIX( linkage_constituent_node_get_start(cnode) ),
+			INT2FIX( linkage_constituent_node_get_end(cnode) )) );
+		if ( child )
+			rlink_linkage_flatten_cnodes( nodes, child, LONG2FIX(index), count );
+	}
+}
+
+
 /*
  *  call-seq:
  *     linkage.constituent_tree_string( mode=1 )   -> str
@@ -881,7 +1170,10 @@ rlink_linkage_constituent_tree_string( argc, argv, self )
 	if ( mode < 1 || mode > 3 )
 		rb_raise( rb_eArgError, "Illegal mode %d specified.", mode );
 
+	check_linkage_sentence( ptr );
+
 	ctree_string = linkage_print_constituent_tree( (Linkage)ptr->linkage, mode );
+	rlink_track_memory( &ptr->memsize, linkage_memory_in_use((Linkage)ptr->linkage) );
 
 	if ( ctree_string ) {
 		rval = rb_str_new2( ctree_string );
@@ -894,6 +1186,54 @@ rlink_linkage_constituent_tree_string( argc, argv, self )
 }
 
 
+/*
+ *  call-seq:
+ *     linkage.memsize   -> fixnum
+ *
+ *  The memory, in bytes, that the link-grammar library is holding for the 
+ *  linkage, which is what it counts for with the garbage collector on top
+ *  of the object itself.
+ */
+static VALUE
+rlink_linkage_memsize( self )
+	VALUE self;
+{
+	rlink_LINKAGE *ptr = get_linkage( self );
+	int bytes;
+	
+	bytes = linkage_memory_in_use( (Linkage)ptr->linkage );
+	return INT2FIX( bytes );
+}
+
+
+/*
+ *  call-seq:
+ *     linkage.free   -> nil
+ *
+ *  Give back the memory the link-grammar library is holding for the 
+ *  linkage now, rather than whenever the garbage collector gets to it. The
+ *  linkage can't be used after that.
+ */
+static VALUE
+rlink_linkage_free( self )
+	VALUE self;
+{
+	rlink_LINKAGE *ptr = check_linkage( self );
+
+	if ( !ptr )
+		rb_raise( rb_eRuntimeError, "uninitialized Linkage" );
+
+	debugMsg(( "Explicitly freeing Linkage <%p>", ptr->linkage ));
+	if ( ptr->linkage ) linkage_delete( (Linkage)ptr->linkage );
+	rlink_track_memory( &ptr->memsize, 0 );
+	ptr->linkage = NULL;
+	ptr->sentence = Qnil;
+	ptr->dictionary = Qnil;
+
+	return Qnil;
+}
+
+
 
 /* 
  * This is the API's representation of a parse. A LinkParser::Sentence may have one or more
@@ -915,8 +1255,13 @@ rlink_init_linkage(void)
 	rlink_cLinkage = rb_define_class_under( rlink_mLinkParser, "Linkage", rb_cObject );
 	
 	rb_define_alloc_func( rlink_cLinkage, rlink_linkage_s_alloc );
+	rb_define_singleton_method( rlink_cLinkage, "from_packed", 
+		rlink_linkage_s_from_packed, 2 );
 	
 	rb_define_method( rlink_cLinkage, "initialize", rlink_linkage_init, -1 );
+	rb_define_method( rlink_cLinkage, "to_packed", rlink_linkage_to_packed, 0 );
+	rb_define_method( rlink_cLinkage, "memsize", rlink_linkage_memsize, 0 );
+	rb_define_method( rlink_cLinkage, "free", rlink_linkage_free, 0 );
 	rb_define_method( rlink_cLinkage, "diagram", rlink_linkage_diagram, 0 );
 	rb_define_method( rlink_cLinkage, "postscript_diagram",
 	 	rlink_linkage_print_postscript, 1 );
@@ -957,6 +1302,8 @@ rlink_init_linkage(void)
 	
 	rb_define_method( rlink_cLinkage, "words",
 	 	rlink_linkage_get_words, 0 );
+	rb_define_method( rlink_cLinkage, "links",
+	 	rlink_linkage_get_links, 0 );
 
 	rb_define_method( rlink_cLinkage, "compute_union",
 	 	rlink_linkage_compute_union, 0 );
@@ -977,6 +1324,11 @@ rlink_init_linkage(void)
 	rb_define_method( rlink_cLinkage, "violation_name",
 	 	rlink_linkage_get_violation_name, 0 );
 
+	/* Struct that describes one link of a linkage */
+	rlink_sLinkageLink = rb_struct_define( "LinkParserLink", 
+		"lword", "rword", "length", "label", "llabel", "rlabel", "desc", NULL );
+	rb_define_const( rlink_cLinkage, "Link", rlink_sLinkageLink );
+
 	/* Struct that contains links of a constituent tree */
 	rb_define_const( rlink_cLinkage, "CTree", rlink_sLinkageCTree );
 
@@ -984,6 +1336,8 @@ rlink_init_linkage(void)
 		"label", "children", "start", "end", NULL );
 	rb_define_method( rlink_cLinkage, "constituent_tree",
 		rlink_linkage_constituent_tree, 0 );
+	rb_define_method( rlink_cLinkage, "constituents",
+		rlink_linkage_constituents, 0 );
 	rb_define_method( rlink_cLinkage, "constituent_tree_string",
 	 	rlink_linkage_constituent_tree_string, -1 );
 }
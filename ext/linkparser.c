@@ -43,6 +43,11 @@ VALUE rlink_cLinkage;
 VALUE rlink_cParseOptions;
 
 VALUE rlink_sLinkageCTree;
+VALUE rlink_sLinkageLink;
+
+/* How much link-grammar memory may be allocated between collections where
+   the GC can't be told about it */
+#define RLINK_GC_MALLOC_LIMIT	(8 * 1024 * 1024)
 
 
 /* --------------------------------------------------
@@ -89,19 +94,52 @@ rlink_raise_lp_error( void )
 }
 
 
-/* Make a Parse_Options after merging the specified default_options with any 
-   new options given. */
+/* Return the ParseOptions to use given the (precompiled) default_options and 
+   any new options given. The defaults, or a ParseOptions object that's passed
+   in, are used as they are; only a Hash of overrides costs a copy. */
 VALUE
 rlink_make_parse_options( default_options, options )
 	VALUE default_options, options;
 {
-	if ( NIL_P(options) ) options = rb_hash_new();
-	options = rb_funcall( default_options, rb_intern("merge"), 1, options );
+	if ( NIL_P(options) ) return default_options;
+	if ( IsParseOptions(options) ) return options;
 
-	return rb_class_new_instance( 1, &options, rlink_cParseOptions );
+	return rb_funcall( default_options, rb_intern("merge"), 1, options );
 }
 
 
+/* Tell the GC that the link-grammar structures an object wraps now take 
+   +size+ bytes, where +tracked+ holds what it was last told. The GC only 
+   sees the small wrapper objects, so without this it would let sentences
+   and linkages pile up long after the C heap had grown large enough to be
+   worth a collection. Where the GC can't be told about outside memory, 
+   a collection is started once enough of it has been allocated. */
+void
+rlink_track_memory( tracked, size )
+	long *tracked, size;
+{
+	long delta = size - *tracked;
+
+	*tracked = size;
+	if ( !delta ) return;
+
+#ifdef HAVE_RB_GC_ADJUST_MEMORY_USAGE
+	rb_gc_adjust_memory_usage( delta );
+#else
+	{
+		static long allocated_since_gc = 0;
+
+		allocated_since_gc += delta;
+		if ( allocated_since_gc < 0 ) {
+			allocated_since_gc = 0;
+		} else if ( delta > 0 && allocated_since_gc > RLINK_GC_MALLOC_LIMIT ) {
+			allocated_since_gc = 0;
+			rb_gc();
+		}
+	}
+#endif
+}
+
 
 
 /* Namespace module for the Ruby LinkParser library */
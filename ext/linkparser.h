@@ -54,6 +54,7 @@ extern void rlink_debug(fmt, va_alist);
 
 extern void rlink_raise_lp_error _(( void ));
 extern VALUE rlink_make_parse_options _(( VALUE, VALUE ));
+extern void rlink_track_memory _(( long *, long ));
 
 
 /* -------------------------------------------------------
@@ -73,6 +74,7 @@ extern VALUE rlink_cPostProcessor;
 extern VALUE rlink_cConstituentTree;
 
 extern VALUE rlink_sLinkageCTree;
+extern VALUE rlink_sLinkageLink;
 
 extern VALUE rlink_eLpError;
 
@@ -85,11 +87,20 @@ typedef struct {
 	VALUE	 	dictionary;
 	VALUE		parsed_p;
 	VALUE		options;
+	int			reparses;	/* how many times it's been parsed again */
+	long		memsize;	/* C-side bytes last reported to the GC */
 } rlink_SENTENCE;
 
 typedef struct {
-	Linkage		linkage;
+	Linkage		linkage;	/* NULL until it's first used */
 	VALUE		sentence;
+	int			index;
+	int			reparses;	/* the sentence's reparses when it was made */
+	VALUE		options;
+	VALUE		words;		/* frozen word Array, once it's been asked for */
+	VALUE		links;		/* frozen link Arrays, by sublinkage */
+	VALUE		dictionary;	/* for an unpacked linkage, which has no sentence */
+	long		memsize;	/* C-side bytes last reported to the GC */
 } rlink_LINKAGE;
 
 
@@ -125,5 +136,8 @@ extern Dictionary rlink_get_dict				_(( VALUE ));
 extern rlink_SENTENCE *rlink_get_sentence		_(( VALUE ));
 extern Parse_Options rlink_get_parseopts		_(( VALUE ));
 
+/* Constructors */
+extern VALUE rlink_make_lazy_linkage			_(( int, VALUE ));
+
 #endif /* _R_LINKPARSER_H */
 
@@ -93,6 +93,19 @@ get_parseopts( self )
 }
 
 
+/*
+ * Fetch the data pointer for a method that changes it, refusing if the
+ * object's been frozen.
+ */
+static Parse_Options
+get_writable_parseopts( self )
+	 VALUE self;
+{
+	if ( OBJ_FROZEN(self) ) rb_error_frozen( "ParseOptions" );
+	return get_parseopts( self );
+}
+
+
 /* 
  * Get the Parse_Options struct behind the LinkParser::ParseOptions +object+ 
  * specified.
@@ -160,7 +173,7 @@ rlink_parseopts_init( argc, argv, self )
 	}
 	
 	else {
-		rb_raise( rb_eRuntimeError, "Cannot re-initialize a Dictionary object." );
+		rb_raise( rb_eRuntimeError, "Cannot re-initialize a ParseOptions object." );
 	}
 
 	return self;
@@ -191,20 +204,73 @@ rlink_parseopts_each_opthash_i( pair, self )
 }
 
 
+/*
+ *  call-seq:
+ *     opts.dup   -> parseopts
+ *
+ *  Copy the receiving parse options. The copy isn't frozen, even if the 
+ *  receiver is.
+ */
+static VALUE
+rlink_parseopts_init_copy( self, other )
+	VALUE self, other;
+{
+	if ( self == other ) return self;
+	if ( check_parseopts(self) )
+		rb_raise( rb_eRuntimeError, "Cannot re-initialize a ParseOptions object." );
+
+	DATA_PTR( self ) = parse_options_copy( get_parseopts(other) );
+	return self;
+}
+
+
+/*
+ *  call-seq:
+ *     merge!( other )   -> parseopts
+ *
+ *  Set the options in +other+, which can be either another 
+ *  LinkParser::ParseOptions object or a Hash of options, on the receiver.
+ */
+static VALUE
+rlink_parseopts_merge_bang( self, other )
+	VALUE self, other;
+{
+	Parse_Options opts = get_writable_parseopts( self );
+
+	/* Sentences and linkages may point at opts, so it's changed in place */
+	if ( IsParseOptions(other) ) {
+		parse_options_copy_into( opts, get_parseopts(other) );
+	}
+	else if ( RTEST(other) ) {
+		Check_Type( other, T_HASH );
+		rb_iterate( rb_each, other, rlink_parseopts_each_opthash_i, self );
+	}
+
+	return self;
+}
+
+
 /*
  *  call-seq:
  *     merge( other )   -> parseopts
  *
  *  Merge the receiving parse options with the given +other+ object, which can
- *  be either another LinkParser::ParseOptions object or a Hash of options.
+ *  be either another LinkParser::ParseOptions object or a Hash of options,
+ *  and return the result as a new ParseOptions. The receiver is left alone,
+ *  so a frozen set of defaults can be shared by any number of parses that
+ *  override a few of them.
+ *
+ *     opts = dict.parse_options.merge( :max_null_count => 2 )
  */
-/*static VALUE
+static VALUE
 rlink_parseopts_merge( self, other )
 	VALUE self, other;
 {
-	
+	VALUE merged = rb_obj_alloc( rlink_cParseOptions );
+
+	rlink_parseopts_init_copy( merged, self );
+	return rlink_parseopts_merge_bang( merged, other );
 }
-*/
 
 
 /*
@@ -218,7 +284,7 @@ static VALUE
 rlink_parseopts_set_verbosity( self, verbosity )
 	VALUE self, verbosity;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_verbosity( opts, NUM2INT(verbosity) );
 	return verbosity;
 }
@@ -255,11 +321,153 @@ static VALUE
 rlink_parseopts_set_linkage_limit( self, linkage_limit )
 	VALUE self, linkage_limit;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_linkage_limit( opts, NUM2INT(linkage_limit) );
 	return linkage_limit;
 }
 
+/*
+ *  call-seq:
+ *     opts.compact_after= fixnum
+ *
+ *  Once this many linkages have been built from a sentence, compact it as 
+ *  Sentence#compact! does. The default, 0, never compacts sentences.
+ */
+static VALUE
+rlink_parseopts_set_compact_after( self, linkages )
+	VALUE self, linkages;
+{
+	Parse_Options opts = get_writable_parseopts( self );
+	parse_options_set_compact_after( opts, NUM2INT(linkages) );
+	return linkages;
+}
+
+/*
+ *  call-seq:
+ *     opts.compact_after   -> fixnum
+ *
+ *  Get the number of linkages after which a sentence is compacted.
+ */
+static VALUE
+rlink_parseopts_get_compact_after( self )
+	VALUE self;
+{
+	Parse_Options opts = get_parseopts( self );
+	int rval;
+
+	rval = parse_options_get_compact_after( opts );
+	return INT2FIX( rval );
+}
+
+/*
+ *  call-seq:
+ *     opts.split_length= fixnum
+ *
+ *  Parse a sentence of at least this many words a clause at a time, if 
+ *  it has words like semicolons that the dictionary lets start a new 
+ *  clause, and stitch the best linkage of each clause into one linkage 
+ *  of the whole. The default, 0, always parses sentences whole.
+ */
+static VALUE
+rlink_parseopts_set_split_length( self, words )
+	VALUE self, words;
+{
+	Parse_Options opts = get_writable_parseopts( self );
+	parse_options_set_split_length( opts, NUM2INT(words) );
+	return words;
+}
+
+/*
+ *  call-seq:
+ *     opts.split_length   -> fixnum
+ *
+ *  Get the length of sentence that is parsed a clause at a time.
+ */
+static VALUE
+rlink_parseopts_get_split_length( self )
+	VALUE self;
+{
+	Parse_Options opts = get_parseopts( self );
+	int rval;
+
+	rval = parse_options_get_split_length( opts );
+	return INT2FIX( rval );
+}
+
+/*
+ *  call-seq:
+ *     opts.cost_staged= boolean
+ *
+ *  If +true+, parse with the cheapest disjuncts first: with a 
+ *  +disjunct_cost+ of 0, then 1, and so on up to the +disjunct_cost+ 
+ *  set in these options, and keep the first parse that finds any 
+ *  linkages. The words' expressions are only expanded once for all of 
+ *  the stages.
+ */
+static VALUE
+rlink_parseopts_set_cost_staged( self, val )
+	VALUE self, val;
+{
+	Parse_Options opts = get_writable_parseopts( self );
+	parse_options_set_cost_staged( opts, RTEST(val) );
+	return val;
+}
+
+/*
+ *  call-seq:
+ *     opts.cost_staged?   -> true or false
+ *
+ *  Returns +true+ if sentences are parsed with the cheapest disjuncts 
+ *  first.
+ */
+static VALUE
+rlink_parseopts_get_cost_staged_p( self )
+	VALUE self;
+{
+	Parse_Options opts = get_parseopts( self );
+	int rval;
+
+	rval = parse_options_get_cost_staged( opts );
+	return rval ? Qtrue : Qfalse;
+}
+
+/*
+ *  call-seq:
+ *     opts.unknown_word_disjuncts= fixnum
+ *
+ *  Parse each word that isn't in the dictionary with no more than this 
+ *  many disjuncts at first, from the categories of unknown word that fit 
+ *  its neighbours best. If that parse finds nothing, or needs more null 
+ *  links, the sentence is parsed again with every category. The default, 
+ *  0, is no limit. See Dictionary#unknown_word_stats for how often that 
+ *  happens.
+ */
+static VALUE
+rlink_parseopts_set_unknown_word_disjuncts( self, disjuncts )
+	VALUE self, disjuncts;
+{
+	Parse_Options opts = get_writable_parseopts( self );
+	parse_options_set_unknown_word_disjuncts( opts, NUM2INT(disjuncts) );
+	return disjuncts;
+}
+
+/*
+ *  call-seq:
+ *     opts.unknown_word_disjuncts   -> fixnum
+ *
+ *  Get the most disjuncts an unknown word is parsed with at first.
+ */
+static VALUE
+rlink_parseopts_get_unknown_word_disjuncts( self )
+	VALUE self;
+{
+	Parse_Options opts = get_parseopts( self );
+	int rval;
+
+	rval = parse_options_get_unknown_word_disjuncts( opts );
+	return INT2FIX( rval );
+}
+
 /*
  *  call-seq:
  *     opts.linkage_limit   -> fixnum
@@ -292,7 +500,7 @@ static VALUE
 rlink_parseopts_set_disjunct_cost( self, disjunct_cost )
 	VALUE self, disjunct_cost;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_disjunct_cost( opts, NUM2INT(disjunct_cost) );
 	return disjunct_cost;
 }
@@ -326,7 +534,7 @@ static VALUE
 rlink_parseopts_set_min_null_count( self, null_count )
 	VALUE self, null_count;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_min_null_count( opts, NUM2INT(null_count) );
 	return null_count;
 }
@@ -358,7 +566,7 @@ static VALUE
 rlink_parseopts_set_max_null_count( self, null_count )
 	VALUE self, null_count;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_max_null_count( opts, NUM2INT(null_count) );
 	return null_count;
 }
@@ -393,7 +601,7 @@ static VALUE
 rlink_parseopts_set_null_block( self, null_block )
 	VALUE self, null_block;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_null_block( opts, NUM2INT(null_block) );
 	return null_block;
 }
@@ -431,7 +639,7 @@ static VALUE
 rlink_parseopts_set_islands_ok( self, islands_ok )
 	VALUE self, islands_ok;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_islands_ok( opts, RTEST(islands_ok) );
 	return islands_ok;
 }
@@ -467,7 +675,7 @@ static VALUE
 rlink_parseopts_set_short_length( self, short_length )
 	VALUE self, short_length;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_short_length( opts, NUM2INT(short_length) );
 	return short_length;
 }
@@ -495,14 +703,15 @@ rlink_parseopts_get_short_length( self )
  *
  *  Determines the maximum memory allowed during parsing. This is used just as 
  *  max_parse_time is, so that the parsing process is terminated as quickly as 
- *  possible after the total memory (including that allocated to all 
- *  dictionaries, etc.) exceeds the maximum allowed.
+ *  possible after the memory allocated by the parse itself exceeds the 
+ *  maximum allowed; memory held by dictionaries and other sentences doesn't 
+ *  count against it. See Sentence#peak_memory.
  */
 static VALUE
 rlink_parseopts_set_max_memory( self, mem )
 	VALUE self, mem;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_max_memory( opts, NUM2INT(mem) );
 	return mem;
 }
@@ -534,7 +743,7 @@ static VALUE
 rlink_parseopts_set_max_sentence_length( self, len )
 	VALUE self, len;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_max_sentence_length( opts, NUM2INT(len) );
 	return len;
 }
@@ -564,13 +773,15 @@ rlink_parseopts_get_max_sentence_length( self )
  *  The way it works is that after this time has expired, the parsing process 
  *  is artificially forced to complete quickly by pretending that no further 
  *  solutions (entries in the hash table) can be constructed. The actual 
- *  parsing time might be slightly longer.
+ *  parsing time might be slightly longer. The time counted is the CPU time 
+ *  of the thread doing the parse, starting when the parse does; see 
+ *  #max_parse_msecs= and #max_wall_msecs= for finer limits.
  */
 static VALUE
 rlink_parseopts_set_max_parse_time( self, secs )
 	VALUE self, secs;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_max_parse_time( opts, NUM2INT(secs) );
 	return secs;
 }
@@ -592,6 +803,74 @@ rlink_parseopts_get_max_parse_time( self )
 	return INT2FIX( rval );
 }
 
+/*
+ *  call-seq:
+ *     opts.max_parse_msecs= milliseconds
+ *
+ *  Like #max_parse_time=, but in milliseconds. A negative value means no 
+ *  limit.
+ */
+static VALUE
+rlink_parseopts_set_max_parse_msecs( self, msecs )
+	VALUE self, msecs;
+{
+	Parse_Options opts = get_writable_parseopts( self );
+	parse_options_set_max_parse_msecs( opts, NUM2INT(msecs) );
+	return msecs;
+}
+
+/*
+ *  call-seq:
+ *     opts.max_parse_msecs   -> fixnum
+ *
+ *  Get the number of milliseconds of CPU time a parse is allowed.
+ */
+static VALUE
+rlink_parseopts_get_max_parse_msecs( self )
+	VALUE self;
+{
+	Parse_Options opts = get_parseopts( self );
+	int rval;
+
+	rval = parse_options_get_max_parse_msecs( opts );
+	return INT2FIX( rval );
+}
+
+/*
+ *  call-seq:
+ *     opts.max_wall_msecs= milliseconds
+ *
+ *  Determines the maximum real (wall-clock) time, in milliseconds, that 
+ *  parsing is allowed to take, counting time spent waiting as well as 
+ *  working. Parsing is cut short in the same way as for #max_parse_time=. 
+ *  A negative value means no limit.
+ */
+static VALUE
+rlink_parseopts_set_max_wall_msecs( self, msecs )
+	VALUE self, msecs;
+{
+	Parse_Options opts = get_writable_parseopts( self );
+	parse_options_set_max_wall_msecs( opts, NUM2INT(msecs) );
+	return msecs;
+}
+
+/*
+ *  call-seq:
+ *     opts.max_wall_msecs   -> fixnum
+ *
+ *  Get the number of milliseconds of real time a parse is allowed.
+ */
+static VALUE
+rlink_parseopts_get_max_wall_msecs( self )
+	VALUE self;
+{
+	Parse_Options opts = get_parseopts( self );
+	int rval;
+
+	rval = parse_options_get_max_wall_msecs( opts );
+	return INT2FIX( rval );
+}
+
 /*
  *  call-seq:
  *     opts.screen_width= columns
@@ -602,7 +881,7 @@ static VALUE
 rlink_parseopts_set_screen_width( self, val )
 	VALUE self, val;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_screen_width( opts, NUM2INT(val) );
 	return val;
 }
@@ -634,7 +913,7 @@ static VALUE
 rlink_parseopts_set_allow_null( self, val )
 	VALUE self, val;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_allow_null( opts, RTEST(val) );
 	return val;
 }
@@ -666,7 +945,7 @@ static VALUE
 rlink_parseopts_set_display_walls( self, val )
 	VALUE self, val;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_display_walls( opts, RTEST(val) );
 	return val;
 }
@@ -700,7 +979,7 @@ static VALUE
 rlink_parseopts_set_all_short_connectors( self, val )
 	VALUE self, val;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_all_short_connectors( opts, RTEST(val) );
 	return val;
 }
@@ -734,7 +1013,7 @@ static VALUE
 rlink_parseopts_set_cost_model_type( self, cm )
 	VALUE self, cm;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_cost_model_type( opts, NUM2INT(cm) );
 	return cm;
 }
@@ -774,7 +1053,7 @@ static VALUE
 rlink_parseopts_set_batch_mode( self, val )
 	VALUE self, val;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_batch_mode( opts, RTEST(val) );
 	return val;
 }
@@ -809,7 +1088,7 @@ static VALUE
 rlink_parseopts_set_panic_mode( self, val )
 	VALUE self, val;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_panic_mode( opts, RTEST(val) );
 	return val;
 }
@@ -844,7 +1123,7 @@ static VALUE
 rlink_parseopts_set_display_on( self, val )
 	VALUE self, val;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_display_on( opts, RTEST(val) );
 	return val;
 }
@@ -876,7 +1155,7 @@ static VALUE
 rlink_parseopts_set_display_postscript( self, val )
 	VALUE self, val;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_display_postscript( opts, RTEST(val) );
 	return val;
 }
@@ -908,7 +1187,7 @@ static VALUE
 rlink_parseopts_set_display_constituents( self, val )
 	VALUE self, val;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_display_constituents( opts, RTEST(val) );
 	return val;
 }
@@ -940,7 +1219,7 @@ static VALUE
 rlink_parseopts_set_display_bad( self, val )
 	VALUE self, val;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_display_bad( opts, RTEST(val) );
 	return val;
 }
@@ -972,7 +1251,7 @@ static VALUE
 rlink_parseopts_set_display_links( self, val )
 	VALUE self, val;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_display_links( opts, RTEST(val) );
 	return val;
 }
@@ -1004,7 +1283,7 @@ static VALUE
 rlink_parseopts_set_display_union( self, val )
 	VALUE self, val;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_display_union( opts, RTEST(val) );
 	return val;
 }
@@ -1036,7 +1315,7 @@ static VALUE
 rlink_parseopts_set_echo_on( self, val )
 	VALUE self, val;
 {
-	Parse_Options opts = get_parseopts( self );
+	Parse_Options opts = get_writable_parseopts( self );
 	parse_options_set_echo_on( opts, RTEST(val) );
 	return val;
 }
@@ -1088,10 +1367,12 @@ rlink_init_parseoptions(void)
 
 	rb_define_alloc_func( rlink_cParseOptions, rlink_parseopts_s_alloc );
 	rb_define_method( rlink_cParseOptions, "initialize", rlink_parseopts_init, -1 );
-/*
+	rb_define_method( rlink_cParseOptions, "initialize_copy", 
+		rlink_parseopts_init_copy, 1 );
+
 	rb_define_method( rlink_cParseOptions, "merge", rlink_parseopts_merge, 1 );
 	rb_define_method( rlink_cParseOptions, "merge!", rlink_parseopts_merge_bang, 1 );
-*/
+
 	rb_define_method( rlink_cParseOptions, "verbosity=", 
 		rlink_parseopts_set_verbosity, 1 );
 	rb_define_method( rlink_cParseOptions, "verbosity", 
@@ -1100,6 +1381,22 @@ rlink_init_parseoptions(void)
 		rlink_parseopts_set_linkage_limit, 1 );
 	rb_define_method( rlink_cParseOptions, "linkage_limit", 
 		rlink_parseopts_get_linkage_limit, 0 );
+	rb_define_method( rlink_cParseOptions, "compact_after=", 
+		rlink_parseopts_set_compact_after, 1 );
+	rb_define_method( rlink_cParseOptions, "compact_after", 
+		rlink_parseopts_get_compact_after, 0 );
+	rb_define_method( rlink_cParseOptions, "split_length=", 
+		rlink_parseopts_set_split_length, 1 );
+	rb_define_method( rlink_cParseOptions, "split_length", 
+		rlink_parseopts_get_split_length, 0 );
+	rb_define_method( rlink_cParseOptions, "cost_staged=", 
+		rlink_parseopts_set_cost_staged, 1 );
+	rb_define_method( rlink_cParseOptions, "cost_staged?", 
+		rlink_parseopts_get_cost_staged_p, 0 );
+	rb_define_method( rlink_cParseOptions, "unknown_word_disjuncts=", 
+		rlink_parseopts_set_unknown_word_disjuncts, 1 );
+	rb_define_method( rlink_cParseOptions, "unknown_word_disjuncts", 
+		rlink_parseopts_get_unknown_word_disjuncts, 0 );
 	rb_define_method( rlink_cParseOptions, "disjunct_cost=", 
 		rlink_parseopts_set_disjunct_cost, 1 );
 	rb_define_method( rlink_cParseOptions, "disjunct_cost", 
@@ -1136,6 +1433,14 @@ rlink_init_parseoptions(void)
 		rlink_parseopts_set_max_parse_time, 1 );
 	rb_define_method( rlink_cParseOptions, "max_parse_time", 
 		rlink_parseopts_get_max_parse_time, 0 );
+	rb_define_method( rlink_cParseOptions, "max_parse_msecs=", 
+		rlink_parseopts_set_max_parse_msecs, 1 );
+	rb_define_method( rlink_cParseOptions, "max_parse_msecs", 
+		rlink_parseopts_get_max_parse_msecs, 0 );
+	rb_define_method( rlink_cParseOptions, "max_wall_msecs=", 
+		rlink_parseopts_set_max_wall_msecs, 1 );
+	rb_define_method( rlink_cParseOptions, "max_wall_msecs", 
+		rlink_parseopts_get_max_wall_msecs, 0 );
 	rb_define_method( rlink_cParseOptions, "screen_width=", 
 		rlink_parseopts_set_screen_width, 1 );
 	rb_define_method( rlink_cParseOptions, "screen_width", 
@@ -56,6 +56,8 @@ rlink_sentence_alloc()
 	ptr->dictionary	= Qnil;
 	ptr->parsed_p	= Qfalse;
 	ptr->options	= Qnil;
+	ptr->reparses	= 0;
+	ptr->memsize	= 0;
 	
 	debugMsg(( "Initialized an rlink_SENTENCE <%p>", ptr ));
 	return ptr;
@@ -92,13 +94,16 @@ rlink_sentence_gc_free( ptr )
 	if ( ptr ) {
 		debugMsg(( "In free function of Sentence <%p>", ptr ));
 		
-		if ( rlink_get_dict(ptr->dictionary) ) {
+		if ( !ptr->sentence ) {
+			debugMsg(( "Sentence was already freed." ));
+		} else if ( rlink_get_dict(ptr->dictionary) ) {
 			debugMsg(( "Freeing Sentence <%p>", ptr->sentence ));
 			sentence_delete( (Sentence)ptr->sentence );
 		} else {
 			debugMsg(( "Not freeing a Sentence belonging to an already-freed dictionary." ));
 		}
 
+		rlink_track_memory( &ptr->memsize, 0 );
 		ptr->sentence = NULL;
 		ptr->options = Qnil;
 		ptr->dictionary = Qnil;
@@ -141,6 +146,8 @@ get_sentence( self )
 	debugMsg(( "Fetching a Sentence (%p).", ptr ));
 	if ( !ptr )
 		rb_raise( rb_eRuntimeError, "uninitialized Sentence" );
+	if ( !ptr->sentence )
+		rb_raise( rlink_eLpError, "Sentence has been freed" );
 
 	return ptr;
 }
@@ -158,6 +165,32 @@ rlink_get_sentence( self )
 
 
 
+/*
+ * Create a Sentence from an Array of words that have already been split
+ * apart, so that link-grammar doesn't tokenize them again.
+ */
+static Sentence
+create_sentence_from_tokens( tokens, dict )
+	VALUE tokens;
+	Dictionary dict;
+{
+	VALUE strings = rb_ary_new2( RARRAY(tokens)->len );
+	const char **words = ALLOCA_N( const char *, RARRAY(tokens)->len + 1 );
+	VALUE token;
+	long i;
+
+	/* Keep the converted Strings in an Array so they aren't collected */
+	for ( i = 0; i < RARRAY(tokens)->len; i++ ) {
+		token = rb_ary_entry( tokens, i );
+		StringValue( token );
+		rb_ary_push( strings, token );
+		words[i] = StringValueCStr( token );
+	}
+
+	return sentence_create_from_tokens( words, (int)i, dict );
+}
+
+
 /* --------------------------------------------------
  * Class Methods
  * -------------------------------------------------- */
@@ -185,12 +218,17 @@ rlink_sentence_s_alloc( klass )
 /*
  *  call-seq:
  *     LinkParser::Sentence.new( str, dict )   -> sentence
+ *     LinkParser::Sentence.new( words, dict )   -> sentence
  *
  *  Create a new LinkParser::Sentence object from the given input string
- #  using the specified LinkParser::Dictionary.
+ #  using the specified LinkParser::Dictionary. If an Array of +words+ is
+ *  given instead, they're taken as the sentence's words just as they are,
+ *  without being tokenized again, so each one lines up with a word of the
+ *  sentence (after the LEFT-WALL).
  *
  *     dict = LinkParser::Dictionary.new
  *     LinkParser::Sentence.new( "The boy runs", dict )  #=> #<LinkParser::Sentence:0x5481ac>
+ *     LinkParser::Sentence.new( %w[The boy runs], dict )  #=> #<LinkParser::Sentence:0x547e28>
  */
 static VALUE
 rlink_sentence_init( self, input_string, dictionary )
@@ -201,7 +239,11 @@ rlink_sentence_init( self, input_string, dictionary )
 		Sentence sent;
 		Dictionary dict = rlink_get_dict( dictionary );
 	
-		if ( !(sent = sentence_create( StringValueCStr(input_string), dict )) )
+		if ( TYPE(input_string) == T_ARRAY )
+			sent = create_sentence_from_tokens( input_string, dict );
+		else
+			sent = sentence_create( StringValueCStr(input_string), dict );
+		if ( !sent )
 			rlink_raise_lp_error();
 
 		DATA_PTR( self ) = ptr = rlink_sentence_alloc();
@@ -209,6 +251,7 @@ rlink_sentence_init( self, input_string, dictionary )
 		ptr->sentence = sent;
 		ptr->dictionary = dictionary;
 		ptr->options = Qnil;
+		rlink_track_memory( &ptr->memsize, sentence_memory_in_use(sent) );
 		
 	} else {
 		rb_raise( rb_eRuntimeError,
@@ -219,13 +262,55 @@ rlink_sentence_init( self, input_string, dictionary )
 }
 
 
+/*
+ * Parse the sentence with the options in +argv+ over its dictionary's, 
+ * whether or not it's been parsed before. The options are all checked 
+ * before the sentence is touched, so a bad one leaves it as it was.
+ */
+static VALUE
+rlink_sentence_parse_with( argc, argv, self )
+	int argc;
+	VALUE *argv;
+	VALUE self;
+{
+	rlink_SENTENCE *ptr = get_sentence( self );
+	Parse_Options opts;
+	VALUE defopts = Qnil;
+	VALUE options = Qnil;
+	int link_count = 0;
+
+	/* Use the dictionary's precompiled options unless this call overrides
+	   them, then extract the Parse_Options struct from that */
+	rb_scan_args( argc, argv, "01", &options );
+	defopts = rb_iv_get( ptr->dictionary, "@parse_options" );
+	options = rlink_make_parse_options( defopts, options );
+	opts = rlink_get_parseopts( options );
+
+	/* Parse the sentence. Whatever it gives back, the last parse is gone, 
+	   so the lazy linkages taken from it can't be built any more. */
+	link_count = sentence_parse( ptr->sentence, opts );
+	if ( RTEST(ptr->parsed_p) ) ptr->reparses++;
+	if ( link_count < 0 )
+		rlink_raise_lp_error();
+
+	ptr->options = options;
+	ptr->parsed_p = Qtrue;
+	rlink_track_memory( &ptr->memsize, sentence_memory_in_use(ptr->sentence) );
+	
+	return INT2FIX( link_count );
+}
+
+
 /*
  *  call-seq:
  *     sentence.parse( options={} )   -> fixnum
+ *     sentence.parse( parseoptions )   -> fixnum
  *
  *  Attach a parse set to this sentence and return the number of linkages
  *  found. If any +options+ are specified, they override those set in the 
- *  sentence's dictionary.
+ *  sentence's dictionary. A LinkParser::ParseOptions object is used as it is,
+ *  so one that's built (and frozen) ahead of time can be passed to any
+ *  number of parses without any per-call merging.
  * 
  */
 static VALUE
@@ -235,31 +320,93 @@ rlink_sentence_parse( argc, argv, self )
 	VALUE self;
 {
 	rlink_SENTENCE *ptr = get_sentence( self );
-	Parse_Options opts;
+
+	if ( RTEST(ptr->parsed_p) )
+		rb_raise( rlink_eLpError, "Can't reparse a sentence." );
+
+	return rlink_sentence_parse_with( argc, argv, self );
+}
+
+
+/*
+ *  call-seq:
+ *     sentence.reparse( options={} )   -> fixnum
+ *     sentence.reparse( parseoptions )   -> fixnum
+ *
+ *  Parse the sentence again, with different +options+, without making it 
+ *  over again from its string. The words and their expressions are kept 
+ *  from before, so only the disjuncts are built again. Linkages already 
+ *  used keep describing the old parse; ones taken from #linkages that 
+ *  haven't been used yet raise a LinkParser::Error when they are, rather 
+ *  than describe a linkage of the new one.
+ *
+ *     sentence.parse( :disjunct_cost => 0 )     #-> 0
+ *     sentence.reparse( :disjunct_cost => 2 )   #-> 3
+ */
+static VALUE
+rlink_sentence_reparse( argc, argv, self )
+	int argc;
+	VALUE *argv;
+	VALUE self;
+{
+	rlink_SENTENCE *ptr = get_sentence( self );
+	VALUE link_count;
+
+	debugMsg(( "Reparsing sentence <%p>", ptr->sentence ));
+	link_count = rlink_sentence_parse_with( argc, argv, self );
+	rb_funcall( self, rb_intern("forget_delegated_methods"), 0 );
+
+	return link_count;
+}
+
+
+/*
+ *  call-seq:
+ *     sentence.parse_racing( options={}, panic_options=nil )   -> fixnum
+ *
+ *  Parse the sentence the way the link-parser program does: first with no
+ *  null links, then with null links if +options+ allow them, then, if that
+ *  ran out of time or memory without finding anything, with the cheap
+ *  "panic" options. Those are +panic_options+ merged over the sentence's
+ *  dictionary's options if they're given, or link-parser's panic settings
+ *  otherwise. The +max_wall_msecs+ of +options+ is a deadline for all of
+ *  the passes together, with a quarter of it kept for the panic pass.
+ *  Returns the number of linkages found by the last pass that ran.
+ *
+ *     sentence.parse_racing( :max_wall_msecs => 2000 )   #-> 4
+ */
+static VALUE
+rlink_sentence_parse_racing( argc, argv, self )
+	int argc;
+	VALUE *argv;
+	VALUE self;
+{
+	rlink_SENTENCE *ptr = get_sentence( self );
+	Parse_Options opts, panic_opts = NULL;
 	VALUE defopts = Qnil;
-	VALUE options = Qnil;
+	VALUE options = Qnil, panic_options = Qnil;
 	int link_count = 0;
 
 	if ( RTEST(ptr->parsed_p) )
 		rb_raise( rlink_eLpError, "Can't reparse a sentence." );
 
-	/* Merge the hash from this call with the one from the dict and build
-	   Parse_Options from it. */
-	rb_scan_args( argc, argv, "01", &options );
-	defopts = rb_funcall( ptr->dictionary, rb_intern("options"), 0 );
-
-	/* Turn the option hash into a ParseOptions object, then extract the
-	   Parse_Options struct from that  */
+	rb_scan_args( argc, argv, "02", &options, &panic_options );
+	defopts = rb_iv_get( ptr->dictionary, "@parse_options" );
 	options = rlink_make_parse_options( defopts, options );
 	opts = rlink_get_parseopts( options );
+	if ( !NIL_P(panic_options) ) {
+		panic_options = rlink_make_parse_options( defopts, panic_options );
+		panic_opts = rlink_get_parseopts( panic_options );
+	}
 
-	/* Parse the sentence */
-	if ( (link_count = sentence_parse( ptr->sentence, opts )) < 0 )
+	debugMsg(( "Racing parse of sentence <%p>", ptr->sentence ));
+	if ( (link_count = sentence_parse_racing( ptr->sentence, opts, panic_opts )) < 0 )
 		rlink_raise_lp_error();
 
 	ptr->options = options;
 	ptr->parsed_p = Qtrue;
-	
+	rlink_track_memory( &ptr->memsize, sentence_memory_in_use(ptr->sentence) );
+
 	return INT2FIX( link_count );
 }
 
@@ -287,9 +434,11 @@ rlink_sentence_parsed_p( self )
  *  call-seq:
  *     sentence.options   -> parseoptions
  *
- *  Returns a ParseOptions object for the receiving sentence.
+ *  Returns a ParseOptions object for the receiving sentence. Unless the 
+ *  sentence was parsed with overrides, this is its dictionary's frozen 
+ *  Dictionary#parse_options.
  *
- *     sentence.options.verbosity = 3
+ *     sentence.options.verbosity    # -> 1
  *     sentence.options.islands_ok?  # -> true
  */
 static VALUE
@@ -308,7 +457,10 @@ rlink_sentence_options( self )
  *     sentence.linkages   -> array
  *
  *  Returns an Array of LinkParser::Linkage objects which represent the
- *  parts parsed from the sentence for the current linkage.
+ *  parts parsed from the sentence for the current linkage. Each Linkage is
+ *  only built when it's first used, so looking at the first few linkages of
+ *  a sentence with hundreds of them doesn't cost much more than looking at
+ *  one.
  *
  */
 static VALUE
@@ -325,16 +477,8 @@ rlink_sentence_linkages( self )
 	count = sentence_num_valid_linkages( (Sentence)ptr->sentence );
 	rary = rb_ary_new2( count );
 	
-	for ( i = 0; i < count; i++ ) {
-		VALUE linkage;
-		VALUE args[2];
-		
-		args[0] = INT2FIX( i );
-		args[1] = self;
-		
-		linkage = rb_class_new_instance( 2, args, rlink_cLinkage );
-		rb_ary_store( rary, i, linkage );
-	}
+	for ( i = 0; i < count; i++ )
+		rb_ary_store( rary, i, rlink_make_lazy_linkage(i, self) );
 	
 	return rary;
 }
@@ -549,6 +693,104 @@ rlink_sentence_disjunct_cost( self, i )
 }
 	
 
+/*
+ *  call-seq:
+ *     sentence.peak_memory   -> fixnum
+ *
+ *  The most memory, in bytes, that the parser had in use at once while 
+ *  parsing the sentence. This, and not the memory used by the dictionary or 
+ *  by other sentences, is what the ParseOptions#max_memory limit applies to.
+ */
+static VALUE
+rlink_sentence_peak_memory( self )
+	VALUE self;
+{
+	rlink_SENTENCE *ptr = get_sentence( self );
+	int bytes;
+	
+	bytes = sentence_peak_memory( (Sentence)ptr->sentence );
+	return INT2FIX( bytes );
+}
+
+
+/*
+ *  call-seq:
+ *     sentence.memsize   -> fixnum
+ *
+ *  The memory, in bytes, that the link-grammar library is holding for the 
+ *  sentence and what its parse left behind. This is what the sentence 
+ *  counts for with the garbage collector, on top of the object itself.
+ */
+static VALUE
+rlink_sentence_memsize( self )
+	VALUE self;
+{
+	rlink_SENTENCE *ptr = get_sentence( self );
+	int bytes;
+	
+	bytes = sentence_memory_in_use( (Sentence)ptr->sentence );
+	return INT2FIX( bytes );
+}
+
+
+/*
+ *  call-seq:
+ *     sentence.compact!   -> sentence
+ *
+ *  Free what the parser needed to find the sentence's linkages, keeping what
+ *  describes the linkages it found. Linkages that have already been built 
+ *  are unaffected, and the counts and costs of the others can still be asked
+ *  for; building one of the others parses the sentence again. For sentences 
+ *  that are kept around after their linkages have been looked at. 
+ *  ParseOptions#compact_after= does this automatically.
+ *
+ *     sentence = dict.parse( "The cat sat on the mat." )
+ *     diagram = sentence.linkages.first.diagram
+ *     sentence.compact!
+ */
+static VALUE
+rlink_sentence_compact_bang( self )
+	VALUE self;
+{
+	rlink_SENTENCE *ptr = get_sentence( self );
+
+	sentence_compact( (Sentence)ptr->sentence );
+	rlink_track_memory( &ptr->memsize, sentence_memory_in_use(ptr->sentence) );
+
+	return self;
+}
+
+
+/*
+ *  call-seq:
+ *     sentence.free   -> nil
+ *
+ *  Give back the memory the link-grammar library is holding for the 
+ *  sentence now, rather than whenever the garbage collector gets to it, 
+ *  for long-running jobs that parse a lot of sentences. The sentence can't 
+ *  be used after that, but the Linkages already built from it can, except 
+ *  for their constituent trees.
+ *
+ *     dict.parse_stream( $stdin ) do |sentence|
+ *       puts sentence.linkages.first.diagram
+ *       sentence.free
+ *     end
+ */
+static VALUE
+rlink_sentence_free( self )
+	VALUE self;
+{
+	rlink_SENTENCE *ptr = get_sentence( self );
+
+	debugMsg(( "Explicitly freeing Sentence <%p>", ptr->sentence ));
+	sentence_delete( (Sentence)ptr->sentence );
+	ptr->sentence = NULL;
+	rlink_track_memory( &ptr->memsize, 0 );
+
+	return Qnil;
+}
+	
+
 /*
  * Document-class: LinkParser::Sentence
  * 
@@ -573,6 +815,8 @@ rlink_init_sentence( void )
 
 	rb_define_method( rlink_cSentence, "initialize", rlink_sentence_init, 2 );
 	rb_define_method( rlink_cSentence, "parse", rlink_sentence_parse, -1 );
+	rb_define_method( rlink_cSentence, "reparse", rlink_sentence_reparse, -1 );
+	rb_define_method( rlink_cSentence, "parse_racing", rlink_sentence_parse_racing, -1 );
 	rb_define_method( rlink_cSentence, "parsed?", rlink_sentence_parsed_p, 0 );
 	rb_define_method( rlink_cSentence, "linkages", rlink_sentence_linkages, 0 );
 
@@ -595,6 +839,12 @@ rlink_init_sentence( void )
 		rlink_sentence_num_violations, 1 );
 	rb_define_method( rlink_cSentence, "disjunct_cost", 
 		rlink_sentence_disjunct_cost, 1 );
+	rb_define_method( rlink_cSentence, "peak_memory", 
+		rlink_sentence_peak_memory, 0 );
+	rb_define_method( rlink_cSentence, "memsize", 
+		rlink_sentence_memsize, 0 );
+	rb_define_method( rlink_cSentence, "compact!", rlink_sentence_compact_bang, 0 );
+	rb_define_method( rlink_cSentence, "free", rlink_sentence_free, 0 );
 
 /*
 	link_public_api(char *) sentence_get_nth_word(Sentence sent, int i);
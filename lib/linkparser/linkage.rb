@@ -159,10 +159,6 @@ class LinkParser::Linkage
 		:Z  => %{connects the preposition "as" to certain verbs: "AS we EXPECTED, he was late".},
 	}
 
-	# Link struct types
-	Link = Struct.new( "LinkParserLink", :lword, :rword, :length, :label, :llabel, :rlabel, :desc )
-	
-
 	######
 	public
 	######
@@ -180,24 +176,7 @@ class LinkParser::Linkage
 
 	### Return the +index+th link.
 	def link( index )
-		Link.new( 
-			self.words[ self.link_lword(index) ],
-			self.words[ self.link_rword(index) ],
-			self.link_length(index),
-			self.link_label(index),
-			self.link_llabel(index),
-			self.link_rlabel(index),
-			LinkTypes[ self.link_label(index).gsub(/[^A-Z]+/, '').to_sym ]
-		)
-	end
-	
-
-	### Return the Array of words in the sentence as tokenized by the
-	### parser.
-	def links
-		( 0...self.link_count ).collect do |i|
-			self.link( i )
-		end
+		return self.links[ index ]
 	end
 
 
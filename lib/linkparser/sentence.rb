@@ -89,6 +89,15 @@ class LinkParser::Sentence
 	end
 	
 
+	### Remove the methods that calls were delegated to the first linkage 
+	### with, so they go to the first linkage of the next parse instead.
+	def forget_delegated_methods
+		self.singleton_class.instance_methods( false ).each do |meth|
+			self.singleton_class.send( :remove_method, meth )
+		end
+	end
+
+
 	### Proxy method -- auto-delegate calls to the first linkage.
 	def method_missing( sym, *args )
 		linkage = self.linkages.first
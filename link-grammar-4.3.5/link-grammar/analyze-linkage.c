@@ -24,18 +24,22 @@
  cost of the linkage. */
 
 
-static List_o_links *word_links[MAX_SENTENCE]; /* ptr to l.o.l. out of word */
+/* The arrays below have one entry for each word of the sentence (or
+   link of the linkage, for patch_array) being analyzed; they are made
+   by alloc_fat_arrays() and build_digraph(). */
+
+static List_o_links **word_links; /* ptr to l.o.l. out of word */
 static int structure_violation;
-static int dfs_root_word[MAX_SENTENCE]; /* for the depth-first search */
-static int dfs_height[MAX_SENTENCE];    /* to determine the order to do the root word dfs */
-static int height_perm[MAX_SENTENCE];   /* permute the vertices from highest to lowest */
+static int *dfs_root_word; /* for the depth-first search */
+static int *dfs_height;    /* to determine the order to do the root word dfs */
+static int *height_perm;   /* permute the vertices from highest to lowest */
 
 /* The following three functions are all for computing the cost of and lists */
-static int visited[MAX_SENTENCE];
-static int and_element_sizes[MAX_SENTENCE];
-static int and_element[MAX_SENTENCE];
+static int *visited;
+static int *and_element_sizes;
+static int *and_element;
 static int N_and_elements;
-static int outside_word[MAX_SENTENCE];
+static int *outside_word;
 static int N_outside_words;
 
 typedef struct patch_element_struct Patch_element;
@@ -47,7 +51,7 @@ struct patch_element_struct
 	int newr;    /* the new value of the right end         */
 };
 
-static Patch_element patch_array[MAX_LINKS];
+static Patch_element *patch_array;
 
 typedef struct DIS_node_struct DIS_node;
 typedef struct CON_node_struct CON_node;
@@ -98,13 +102,11 @@ void zero_sublinkage(Sublinkage *s)
 static Sublinkage * x_create_sublinkage(Parse_info pi)
 {
 	Sublinkage *s = (Sublinkage *) xalloc (sizeof(Sublinkage));
-	s->link = (Link *) xalloc(MAX_LINKS*sizeof(Link));
-	s->num_links = MAX_LINKS;
+	s->link = (Link *) xalloc(pi->N_links*sizeof(Link));
+	s->num_links = pi->N_links;
 
 	zero_sublinkage(s);
 
-	s->num_links = pi->N_links;
-	assert(pi->N_links < MAX_LINKS, "Too many links");
 	return s;
 }
 
@@ -116,20 +118,51 @@ static Sublinkage * ex_create_sublinkage(Parse_info pi)
 
 	zero_sublinkage(s);
 
-	assert(pi->N_links < MAX_LINKS, "Too many links");
 	return s;
 }
 
 static void free_sublinkage(Sublinkage *s)
 {
 	int i;
-	for (i=0; i<MAX_LINKS; i++) {
+	for (i=0; i<s->num_links; i++) {
 		if (s->link[i]!=NULL) exfree_link(s->link[i]);
 	}
-	xfree(s->link, MAX_LINKS*sizeof(Link));
+	xfree(s->link, s->num_links*sizeof(Link));
 	xfree(s, sizeof(Sublinkage));
 }
 
+/**
+ * Makes the arrays that are needed to take a linkage with fat links
+ * apart, sized for its words and links.
+ */
+static void alloc_fat_arrays(Parse_info pi)
+{
+	int n = pi->N_words;
+
+	dfs_root_word = (int *) xalloc(n*sizeof(int));
+	dfs_height = (int *) xalloc(n*sizeof(int));
+	height_perm = (int *) xalloc(n*sizeof(int));
+	visited = (int *) xalloc(n*sizeof(int));
+	and_element_sizes = (int *) xalloc(n*sizeof(int));
+	and_element = (int *) xalloc(n*sizeof(int));
+	outside_word = (int *) xalloc(n*sizeof(int));
+	patch_array = (Patch_element *) xalloc(pi->N_links*sizeof(Patch_element));
+}
+
+static void free_fat_arrays(Parse_info pi)
+{
+	int n = pi->N_words;
+
+	xfree(dfs_root_word, n*sizeof(int));
+	xfree(dfs_height, n*sizeof(int));
+	xfree(height_perm, n*sizeof(int));
+	xfree(visited, n*sizeof(int));
+	xfree(and_element_sizes, n*sizeof(int));
+	xfree(and_element, n*sizeof(int));
+	xfree(outside_word, n*sizeof(int));
+	xfree(patch_array, pi->N_links*sizeof(Patch_element));
+}
+
 static void replace_link_name(Link l, const char *s)
 {
 	char * t;
@@ -149,18 +182,20 @@ static void copy_full_link(Link *dest, Link src)
 
 
 /* Constructs a graph in the wordlinks array based on the contents of    */
-/* the global link_array.  Makes the wordlinks array point to a list of  */
-/* words neighboring each word (actually a list of links).  This is a     */
-/* directed graph, constructed for dealing with "and".  For a link in     */
-/* which the priorities are UP or DOWN_priority, the edge goes from the   */
-/* one labeled DOWN to the one labeled UP.                                */
+/* the global link_array, and returns it.  Makes the wordlinks array      */
+/* point to a list of words neighboring each word (actually a list of     */
+/* links).  This is a directed graph, constructed for dealing with "and". */
+/* For a link in which the priorities are UP or DOWN_priority, the edge   */
+/* goes from the one labeled DOWN to the one labeled UP.                  */
 /* Don't generate links edges for the bogus comma connectors              */
-static void build_digraph(Parse_info pi, List_o_links **wordlinks)
+static List_o_links ** build_digraph(Parse_info pi)
 {
 	int i, link, N_fat;
 	Link lp;
 	List_o_links * lol;
+	List_o_links ** wordlinks;
 	N_fat = 0;
+	wordlinks = (List_o_links **) xalloc(pi->N_words*sizeof(List_o_links *));
 	for (i=0; i<pi->N_words; i++) {
 		wordlinks[i] = NULL;
 	}
@@ -197,6 +232,7 @@ static void build_digraph(Parse_info pi, List_o_links **wordlinks)
 			lol->dir = -1;
 		}
 	}
+	return wordlinks;
 }
 
 /**
@@ -333,7 +369,7 @@ static DIS_node * build_DIS_CON_tree(Parse_info pi, List_o_links **wordlinks)
 	 */
 
 	for (w=0; w < pi->N_words; w++) dfs_height[w] = 0;
-	for (w=0; w < pi->N_words; w++) height_dfs(w, MAX_SENTENCE, wordlinks);
+	for (w=0; w < pi->N_words; w++) height_dfs(w, pi->N_words, wordlinks);
 
 	for (w=0; w < pi->N_words; w++) height_perm[w] = w;
 	qsort(height_perm, pi->N_words, sizeof(height_perm[0]), (COMPARE_TYPE) comp_height);
@@ -470,6 +506,7 @@ static void free_digraph(Parse_info pi, List_o_links **wordlinks)
 		  xfree((void *) lol, sizeof(List_o_links));
 		}
 	}
+  xfree(wordlinks, pi->N_words*sizeof(List_o_links *));
 }
 
 static void free_CON_tree(CON_node *);
@@ -547,7 +584,7 @@ static void and_dfs_commas(Sentence sent, int w, List_o_links **wordlinks)
 static Andlist * build_andlist(Sentence sent, List_o_links **wordlinks)
 {
 	int w, i, min, max, j, cost;
-	char * s;
+	const char * s;
 	Andlist * new_andlist, * old_andlist;
 	Parse_info pi = sent->parse_info;
 
@@ -570,6 +607,8 @@ static Andlist * build_andlist(Sentence sent, List_o_links **wordlinks)
 			  new_andlist = (Andlist *) xalloc(sizeof(Andlist));
 			new_andlist->num_elements = N_and_elements;
 			new_andlist->num_outside_words = N_outside_words;
+			new_andlist->element = (int *) xalloc(N_and_elements*sizeof(int));
+			new_andlist->outside_word = (int *) xalloc(N_outside_words*sizeof(int));
 			for (i=0; i<N_and_elements; i++) {
 			  new_andlist->element[i] = and_element[i];
 			}
@@ -581,7 +620,7 @@ static Andlist * build_andlist(Sentence sent, List_o_links **wordlinks)
 			old_andlist = new_andlist;
 
 			if (N_and_elements > 0) {
-				min=MAX_SENTENCE;
+				min=pi->N_words;
 				max=0;
 				for (i=0; i<N_and_elements; i++) {
 					j = and_element_sizes[i];
@@ -747,12 +786,13 @@ Linkage_info analyze_fat_linkage(Sentence sent, Parse_Options opts, int analyze_
 	Postprocessor *postprocessor;
 	Sublinkage *sublinkage;
 	Parse_info pi = sent->parse_info;
-	PP_node accum;			   /* for domain ancestry check */
+	D_type_list ** accum;		   /* for domain ancestry check */
 	D_type_list * dtl0, * dtl1;  /* for domain ancestry check */
 
 	sublinkage = x_create_sublinkage(pi);
 	postprocessor = sent->dict->postprocessor;
-	build_digraph(pi, word_links);
+	word_links = build_digraph(pi);
+	alloc_fat_arrays(pi);
 	structure_violation = FALSE;
 	d_root = build_DIS_CON_tree(pi, word_links); /* may set structure_violation to TRUE */
 
@@ -770,6 +810,7 @@ Linkage_info analyze_fat_linkage(Sentence sent, Parse_Options opts, int analyze_
 		li.N_violations++;
 		free_sublinkage(sublinkage);
 		free_digraph(pi, word_links);
+		free_fat_arrays(pi);
 		free_DIS_tree(d_root);
 		return li;
 	}
@@ -782,7 +823,8 @@ Linkage_info analyze_fat_linkage(Sentence sent, Parse_Options opts, int analyze_
 
 	compute_link_names(sent);
 
-	for (i=0; i<pi->N_links; i++) accum.d_type_array[i] = NULL;
+	accum = (D_type_list **) xalloc(pi->N_links*sizeof(D_type_list *));
+	for (i=0; i<pi->N_links; i++) accum[i] = NULL;
 
 	for (;;) {		/* loop through all the sub linkages */
 		for (i=0; i<pi->N_links; i++) {
@@ -825,11 +867,11 @@ Linkage_info analyze_fat_linkage(Sentence sent, Parse_Options opts, int analyze_
 
 			for (i=0; i<pi->N_links; i++) {
 				if (sublinkage->link[i]->l == -1) continue;
-				if (accum.d_type_array[i] == NULL) {
-					accum.d_type_array[i] = copy_d_type(pp->d_type_array[i]);
+				if (accum[i] == NULL) {
+					accum[i] = copy_d_type(pp->d_type_array[i]);
 				} else {
 					dtl0 = pp->d_type_array[i];
-					dtl1 = accum.d_type_array[i];
+					dtl1 = accum[i];
 					while((dtl0 != NULL) && (dtl1 != NULL) && (dtl0->type == dtl1->type)) {
 						dtl0 = dtl0->next;
 						dtl1 = dtl1->next;
@@ -850,14 +892,16 @@ Linkage_info analyze_fat_linkage(Sentence sent, Parse_Options opts, int analyze_
 	}
 
 	for (i=0; i<pi->N_links; ++i) {
-		free_d_type(accum.d_type_array[i]);
+		free_d_type(accum[i]);
 	}
+	xfree(accum, pi->N_links*sizeof(D_type_list *));
 
 	/* if (display_on && (li.N_violations != 0) &&
 	   (verbosity > 3) && should_print_messages)
 	   printf("P.P. violation in one part of conjunction.\n"); */
 	free_sublinkage(sublinkage);
 	free_digraph(pi, word_links);
+	free_fat_arrays(pi);
 	free_DIS_tree(d_root);
 	return li;
 }
@@ -876,7 +920,6 @@ Linkage_info analyze_thin_linkage(Sentence sent, Parse_Options opts, int analyze
 	Sublinkage *sublinkage;
 	Parse_info pi = sent->parse_info;
 
-	build_digraph(pi, word_links);
 	memset(&li, 0, sizeof(li));
 
 	sublinkage = x_create_sublinkage(pi);
@@ -890,14 +933,9 @@ Linkage_info analyze_thin_linkage(Sentence sent, Parse_Options opts, int analyze
 	if (analyze_pass==PP_FIRST_PASS) {
 		post_process_scan_linkage(postprocessor, opts, sent, sublinkage);
 		free_sublinkage(sublinkage);
-		free_digraph(pi, word_links);
 		return li;
 	}
 
-	/* The code below can be used to generate the "islands" array. For this to work,
-	 * however, you have to call "build_digraph" first (as in analyze_fat_linkage).
-	 * and then "free_digraph". For some reason this causes a space leak. */
-
 	pp = post_process(postprocessor, opts, sent, sublinkage, TRUE);
 
 	li.N_violations = 0;
@@ -917,7 +955,6 @@ Linkage_info analyze_thin_linkage(Sentence sent, Parse_Options opts, int analyze
 	}
 
 	free_sublinkage(sublinkage);
-	free_digraph(pi, word_links);
 	return li;
 }
 
@@ -958,7 +995,8 @@ void extract_fat_linkage(Sentence sent, Parse_Options opts, Linkage linkage)
 	Parse_info pi = sent->parse_info;
 
 	sublinkage = x_create_sublinkage(pi);
-	build_digraph(pi, word_links);
+	word_links = build_digraph(pi);
+	alloc_fat_arrays(pi);
 	structure_violation = FALSE;
 	d_root = build_DIS_CON_tree(pi, word_links);
 
@@ -978,6 +1016,7 @@ void extract_fat_linkage(Sentence sent, Parse_Options opts, Linkage linkage)
 
 		free_sublinkage(sublinkage);
 		free_digraph(pi, word_links);
+		free_fat_arrays(pi);
 		free_DIS_tree(d_root);
 		return;
 	}
@@ -996,6 +1035,7 @@ void extract_fat_linkage(Sentence sent, Parse_Options opts, Linkage linkage)
 		linkage->sublinkage[i].link = NULL;
 		linkage->sublinkage[i].pp_info = NULL;
 		linkage->sublinkage[i].violation = NULL;
+		memset(&linkage->sublinkage[i].pp_data, 0, sizeof(PP_data));
 	}
 
 	/* now fill out the sublinkage arrays */
@@ -1050,6 +1090,7 @@ void extract_fat_linkage(Sentence sent, Parse_Options opts, Linkage linkage)
 
 	free_sublinkage(sublinkage);
 	free_digraph(pi, word_links);
+	free_fat_arrays(pi);
 	free_DIS_tree(d_root);
 }
 
@@ -292,13 +292,12 @@ static void init_LT(Sentence sent) {
 }
 
 static void grow_LT(Sentence sent) {
-	space_in_use -= sent->and_data.LT_bound * sizeof(Disjunct *);
+	account_space(-(int)(sent->and_data.LT_bound * sizeof(Disjunct *)));
 	sent->and_data.LT_bound = (3*sent->and_data.LT_bound)/2;
 	sent->and_data.label_table =
 		(Disjunct **) realloc((void *)sent->and_data.label_table,
 							  sent->and_data.LT_bound * sizeof(Disjunct *));
-	space_in_use += sent->and_data.LT_bound * sizeof(Disjunct *);
-	if (space_in_use > max_space_in_use) max_space_in_use = space_in_use;
+	account_space(sent->and_data.LT_bound * sizeof(Disjunct *));
 	if (sent->and_data.label_table == NULL) {
 		printf("Ran out of space reallocing the label table\n");
 		exit(1);
@@ -982,7 +981,7 @@ Disjunct * build_COMMA_disjunct_list(Sentence sent) {
 	return d1;
 }
 
-Disjunct * build_AND_disjunct_list(Sentence sent, char * s) {
+Disjunct * build_AND_disjunct_list(Sentence sent, const char * s) {
  /* Builds and returns a disjunct list for "and", "or" and "nor" */
  /* for each disjunct in the label_table, we build three disjuncts */
  /* this means that "Danny and Tycho and Billy" will be parsable in */
@@ -1189,18 +1188,19 @@ struct Image_node_struct {
 					   <0 then go -place to the left. */
 };
 
-static Image_node * image_array[MAX_SENTENCE];
-/* points to the image structure for eacch word.  NULL if not a fat word. */
+static Image_node ** image_array;
+/* points to the image structure for eacch word.  NULL if not a fat word.
+   It has one for each word of the sentence being looked at. */
 
-static char has_fat_down[MAX_SENTENCE];  /* TRUE if this word has a fat down link
-									 FALSE otherise */
 int set_has_fat_down(Sentence sent) {
-/* Fill in the has_fat_down array.  Uses link_array[].
+/* Fill in the has_fat_down array of the parse info, which is TRUE for a
+   word if it has a fat down link, FALSE otherwise.  Uses link_array[].
    Returns TRUE if there exists at least one word with a
    fat down label.
 */
 	int link, w, N_fat;
 	Parse_info pi = sent->parse_info;
+	char * has_fat_down = pi->has_fat_down;
 
 	N_fat = 0;
 
@@ -1229,6 +1229,8 @@ static void free_image_array(Parse_info pi) {
 			xfree((char *)in, sizeof(Image_node));
 		}
 	}
+	xfree(image_array, pi->N_words*sizeof(Image_node *));
+	image_array = NULL;
 }
 
 static void build_image_array(Sentence sent) {
@@ -1239,7 +1241,9 @@ static void build_image_array(Sentence sent) {
 	Disjunct * dis, * updis;
 	Image_node * in;
 	Parse_info pi = sent->parse_info;
+	char * has_fat_down = pi->has_fat_down;
 
+	image_array = (Image_node **) xalloc(pi->N_words*sizeof(Image_node *));
 	for (word=0; word<pi->N_words; word++) {
 		image_array[word] = NULL;
 	}
@@ -1365,6 +1369,7 @@ int is_canonical_linkage(Sentence sent)
 	Disjunct *dis, *chosen_d;
 	Image_node * in;
 	Parse_info pi = sent->parse_info;
+	char * has_fat_down = pi->has_fat_down;
 
 	dummy_connector.priority = UP_priority;
 	init_connector(&dummy_connector);
@@ -1459,6 +1464,7 @@ void compute_pp_link_array_connectors(Sentence sent, Sublinkage *sublinkage)
 	Connector * this_end_con, * upcon, * updiscon, *clist, *con, *mycon;
 	Disjunct * dis, * updis, *mydis;
 	Parse_info pi = sent->parse_info;
+	char * has_fat_down = pi->has_fat_down;
 
 	for (end = -1; end <= 1; end += 2) {
 		for (link=0; link<pi->N_links; link++) {
@@ -38,15 +38,20 @@ struct Cost_Model_s {
 
 typedef struct Resources_s * Resources;
 struct Resources_s {
-    int    max_parse_time;  /* was double before --DS */
+    int    max_parse_time;  /* msecs of CPU time, was double before --DS */
+    int    max_wall_time;   /* msecs of real time */
     int    max_memory;
     double time_when_parse_started;
+    double wall_when_parse_started;
     int    space_when_parse_started;
+    int    space_in_use;    /* charged to this parse, see xalloc() */
+    int    max_space_in_use;/* the most of it at any one time */
     double when_created;
     double when_last_called;
     double cumulative_time;
     int    memory_exhausted;
     int    timer_expired;
+    unsigned int checks;    /* see resources_check() */
 };
 
 struct Parse_Options_s {
@@ -65,6 +70,14 @@ struct Parse_Options_s {
   int short_length;      /* Links that are limited in length can be
 			    no longer than this.  Default = 6 */
   int all_short;         /* If true, there can be no connectors that are exempt */
+  int compact_after;     /* compact a sentence once this many of its
+			    linkages have been created (0 = never) */
+  int split_length;      /* parse a sentence this long in segments, at
+			    its split words, if it has any (0 = never) */
+  int cost_staged;       /* if TRUE, try disjunct costs 0, 1, ... up to
+			    disjunct_cost in turn, until one gives linkages */
+  int unknown_word_disjuncts; /* the most disjuncts an unknown word is
+			    parsed with at first (0 = no limit) */
   Cost_Model cost_model; /* For sorting linkages in post_processing */
   Resources resources;   /* For deciding when to "abort" the parsing */
   int display_short;
@@ -91,6 +104,10 @@ typedef struct {
 } Connector_set;
 
 typedef struct Postprocessor_s Postprocessor;
+typedef struct Parse_cache_s Parse_cache;
+typedef struct Parse_cache_entry_s Parse_cache_entry;
+typedef struct Parse_store_s Parse_store;
+typedef struct Word_cache_s Word_cache;
 
 struct Dictionary_s {
     Dict_node *     root;
@@ -110,7 +127,21 @@ struct Dictionary_s {
     int             right_wall_defined;
     Postprocessor * postprocessor;
     Postprocessor * constituent_pp;
+    Parse_cache *   parse_cache;  /* NULL unless enabled */
+    Parse_store *   parse_store;  /* NULL unless opened */
+    Word_cache *    word_cache;   /* NULL if turned off */
+    long            unknown_word_limits;    /* parses that cut down the
+                                               disjuncts of unknown words */
+    long            unknown_word_fallbacks; /* ...and then had to parse
+                                               with all of them after all */
+    unsigned int    identity;     /* sizes and dates of the data files */
     Dictionary      affix_table;
+    /* The affixes of the affix table, sorted by what they are for */
+    const char **   strip_left;
+    const char **   strip_right;
+    const char **   prefix;
+    const char **   suffix;
+    int             l_strippable, r_strippable, p_strippable, s_strippable;
     int             andable_defined;
     Connector_set * andable_connector_set;  /* NULL=everything is andable */
     Connector_set * unlimited_connector_set; /* NULL=everthing is unlimited */
@@ -151,18 +182,20 @@ struct Parse_info_struct {
     X_table_connector ** x_table;
     Parse_set *    parse_set;
     int            N_words;
-    Disjunct *     chosen_disjuncts[MAX_SENTENCE];
+    Disjunct **    chosen_disjuncts;  /* N_words of them */
+    char *         has_fat_down;      /* N_words of them, see and.c */
     int            N_links;
-    struct Link_s  link_array[MAX_LINKS];
+    struct Link_s *link_array;        /* room for MAX_LINKS(N_words) */
 };    
 
 struct Sentence_s {
     Dictionary  dict;           /* words are defined from this dictionary */
     int    length;              /* number of words */
-    Word   word[MAX_SENTENCE];  /* array of words after tokenization */
+    Word * word;                /* array of words after tokenization */
+    int    word_size;           /* the number of words it has room for */
     char * is_conjunction;      /* TRUE if conjunction, as defined by dictionary */
     char** deletable;           /* deletable regions in a sentence with conjunction */
-    char** effective_dist;     
+    short** effective_dist;     
     int    num_linkages_found;  /* total number before postprocessing.  This
 				   is returned by the count() function */
     int    num_linkages_alloced;/* total number of linkages allocated.
@@ -180,6 +213,18 @@ struct Sentence_s {
     String_set *   string_set;  /* used for word names, not connectors */
     And_data       and_data;    /* used to keep track of fat disjuncts */ 
     char  q_pruned_rules;       /* don't prune rules more than once in p.p. */
+    Parse_cache_entry * cache_entry; /* parse results shared with the
+                                   dictionary's cache, or NULL */
+    int    peak_memory;         /* most space its last parse had in use */
+    int    memory;              /* space held for it, as far as the
+                                   parser's counters can tell */
+    int    linkages_created;    /* by linkage_create(), since its last parse */
+    Staged_disjunct ** disjunct_stages; /* each word's disjuncts while a
+                                   cost-staged parse is under way, or NULL */
+    int    staged_cost;         /* the disjunct cost a staged parse got
+                                   to, or -1 if it wasn't staged */
+    int    unknown_words_limited; /* unknown words whose disjuncts the
+                                   last prepare_to_parse() cut down */
 };
 
 /*********************************************************
@@ -188,32 +233,42 @@ struct Sentence_s {
 *
 **********************************************************/
 
-typedef struct DTreeLeaf_s DTreeLeaf;
 typedef struct Domain_s Domain;
 struct Domain_s {
   const char *   string;
-  int            size;
-  List_o_links * lol;
+  int            size;        /* number of links in the domain */
+  int            first;       /* they are domain_links[first..first+size-1] */
   int            start_link;  /* the link that started this domain */
   int            type;        /* one letter name */
-  DTreeLeaf *    child; 
+  int            first_leaf;  /* its leaves, leaf_links[first_leaf..] */
+  int            N_leaves;
   Domain *       parent;
 };
 
-
-struct DTreeLeaf_s {
-  Domain *    parent;
-  int         link;
-  DTreeLeaf * next;
+/* An edge of the undirected graph of a linkage, as seen from one end */
+typedef struct PP_edge_s PP_edge;
+struct PP_edge_s {
+  int link;                       /* the link number */
+  int word;                       /* the word at the other end of it */
 };
 
+/* The arrays below are kept by the postprocessor from one linkage to the
+   next, and only grow; the *_size fields are their allocated sizes. */
 typedef struct PP_data_s PP_data;
 struct PP_data_s {
   int N_domains;
-  List_o_links * word_links[MAX_SENTENCE];
-  List_o_links * links_to_ignore;
-  Domain domain_array[MAX_LINKS]; /* the domains, sorted by size */
+  int * word_start;               /* the edges out of word w are          */
+  PP_edge * edge;                 /*   edge[word_start[w]..word_start[w+1]-1] */
+  int * links_to_ignore;
+  int N_ignored;
+  Domain * domain_array;          /* the domains, sorted by size */
+  int * domain_links;             /* the links of all the domains */
+  int N_domain_links;
+  int * leaf_links;               /* each link, under the smallest domain
+                                     containing it */
+  char * mark;                    /* scratch, one flag per link */
   int length;                     /* length of current sentence */
+  int ws_size, link_size, da_size, dl_size;
 };
 
 struct PP_info_s {
@@ -221,9 +276,23 @@ struct PP_info_s {
     char **   domain_name;
 };
 
+/* A link name seen by a postprocessor, with what the knowledge file has
+   to say about it worked out once: the link sets it is in, the domain it
+   starts, and one bit for every rule whose selector or link set it matches */
+typedef struct pp_link_type_s pp_link_type;
+struct pp_link_type_s {
+  const char *    name;
+  int             flags;    /* PP_LT_* bits, see post-process.c */
+  int             domain;   /* domain type it starts, or -1 */
+  unsigned long * bits;
+  pp_link_type *  next;     /* hash chain */
+};
+
 struct Postprocessor_s
 {
   pp_knowledge *knowledge;             /* internal rep'n of the actual rules */
+  pp_link_type **link_type_table;      /* every link name seen, hashed */
+  int one_words, none_words, cycle_words;  /* sizes of the rule bitsets */
   int n_global_rules_firing;           /* this & the next are diagnostic     */
   int n_local_rules_firing;      
   pp_linkset *set_of_links_of_sentence;     /* seen in *any* linkage of sent */
@@ -232,8 +301,14 @@ struct Postprocessor_s
   int *relevant_contains_none_rules;
   /* the following maintain state during a call to post_process() */
   String_set *sentence_link_name_set;        /* link names seen for sentence */
-  int visited[MAX_SENTENCE];                   /* for the depth-first search */
+  int *visited;                 /* for the depth-first search, one per word */
+  pp_link_type **link_type;                    /* the type of each link */
+  unsigned long *domain_bits;           /* rules matched within one domain */
+  unsigned long *violated;              /* contains rules the linkage breaks */
   PP_node *pp_node;                 
+  int pp_node_size;                     /* allocated size of its type array */
+  D_type_list *d_type_pool;             /* the entries of its type lists */
+  int dtp_size;
   PP_data pp_data;
 };
 
@@ -264,8 +339,11 @@ struct Linkage_s {
     int             current;    /* Allows user to select particular sublinkage */
     Sublinkage *    sublinkage; /* A parse with conjunctions will have several */
     int             unionized;  /* if TRUE, union of links has been computed */
-    Sentence        sent;
+    Sentence        sent;       /* NULL for a linkage that was unpacked */
+    Dictionary      dict;
     Parse_Options   opts;
+    CNode *         constituent_tree;   /* worked out when first asked for */
+    char *          constituent_string; /* the same, flat and bracketed */
 };
 
 
@@ -12,6 +12,7 @@
 /*************************************************************************/
 
 #include <link-grammar/api.h>
+#include <limits.h>
 #include "preparation.h"
 
 /***************************************************************
@@ -61,6 +62,10 @@ Parse_Options parse_options_create(void)
 	po->cost_model.type	   = VDAL;
 	po->short_length = 6;
 	po->all_short = FALSE;
+	po->compact_after = 0;
+	po->split_length = 0;
+	po->cost_staged = FALSE;
+	po->unknown_word_disjuncts = 0;
 	po->twopass_length = 30;
 	po->max_sentence_length = 70;
 	po->resources = resources_create();
@@ -89,6 +94,39 @@ int parse_options_delete(Parse_Options  opts) {
 	return 0;
 }
 
+/**
+ * Returns a new Parse_Options with the same settings as opts, so a
+ * caller can override a few of them without touching the original.
+ * The copy gets resources of its own, with the same limits.
+ */
+Parse_Options parse_options_copy(Parse_Options opts)
+{
+	Parse_Options po;
+
+	po = (Parse_Options) xalloc(sizeof(struct Parse_Options_s));
+	po->resources = resources_create();
+	parse_options_copy_into(po, opts);
+
+	return po;
+}
+
+/**
+ * Changes the settings of to, in place, to those of from.  to keeps
+ * its own resources, set to from's limits, so the sentences and
+ * linkages that point at to see the new settings.
+ */
+void parse_options_copy_into(Parse_Options to, Parse_Options from)
+{
+	Resources r = to->resources;
+
+	if (to == from) return;
+	*to = *from;
+	to->resources = r;
+	r->max_parse_time = from->resources->max_parse_time;
+	r->max_wall_time = from->resources->max_wall_time;
+	r->max_memory = from->resources->max_memory;
+}
+
 void parse_options_set_cost_model_type(Parse_Options opts, int cm)
 {
 	switch(cm) {
@@ -119,6 +157,51 @@ int parse_options_get_linkage_limit(Parse_Options opts) {
 	return opts->linkage_limit;
 }
 
+/** Once this many linkages have been created from a sentence, it is
+    compacted with sentence_compact().  0, the default, leaves every
+    sentence as its parse left it. */
+void parse_options_set_compact_after(Parse_Options opts, int linkages) {
+	opts->compact_after = linkages;
+}
+int parse_options_get_compact_after(Parse_Options opts) {
+	return opts->compact_after;
+}
+
+/** A sentence of at least this many words that has split words in it,
+    such as semicolons, is parsed a segment at a time, and its linkage
+    is stitched together from theirs (see split-parse.c).  0, the
+    default, parses every sentence whole. */
+void parse_options_set_split_length(Parse_Options opts, int words) {
+	opts->split_length = words;
+}
+int parse_options_get_split_length(Parse_Options opts) {
+	return opts->split_length;
+}
+
+/** If TRUE, a sentence is parsed with disjunct costs 0, 1, ... in
+    turn, up to the disjunct_cost, and the first of them that gives it
+    linkages is kept.  The expressions are only expanded into
+    disjuncts once for all of them. */
+void parse_options_set_cost_staged(Parse_Options opts, int val) {
+	opts->cost_staged = val;
+}
+int parse_options_get_cost_staged(Parse_Options opts) {
+	return opts->cost_staged;
+}
+
+/** A word that isn't in the dictionary gets the disjuncts of every
+    category of UNKNOWN-WORD.  With a limit, it is parsed at first with
+    only those of the categories that fit its neighbours best, as many
+    of them as fit in this many disjuncts, and with all of them if that
+    parse needs more null links, or finds nothing.  0, the default, is
+    no limit. */
+void parse_options_set_unknown_word_disjuncts(Parse_Options opts, int disjuncts) {
+	opts->unknown_word_disjuncts = disjuncts;
+}
+int parse_options_get_unknown_word_disjuncts(Parse_Options opts) {
+	return opts->unknown_word_disjuncts;
+}
+
 void parse_options_set_disjunct_cost(Parse_Options opts, int dummy) {
 	opts->disjunct_cost = dummy;
 }
@@ -173,13 +256,43 @@ int parse_options_get_all_short_connectors(Parse_Options opts) {
 }
 
 void parse_options_set_max_parse_time(Parse_Options opts, int dummy) {
-	opts->resources->max_parse_time = dummy;
+	if ((dummy < 0) || (dummy > INT_MAX/1000)) {
+		opts->resources->max_parse_time = MAX_PARSE_TIME_DEFAULT;
+	} else {
+		opts->resources->max_parse_time = 1000*dummy;
+	}
 }
 
+/** In whole seconds, rounded up */
 int parse_options_get_max_parse_time(Parse_Options opts) {
+	if (opts->resources->max_parse_time == MAX_PARSE_TIME_DEFAULT) {
+		return MAX_PARSE_TIME_DEFAULT;
+	}
+	return (opts->resources->max_parse_time + 999) / 1000;
+}
+
+/** The CPU time, in milliseconds, that a parse may use before it is cut
+    short.  Only this thread's time counts, where the system can tell. */
+void parse_options_set_max_parse_msecs(Parse_Options opts, int msecs) {
+	if (msecs < 0) msecs = MAX_PARSE_TIME_DEFAULT;
+	opts->resources->max_parse_time = msecs;
+}
+
+int parse_options_get_max_parse_msecs(Parse_Options opts) {
 	return opts->resources->max_parse_time;
 }
 
+/** The real time, in milliseconds, that a parse may take before it is
+    cut short, however much of it the parse spent waiting. */
+void parse_options_set_max_wall_msecs(Parse_Options opts, int msecs) {
+	if (msecs < 0) msecs = MAX_PARSE_TIME_DEFAULT;
+	opts->resources->max_wall_time = msecs;
+}
+
+int parse_options_get_max_wall_msecs(Parse_Options opts) {
+	return opts->resources->max_wall_time;
+}
+
 void parse_options_set_max_memory(Parse_Options opts, int dummy) {
 	opts->resources->max_memory = dummy;
 }
@@ -325,6 +438,21 @@ void parse_options_reset_resources(Parse_Options opts) {
 *
 ****************************************************************/
 
+/**
+ * Folds a post-processing knowledge file into the dictionary's
+ * identity, the way the dictionary and word files are as they are read.
+ */
+static void knowledge_file_identity(Dictionary dict, const char * name)
+{
+	FILE *fp;
+
+	if (name == NULL) return;
+	fp = dictopen(name, "r");
+	if (fp == NULL) return;
+	file_identity(fp, &dict->identity);
+	fclose(fp);
+}
+
 /**
  * The following function is dictionary_create with an extra 
  * paramater called "path". If this is non-null, then the path 
@@ -358,12 +486,19 @@ dictionary_create(char * dict_name, char * pp_name,
 	dict->word_file_header = NULL;
 	dict->exp_list = NULL;
 	dict->affix_table = NULL;
+	dict->parse_cache = NULL;
+	dict->parse_store = NULL;
+	dict->word_cache = NULL;
+	dict->unknown_word_limits = 0;
+	dict->unknown_word_fallbacks = 0;
+	dict->identity = 2166136261U;
 
 	dict->fp = dictopen(dict->name, "r");
 	if (dict->fp == NULL) {
 		lperror(NODICT, dict_name);
 		goto failure;
 	}
+	file_identity(dict->fp, &dict->identity);
 
 	if (!read_dictionary(dict)) {
 		goto failure;
@@ -376,7 +511,11 @@ dictionary_create(char * dict_name, char * pp_name,
 			fprintf(stderr, "%s\n", lperrmsg);
 			goto failure;
 		}
+		dict->identity ^= dict->affix_table->identity;
 	}
+	build_affix_lists(dict);
+	knowledge_file_identity(dict, pp_name);
+	knowledge_file_identity(dict, cons_name);
 
 	dict->left_wall_defined  = boolean_dictionary_lookup(dict, LEFT_WALL_WORD);
 	dict->right_wall_defined = boolean_dictionary_lookup(dict, RIGHT_WALL_WORD);
@@ -409,6 +548,7 @@ dictionary_create(char * dict_name, char * pp_name,
 	}
 	free_lookup_list(dict_node);
 
+	dict->word_cache = word_cache_create(WORD_CACHE_DEFAULT_SIZE);
 	return dict;
 
 failure:
@@ -468,12 +608,16 @@ int dictionary_delete(Dictionary dict)
 		fprintf(stderr, "Freeing dictionary %s\n", dict->name);
 	}
 
+	free_affix_lists(dict);
 	if (dict->affix_table != NULL) {
 		dictionary_delete(dict->affix_table);
 	}
+	word_cache_delete(dict->word_cache);
 
 	connector_set_delete(dict->andable_connector_set);
 	connector_set_delete(dict->unlimited_connector_set);
+	parse_cache_delete(dict->parse_cache);
+	parse_store_delete(dict->parse_store);
 
 	post_process_close(dict->postprocessor);
 	post_process_close(dict->constituent_pp);
@@ -489,6 +633,19 @@ int dictionary_get_max_cost(Dictionary dict)
 	return dict->max_cost;
 }
 
+/** The number of parses that cut down the disjuncts of unknown words,
+    with the unknown_word_disjuncts option */
+long dictionary_get_unknown_word_limits(Dictionary dict)
+{
+	return dict->unknown_word_limits;
+}
+
+/** The number of those that had to parse again with all of them */
+long dictionary_get_unknown_word_fallbacks(Dictionary dict)
+{
+	return dict->unknown_word_fallbacks;
+}
+
 
 /***************************************************************
 *
@@ -496,14 +653,18 @@ int dictionary_get_max_cost(Dictionary dict)
 *
 ****************************************************************/
 
-Sentence sentence_create(char *input_string, Dictionary dict)
+/**
+ * The part of making a sentence that comes before its words are known.
+ */
+static Sentence sentence_alloc(Dictionary dict)
 {
 	Sentence sent;
-	int i;
 
 	sent = (Sentence) xalloc(sizeof(struct Sentence_s));
 	sent->dict = dict;
 	sent->length = 0;
+	sent->word = NULL;
+	sent->word_size = 0;
 	sent->num_linkages_found = 0;
 	sent->num_linkages_alloced = 0;
 	sent->num_linkages_post_processed = 0;
@@ -514,10 +675,30 @@ Sentence sentence_create(char *input_string, Dictionary dict)
 	sent->num_valid_linkages = 0;
 	sent->null_count = 0;
 	sent->parse_info = NULL;
+	sent->cache_entry = NULL;
+	sent->peak_memory = 0;
+	sent->linkages_created = 0;
+	sent->disjunct_stages = NULL;
+	sent->staged_cost = -1;
+	sent->unknown_words_limited = 0;
 	sent->string_set = string_set_create();
+	return sent;
+}
+
+/**
+ * The part of making a sentence that comes after its words are known:
+ * looks them up and builds their expressions.  If the words couldn't
+ * be separated, or any of this fails, the sentence is freed and NULL
+ * is returned.
+ */
+static Sentence sentence_finish(Sentence sent, int separated, int before)
+{
+	int i;
+	Dictionary dict = sent->dict;
 
-	if (!separate_sentence(input_string, sent)) {
+	if (!separated) {
 		string_set_delete(sent->string_set);
+		xfree(sent->word, sent->word_size*sizeof(Word));
 		xfree(sent, sizeof(struct Sentence_s));
 		return NULL;
 	}
@@ -545,9 +726,36 @@ Sentence sentence_create(char *input_string, Dictionary dict)
 		return NULL;
 	}
 
+	sent->memory = space_in_use - before;
 	return sent;
 }
 
+Sentence sentence_create(char *input_string, Dictionary dict)
+{
+	Sentence sent;
+	int before;
+
+	before = space_in_use;
+	sent = sentence_alloc(dict);
+	return sentence_finish(sent, separate_sentence(input_string, sent), before);
+}
+
+/**
+ * Makes a sentence from words the caller has already separated, rather
+ * than from a string.  The tokens are used as they are (see
+ * separate_tokens()), so sentence_get_word(sent, i) is tokens[i-1] when
+ * the dictionary has a left wall, and tokens[i] when it hasn't.
+ */
+Sentence sentence_create_from_tokens(const char **tokens, int num_tokens, Dictionary dict)
+{
+	Sentence sent;
+	int before;
+
+	before = space_in_use;
+	sent = sentence_alloc(dict);
+	return sentence_finish(sent, separate_tokens(tokens, num_tokens, sent), before);
+}
+
 static void free_andlists(Sentence sent) 
 {
 	int L;
@@ -559,6 +767,8 @@ static void free_andlists(Sentence sent)
 		while(1) {
 			if(andlist == NULL) break;
 			next = andlist->next;
+			xfree(andlist->element, andlist->num_elements*sizeof(int));
+			xfree(andlist->outside_word, andlist->num_outside_words*sizeof(int));
 			xfree((char *) andlist, sizeof(Andlist));
 			andlist = next;
 		}
@@ -585,13 +795,36 @@ void sentence_delete(Sentence sent)
 	string_set_delete(sent->string_set);
 	free_parse_set(sent);
 	free_post_processing(sent);
+	parse_cache_release(sent->cache_entry);
 	post_process_close_sentence(sent->dict->postprocessor);
 	free_deletable(sent);
 	free_effective_dist(sent);
 	xfree(sent->is_conjunction, sizeof(char)*sent->length);
+	xfree(sent->word, sent->word_size*sizeof(Word));
 	xfree((char *) sent, sizeof(struct Sentence_s));
 }
 
+/**
+ * Frees what the parse of a sentence needed to find its linkages -- the
+ * parse set, the disjuncts and the conjunction tables -- and keeps what
+ * describes the linkages it found.  Linkages already created are not
+ * affected, and the counts and costs of the rest can still be asked
+ * for.  Creating one of the rest parses the sentence again, with the
+ * options it is created with.
+ */
+void sentence_compact(Sentence sent)
+{
+	int before;
+
+	if (!sent) return;
+	before = space_in_use;
+	free_parse_set(sent);
+	free_sentence_disjuncts(sent);
+	free_deletable(sent);
+	free_effective_dist(sent);
+	sent->memory += space_in_use - before;
+}
+
 int sentence_length(Sentence sent)
 {
 	if (!sent) return 0;
@@ -600,7 +833,7 @@ int sentence_length(Sentence sent)
 
 char * sentence_get_word(Sentence sent, int index) {
 	if (!sent) return NULL;
-	return sent->word[index].string;
+	return (char *) sent->word[index].string;
 }
 
 int sentence_null_count(Sentence sent) {
@@ -618,6 +851,22 @@ int sentence_num_valid_linkages(Sentence sent) {
 	return sent->num_valid_linkages;
 }
 
+/** The most space, in bytes, that the last parse had in use at once */
+int sentence_peak_memory(Sentence sent) {
+	if (!sent) return 0;
+	return sent->peak_memory;
+}
+
+/** The space, in bytes, that the sentence is holding on to: what was
+    allocated for it when it was created, and what its parses left
+    behind.  Parse results shared with the dictionary's parse cache are
+    counted for the sentence that put them there. */
+int sentence_memory_in_use(Sentence sent) {
+	if (!sent) return 0;
+	if (sent->memory < (int) sizeof(struct Sentence_s)) return sizeof(struct Sentence_s);
+	return sent->memory;
+}
+
 int sentence_num_linkages_post_processed(Sentence sent) {
 	if (!sent) return 0;
 	return sent->num_linkages_post_processed;
@@ -645,11 +894,14 @@ int sentence_link_cost(Sentence sent, int i) {
 
 char * sentence_get_nth_word(Sentence sent, int i) {
 	if (!sent) return NULL;
-	return sent->word[i].string;
+	return (char *) sent->word[i].string;
 }
 
 int sentence_nth_word_has_disjunction(Sentence sent, int i) {
 	if (!sent) return 0;
+	if (sent->parse_info == NULL && sent->cache_entry != NULL) {
+		return parse_cache_has_disjunction(sent->cache_entry, i);
+	}
 	return (sent->parse_info->chosen_disjuncts[i] != NULL);
 }
 
@@ -676,6 +928,16 @@ static void post_process_linkages(Sentence sent, Parse_Options opts)
 	overflowed = build_parse_set(sent, sent->null_count, opts);
 	print_time(opts, "Built parse set");
 
+	/* A parse set cut short by the resource limits does not hold the
+	   linkages its counts say it does, so none are taken from it. */
+	if (resources_exhausted(opts->resources)) {
+		sent->num_linkages_alloced = 0;
+		sent->num_linkages_post_processed = 0;
+		sent->num_valid_linkages = 0;
+		sent->link_info = NULL;
+		return;
+	}
+
 	if (overflowed) {
 		/* We know that sent->num_linkages_found is bogus, possibly negative */
 		sent->num_linkages_found = opts->linkage_limit;
@@ -802,25 +1064,15 @@ static void post_process_linkages(Sentence sent, Parse_Options opts)
 	/*if(N_valid_linkages == 0) free_andlists(sent); */
 }
 
-int sentence_parse(Sentence sent, Parse_Options opts)
+/**
+ * Counts and post-processes the linkages of a sentence whose disjuncts
+ * have been prepared, with the fewest null links it can.
+ */
+static void parse_prepared(Sentence sent, Parse_Options opts)
 {
 	int nl;
 	s64 total;
 
-	verbosity = opts->verbosity;
-
-	free_sentence_disjuncts(sent);
-	resources_reset_space(opts->resources);
-
-	if (resources_exhausted(opts->resources)) {
-		sent->num_valid_linkages = 0;
-		return 0;
-	}
-
-	expression_prune(sent);
-	print_time(opts, "Finished expression pruning");
-	prepare_to_parse(sent, opts);
-
 	init_fast_matcher(sent);
 	init_table(sent);
 
@@ -847,11 +1099,335 @@ int sentence_parse(Sentence sent, Parse_Options opts)
 
 	free_table(sent);
 	free_fast_matcher(sent);
+}
+
+static int parse_uncached(Sentence sent, Parse_Options opts)
+{
+	int limit;
+
+	/* A staged parse has pruned them already, before expanding them */
+	if (sent->disjunct_stages == NULL) {
+		expression_prune(sent);
+		print_time(opts, "Finished expression pruning");
+	}
+	prepare_to_parse(sent, opts);
+	parse_prepared(sent, opts);
+
+	/* If cutting down the unknown words' disjuncts cost the sentence
+	   its linkages, or made it need null links, parse it again with
+	   all of them */
+	if (sent->unknown_words_limited > 0) {
+		sent->dict->unknown_word_limits++;
+		if (((sent->num_valid_linkages == 0) || (sent->null_count > opts->min_null_count)) &&
+			!resources_exhausted(opts->resources)) {
+			sent->dict->unknown_word_fallbacks++;
+			print_time(opts, "Parsed with unknown words cut down");
+			free_sentence_disjuncts(sent);
+			limit = opts->unknown_word_disjuncts;
+			opts->unknown_word_disjuncts = 0;
+			prepare_to_parse(sent, opts);
+			opts->unknown_word_disjuncts = limit;
+			parse_prepared(sent, opts);
+		}
+	}
 	print_time(opts, "Finished parse");
 
 	return sent->num_valid_linkages;
 }
 
+/**
+ * Adds a sentence just parsed to the dictionary's parse store.  A store
+ * is read by other processes that have no parse set to fall back on,
+ * so every linkage is built first, which leaves its image in the entry.
+ */
+static void save_parse(Sentence sent, Parse_Options opts)
+{
+	int k, compact_after;
+
+	/* These linkages are not the caller's, so they don't count
+	   towards compacting the sentence */
+	compact_after = opts->compact_after;
+	opts->compact_after = 0;
+	for (k=0; k<sent->num_linkages_post_processed; k++) {
+		linkage_delete(linkage_create(k, sent, opts));
+	}
+	opts->compact_after = compact_after;
+	sent->linkages_created = 0;
+	parse_store_save(sent->dict->parse_store, sent->cache_entry);
+}
+
+/**
+ * Parses the sentence with the options' disjunct cost, from the cache
+ * if it can.  stage_cutoff is the highest cost of a cost-staged parse
+ * this is one stage of, or -1 if it isn't one: the first stage that
+ * has to be parsed for real expands the disjuncts for all of them.
+ */
+static int parse_at_cost(Sentence sent, Parse_Options opts, int stage_cutoff)
+{
+	Parse_cache *pc = sent->dict->parse_cache;
+	Parse_store *ps = sent->dict->parse_store;
+	Parse_cache_entry *e;
+	const char *found;
+
+	free_sentence_disjuncts(sent);
+	parse_cache_release(sent->cache_entry);
+	sent->cache_entry = NULL;
+
+	e = NULL;
+	if (pc != NULL) {
+		e = parse_cache_lookup(pc, sent, opts);
+	}
+	if ((e == NULL) && (ps != NULL)) {
+		e = parse_store_lookup(ps, sent, opts);
+		if ((e != NULL) && (pc != NULL)) e = parse_cache_add(pc, e);
+	}
+	found = "Found parse in cache";
+	if ((e == NULL) && (opts->split_length > 0) && (sent->length >= opts->split_length)) {
+		e = split_parse(sent, opts);
+		found = "Parsed in segments";
+		if ((e == NULL) && resources_exhausted(opts->resources)) return 0;
+	}
+	if (e != NULL) {
+		sent->cache_entry = e;
+		free_parse_set(sent);
+		free_post_processing(sent);
+		parse_cache_restore(e, sent);
+		print_time(opts, found);
+		return sent->num_valid_linkages;
+	}
+
+	if ((stage_cutoff >= 0) && (sent->disjunct_stages == NULL)) {
+		expression_prune(sent);
+		print_time(opts, "Finished expression pruning");
+		build_sentence_disjunct_stages(sent, stage_cutoff);
+		print_time(opts, "Built disjuncts for every stage");
+	}
+	parse_uncached(sent, opts);
+
+	/* A parse cut short by the resource limits is not the answer
+	   the same options would give next time, so it is not kept. */
+	if (((pc != NULL) || (ps != NULL)) && !resources_exhausted(opts->resources)) {
+		sent->cache_entry = parse_cache_entry_create(sent, opts);
+		if ((ps != NULL) && parse_store_writable(ps)) {
+			save_parse(sent, opts);
+		}
+		if (pc != NULL) sent->cache_entry = parse_cache_add(pc, sent->cache_entry);
+	}
+
+	return sent->num_valid_linkages;
+}
+
+/**
+ * Parses the sentence with disjunct costs 0, 1, ... up to the options'
+ * disjunct cost, stopping at the first that gives it linkages or when
+ * the resources run out.  The options' disjunct cost is only changed
+ * while this runs; the cost the parse got to is the sentence's
+ * staged_cost.
+ */
+static int parse_staged(Sentence sent, Parse_Options opts)
+{
+	int cost, max_cost, n;
+
+	max_cost = opts->disjunct_cost;
+	n = 0;
+	for (cost = 0; cost <= max_cost; cost++) {
+		opts->disjunct_cost = cost;
+		n = parse_at_cost(sent, opts, max_cost);
+		if ((n > 0) || resources_exhausted(opts->resources)) break;
+	}
+	opts->disjunct_cost = max_cost;
+	sent->staged_cost = MIN(cost, max_cost);
+	free_sentence_disjunct_stages(sent);
+
+	return n;
+}
+
+static int parse_sentence(Sentence sent, Parse_Options opts, int reset)
+{
+	verbosity = opts->verbosity;
+
+	/* What is left of the last parse is freed before the resources
+	   are reset, so that freeing it isn't taken off this one's charge */
+	free_sentence_disjuncts(sent);
+	free_parse_set(sent);
+	free_post_processing(sent);
+	free_deletable(sent);
+	free_effective_dist(sent);
+	parse_cache_release(sent->cache_entry);
+	sent->cache_entry = NULL;
+	sent->num_linkages_found = 0;
+	sent->num_linkages_post_processed = 0;
+	sent->num_valid_linkages = 0;
+
+	if (reset) resources_reset(opts->resources);
+	sent->linkages_created = 0;
+	sent->staged_cost = -1;
+
+	if (resources_exhausted(opts->resources)) return 0;
+
+	if (opts->cost_staged && (opts->disjunct_cost > 0)) {
+		return parse_staged(sent, opts);
+	}
+	return parse_at_cost(sent, opts, -1);
+}
+
+static int parse_charged(Sentence sent, Parse_Options opts, int reset)
+{
+	Resources charged;
+	int n, before;
+
+	before = space_in_use;
+	charged = charged_resources;
+	charged_resources = opts->resources;
+	n = parse_sentence(sent, opts, reset);
+	sent->peak_memory = opts->resources->max_space_in_use;
+	charged_resources = charged;
+	sent->memory += space_in_use - before;
+
+	return n;
+}
+
+/**
+ * Everything xalloc()ed while the sentence is parsed is charged to the
+ * options' resources, which is what their max_memory limits.  The
+ * most that was in use at once is kept as the sentence's peak memory.
+ */
+int sentence_parse(Sentence sent, Parse_Options opts)
+{
+	return parse_charged(sent, opts, TRUE);
+}
+
+/**
+ * Parses a segment of a sentence being parsed with split_parse(), with
+ * the resources of the whole sentence as they stand: its time and
+ * memory are charged to those, and its limits are what is left of
+ * theirs.
+ */
+int sentence_parse_segment(Sentence sent, Parse_Options opts)
+{
+	return parse_charged(sent, opts, FALSE);
+}
+
+/**
+ * Runs one pass of sentence_parse_racing() with what is left of the
+ * deadline, less what is held back for the passes after it.  A pass
+ * there's no time left for is not run, and counts as timed out.
+ */
+static int race_pass(Sentence sent, Parse_Options pass, Resources deadline, int reserve)
+{
+	int left;
+
+	left = resources_wall_time_left(deadline);
+	if (left != MAX_PARSE_TIME_DEFAULT) {
+		left -= reserve;
+		if (left <= 0) {
+			pass->resources->timer_expired = TRUE;
+			return 0;
+		}
+		if ((pass->resources->max_wall_time == MAX_PARSE_TIME_DEFAULT) ||
+			(left < pass->resources->max_wall_time)) {
+			pass->resources->max_wall_time = left;
+		}
+	}
+	return sentence_parse(sent, pass);
+}
+
+/**
+ * Parses the sentence the way link-parser does: with no null links,
+ * then with null links if the options allow them, then, if neither
+ * found a linkage before running out of resources, with the cheap
+ * "panic" options.  Those are panic_opts, or if it is NULL, opts with
+ * link-parser's panic settings.
+ *
+ * The wall-clock limit of opts is a deadline for all of the passes
+ * together, not for each one: a quarter of it is held back for the
+ * panic pass, and each pass is cut off through its resources when its
+ * share runs out.  The passes are run one after another, since the
+ * parser keeps its state in file statics and can't run two at once.
+ * Whether the parse that's left was cut short shows in opts'
+ * resources afterwards.
+ */
+int sentence_parse_racing(Sentence sent, Parse_Options opts, Parse_Options panic_opts)
+{
+	Parse_Options pass;
+	Resources deadline;
+	int n, reserve, exhausted;
+
+	deadline = resources_create();
+	deadline->max_wall_time = opts->resources->max_wall_time;
+	reserve = 0;
+	if (deadline->max_wall_time != MAX_PARSE_TIME_DEFAULT) {
+		reserve = deadline->max_wall_time / 4;
+	}
+
+	pass = parse_options_copy(opts);
+	pass->min_null_count = 0;
+	pass->max_null_count = 0;
+	n = race_pass(sent, pass, deadline, reserve);
+	exhausted = resources_exhausted(pass->resources);
+
+	if ((n == 0) && opts->allow_null) {
+		pass->min_null_count = 1;
+		pass->max_null_count = sentence_length(sent);
+		n = race_pass(sent, pass, deadline, reserve);
+		exhausted = exhausted || resources_exhausted(pass->resources);
+	}
+
+	if ((n == 0) && exhausted) {
+		parse_options_delete(pass);
+		if (panic_opts != NULL) {
+			pass = parse_options_copy(panic_opts);
+		} else {
+			pass = parse_options_copy(opts);
+			pass->disjunct_cost = 3;
+			pass->min_null_count = 1;
+			pass->max_null_count = sentence_length(sent);
+			pass->resources->max_parse_time = 60000;
+			pass->islands_ok = TRUE;
+			pass->short_length = 6;
+			pass->all_short = TRUE;
+			pass->linkage_limit = 100;
+		}
+		n = race_pass(sent, pass, deadline, 0);
+	}
+
+	opts->resources->timer_expired = pass->resources->timer_expired;
+	opts->resources->memory_exhausted = pass->resources->memory_exhausted;
+	parse_options_delete(pass);
+	resources_delete(deadline);
+
+	return n;
+}
+
+/**
+ * A sentence restored from the parse cache, or compacted, has no parse
+ * set.  When it is asked for a linkage it has no image of, parse it
+ * again: with the options it was cached under if it came from the
+ * cache, otherwise with the ones it is asked with, and a fresh set of
+ * resources.
+ */
+static int reparse_sentence(Sentence sent, Parse_Options opts)
+{
+	Parse_Options reparse_opts;
+	int before;
+
+	before = space_in_use;
+	if (sent->cache_entry != NULL) {
+		reparse_opts = parse_options_create();
+		reparse_opts->verbosity = opts->verbosity;
+		parse_cache_entry_options(sent->cache_entry, reparse_opts);
+	} else {
+		reparse_opts = parse_options_copy(opts);
+		if (sent->staged_cost >= 0) reparse_opts->disjunct_cost = sent->staged_cost;
+	}
+	free_sentence_disjuncts(sent);
+	parse_uncached(sent, reparse_opts);
+	parse_options_delete(reparse_opts);
+	sent->memory += space_in_use - before;
+
+	return (sent->parse_info != NULL);
+}
+
 /***************************************************************
 *
 * Routines which allow user access to Linkages.
@@ -861,9 +1437,19 @@ int sentence_parse(Sentence sent, Parse_Options opts)
 Linkage linkage_create(int k, Sentence sent, Parse_Options opts)
 {
 	Linkage linkage;
+	int i;
 
 	if ((k >= sent->num_linkages_post_processed) || (k < 0)) return NULL;
 
+	if (sent->parse_info == NULL) {
+		if (sent->cache_entry != NULL) {
+			linkage = parse_cache_linkage(sent->cache_entry, k, sent, opts);
+			if (linkage != NULL) return linkage;
+		}
+		if (!reparse_sentence(sent, opts)) return NULL;
+		if (k >= sent->num_linkages_post_processed) return NULL;
+	}
+
 	/* Using exalloc since this is external to the parser itself. */
 	linkage = (Linkage) exalloc(sizeof(struct Linkage_s));
 
@@ -874,8 +1460,11 @@ Linkage linkage_create(int k, Sentence sent, Parse_Options opts)
 	linkage->sublinkage = NULL;
 	linkage->unionized = FALSE;
 	linkage->sent = sent;
+	linkage->dict = sent->dict;
 	linkage->opts = opts;
 	linkage->info = sent->link_info[k];
+	linkage->constituent_tree = NULL;
+	linkage->constituent_string = NULL;
 
 	extract_links(sent->link_info[k].index, sent->null_count, sent->parse_info);
 	compute_chosen_words(sent, linkage);
@@ -889,11 +1478,50 @@ Linkage linkage_create(int k, Sentence sent, Parse_Options opts)
 
 	if (sent->dict->postprocessor != NULL) {
 	   linkage_post_process(linkage, sent->dict->postprocessor);
+	   /* Only the domain names are wanted from this pass; the
+	      constituent code post-processes again when it needs domains. */
+	   for (i=0; i<linkage->num_sublinkages; ++i) {
+		   post_process_free_domains(&linkage->sublinkage[i].pp_data);
+	   }
+	}
+
+	if (sent->cache_entry != NULL) {
+		parse_cache_store_linkage(sent->cache_entry, k, linkage);
+	}
+
+	if (++sent->linkages_created == opts->compact_after) {
+		sentence_compact(sent);
 	}
 
 	return linkage;
 }
 
+/**
+ * Returns the linkage packed into one block of bytes, and its size in
+ * *size, for handing to another process or keeping.  Free it with
+ * linkage_pack_delete().
+ */
+char * linkage_pack(Linkage linkage, int *size)
+{
+	return parse_cache_pack_linkage(linkage, size);
+}
+
+void linkage_pack_delete(char *packed)
+{
+	parse_cache_pack_delete(packed);
+}
+
+/**
+ * Rebuilds a linkage from its packed form, using the given dictionary
+ * and options to display it.  The linkage has no sentence, so it has
+ * no constituent tree.  Returns NULL if packed does not hold a linkage
+ * packed by this version of the library on this kind of machine.
+ */
+Linkage linkage_unpack(const char *packed, int size, Dictionary dict, Parse_Options opts)
+{
+	return parse_cache_unpack_linkage(packed, size, dict, opts);
+}
+
 int linkage_get_current_sublinkage(Linkage linkage) {
     return( linkage->current );
 }
@@ -946,16 +1574,69 @@ void linkage_delete(Linkage linkage)
 			}
 			exfree(s->pp_info, sizeof(PP_info)*s->num_links);
 			s->pp_info = NULL;
-			post_process_free_data(&s->pp_data);
 		}
+		post_process_free_domains(&s->pp_data);
 		if (s->violation != NULL) {
 			exfree((char *) s->violation, sizeof(char)*(strlen(s->violation)+1));
 		}
 	}
 	exfree(linkage->sublinkage, sizeof(Sublinkage)*linkage->num_sublinkages);
+	linkage_free_constituents(linkage);
 	exfree(linkage, sizeof(struct Linkage_s));
 }
 
+static int connectors_memory_in_use(Connector *e)
+{
+	int size = 0;
+	for (; e != NULL; e = e->next) {
+		size += sizeof(Connector) + strlen(e->string) + 1;
+	}
+	return size;
+}
+
+/** The space, in bytes, that the linkage is holding on to; what
+    linkage_delete() would give back. */
+int linkage_memory_in_use(Linkage linkage)
+{
+	int i, j, k, size;
+	Sublinkage *s;
+	Link l;
+
+	if (NULL == linkage) return 0;
+
+	size = sizeof(struct Linkage_s) + sizeof(char *)*linkage->num_words;
+	for (i=0; i<linkage->num_words; ++i) {
+		size += strlen(linkage->word[i]) + 1;
+	}
+	size += sizeof(Sublinkage)*linkage->num_sublinkages;
+	for (i=0; i<linkage->num_sublinkages; ++i)
+	{
+		s = &(linkage->sublinkage[i]);
+		size += sizeof(Link)*s->num_links;
+		for (j=0; j<s->num_links; ++j) {
+			l = s->link[j];
+			size += sizeof(struct Link_s) + strlen(l->name) + 1;
+			size += connectors_memory_in_use(l->lc);
+			size += connectors_memory_in_use(l->rc);
+		}
+		if (s->pp_info != NULL) {
+			size += sizeof(PP_info)*s->num_links;
+			for (j=0; j<s->num_links; ++j) {
+				size += sizeof(char *)*s->pp_info[j].num_domains;
+				for (k=0; k<s->pp_info[j].num_domains; ++k) {
+					size += strlen(s->pp_info[j].domain_name[k]) + 1;
+				}
+			}
+		}
+		size += s->pp_data.da_size*sizeof(Domain) + s->pp_data.dl_size*sizeof(int);
+		if (s->violation != NULL) {
+			size += strlen(s->violation) + 1;
+		}
+	}
+	size += linkage_constituents_memory_in_use(linkage);
+	return size;
+}
+
 static int links_are_equal(Link l, Link m) {
 	return ((l->l == m->l) && (l->r == m->r) && (strcmp(l->name, m->name)==0));
 }
@@ -1060,6 +1741,7 @@ int linkage_compute_union(Linkage linkage)
 	linkage->sublinkage[num_subs] = unionize_linkage(linkage);
 
 	linkage->num_sublinkages++;
+	linkage_free_constituents(linkage);
 
 	linkage->unionized = TRUE;
 	linkage->current = linkage->num_sublinkages-1;
@@ -1091,12 +1773,13 @@ static int verify_link_index(Linkage linkage, int index) {
 
 int linkage_get_link_length(Linkage linkage, int index) {
 	Link link;
-	int word_has_link[MAX_SENTENCE];
+	char * word_has_link;
 	int i, length;
 	int current = linkage->current;
 
 	if (!verify_link_index(linkage, index)) return -1;
 
+	word_has_link = (char *) exalloc(linkage->num_words+1);
 	for (i=0; i<linkage->num_words+1; ++i) {
 		word_has_link[i] = FALSE;
 	}
@@ -1112,6 +1795,7 @@ int linkage_get_link_length(Linkage linkage, int index) {
 	for (i= link->l+1; i < link->r; ++i) {
 		if (!word_has_link[i]) length--;
 	}
+	exfree(word_has_link, linkage->num_words+1);
 	return length;
 }
 
@@ -1220,6 +1904,8 @@ void linkage_post_process(Linkage linkage, Postprocessor * postprocessor)
 	int i, j, k;
 	D_type_list * d;
 
+	if (sent == NULL) return;
+
 	for (i=0; i<N_sublinkages; ++i) {
 
 		subl = &linkage->sublinkage[i];
@@ -1227,9 +1913,9 @@ void linkage_post_process(Linkage linkage, Postprocessor * postprocessor)
 			for (j=0; j<subl->num_links; ++j) {
 				exfree_pp_info(&subl->pp_info[j]);
 			}
-			post_process_free_data(&subl->pp_data);
 			exfree(subl->pp_info, sizeof(PP_info)*subl->num_links);
 		}
+		post_process_free_domains(&subl->pp_data);
 		subl->pp_info = (PP_info *) exalloc(sizeof(PP_info)*subl->num_links);
 		for (j=0; j<subl->num_links; ++j) {
 			subl->pp_info[j].num_domains = 0;
@@ -1269,7 +1955,7 @@ void linkage_post_process(Linkage linkage, Postprocessor * postprocessor)
 					k++;
 				}
 			}
-			subl->pp_data = postprocessor->pp_data;
+			post_process_save_domains(postprocessor, &subl->pp_data);
 			if (pp->violation != NULL) {
 				char * s = (char *) exalloc(sizeof(char)*(strlen(pp->violation)+1));
 				strcpy(s, pp->violation);
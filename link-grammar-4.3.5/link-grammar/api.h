@@ -41,6 +41,9 @@
 #include <link-grammar/idiom.h>
 #include <link-grammar/linkset.h>
 #include <link-grammar/massage.h>
+#include <link-grammar/parse-cache.h>
+#include <link-grammar/word-cache.h>
+#include <link-grammar/parse-store.h>
 #include <link-grammar/post-process.h>
 #include <link-grammar/pp_knowledge.h>
 #include <link-grammar/pp_lexer.h>
@@ -51,6 +54,7 @@
 #include <link-grammar/prune.h>
 #include <link-grammar/read-dict.h>
 #include <link-grammar/resources.h>
+#include <link-grammar/split-parse.h>
 #include <link-grammar/string-set.h>
 #include <link-grammar/tokenize.h>
 #include <link-grammar/utilities.h>
@@ -298,6 +298,19 @@ static Connector * extract_connectors(Tconnector *e, int c)
 	}
 }
 
+/** builds the disjunct for the single clause cl */
+static Disjunct * disjunct_of_clause(Clause * cl, const char * string)
+{
+	Disjunct *ndis;
+	ndis = (Disjunct *) xalloc(sizeof(Disjunct));
+	ndis->left = reverse(extract_connectors(cl->c, '-'));
+	ndis->right = reverse(extract_connectors(cl->c, '+'));
+	ndis->string = string;
+	ndis->cost = cl->cost;
+	ndis->next = NULL;
+	return ndis;
+}
+
 /**
  * build a disjunct list out of the clause list c.
  * string is the print name of word that generated this disjunct.
@@ -309,11 +322,7 @@ build_disjunct(Clause * cl, const char * string, int cost_cutoff)
 	dis = NULL;
 	for (;cl != NULL; cl=cl->next) {
 		if (cl->maxcost <= cost_cutoff) {
-			ndis = (Disjunct *) xalloc(sizeof(Disjunct));
-			ndis->left = reverse(extract_connectors(cl->c, '-'));
-			ndis->right = reverse(extract_connectors(cl->c, '+'));
-			ndis->string = string;
-			ndis->cost = cl->cost;
+			ndis = disjunct_of_clause(cl, string);
 			ndis->next = dis;
 			dis = ndis;
 		}
@@ -423,3 +432,88 @@ void build_sentence_disjuncts(Sentence sent, int cost_cutoff)
 		sent->word[w].d = d;
 	}
 }
+
+/**
+ * For a parse that admits the costlier disjuncts in stages: expands
+ * the sentence expressions into disjuncts up to cost_cutoff just once,
+ * noting the cost that each one needs.  Each stage then only copies the
+ * ones it admits, with stage_sentence_disjuncts(), rather than expanding
+ * the expressions over again.  The copies are what get pruned, since
+ * pruning at one cost says nothing about what is left at the next.
+ *
+ * The disjuncts are kept in the order build_sentence_disjuncts() would
+ * make them in, so a stage gets the same linkages, in the same order,
+ * as a parse with only its cost.
+ */
+void build_sentence_disjunct_stages(Sentence sent, int cost_cutoff)
+{
+	Clause *c, *cl;
+	Staged_disjunct *s, *head, *tail, *w_head;
+	X_node * x;
+	int w;
+
+	sent->disjunct_stages =
+		(Staged_disjunct **) xalloc(sent->length * sizeof(Staged_disjunct *));
+	for (w=0; w<sent->length; w++) {
+		w_head = NULL;
+		for (x=sent->word[w].x; x!=NULL; x = x->next){
+			c = build_clause(x->exp, cost_cutoff);
+			head = tail = NULL;
+			for (cl = c; cl != NULL; cl = cl->next) {
+				if (cl->maxcost > cost_cutoff) continue;
+				s = (Staged_disjunct *) xalloc(sizeof(Staged_disjunct));
+				s->maxcost = cl->maxcost;
+				s->d = disjunct_of_clause(cl, x->string);
+				s->next = head;
+				head = s;
+				if (tail == NULL) tail = s;
+			}
+			free_clause_list(c);
+			if (head != NULL) {
+				tail->next = w_head;
+				w_head = head;
+			}
+		}
+		sent->disjunct_stages[w] = w_head;
+	}
+}
+
+/**
+ * Gives each word a copy of those of its disjuncts, from the ones
+ * build_sentence_disjunct_stages() made, that cost no more than
+ * cost_cutoff.
+ */
+void stage_sentence_disjuncts(Sentence sent, int cost_cutoff)
+{
+	Staged_disjunct *s;
+	Disjunct *d, *tail;
+	int w;
+
+	for (w=0; w<sent->length; w++) {
+		sent->word[w].d = tail = NULL;
+		for (s = sent->disjunct_stages[w]; s != NULL; s = s->next) {
+			if (s->maxcost > cost_cutoff) continue;
+			d = copy_disjunct(s->d);
+			if (tail == NULL) sent->word[w].d = d;
+			else tail->next = d;
+			tail = d;
+		}
+	}
+}
+
+void free_sentence_disjunct_stages(Sentence sent)
+{
+	Staged_disjunct *s, *n;
+	int w;
+
+	if (sent->disjunct_stages == NULL) return;
+	for (w=0; w<sent->length; w++) {
+		for (s = sent->disjunct_stages[w]; s != NULL; s = n) {
+			n = s->next;
+			free_disjuncts(s->d);
+			xfree(s, sizeof(Staged_disjunct));
+		}
+	}
+	xfree(sent->disjunct_stages, sent->length * sizeof(Staged_disjunct *));
+	sent->disjunct_stages = NULL;
+}
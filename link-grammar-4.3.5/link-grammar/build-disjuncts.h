@@ -11,5 +11,8 @@
 /*                                                                              */
 /********************************************************************************/
 void build_sentence_disjuncts(Sentence sent, int cost_cutoff);
+void build_sentence_disjunct_stages(Sentence sent, int cost_cutoff);
+void stage_sentence_disjuncts(Sentence sent, int cost_cutoff);
+void free_sentence_disjunct_stages(Sentence sent);
 X_node *   build_word_expressions(Sentence sent, const char *);
 Disjunct * build_disjuncts_for_dict_node(Dict_node *);
@@ -24,6 +24,9 @@ static struct
 	int null_block;
 	int islands_ok;
 	int short_length;
+	int split_length;
+	int cost_staged;
+	int unknown_word_disjuncts;
 	int batch_mode;
 	int panic_mode;
 	int allow_null;
@@ -56,6 +59,9 @@ static Switch default_switches[] =
 	{"null-block",   0, "Size of blocks with null cost 1",  &local.null_block},
 	{"islands-ok",   1, "Use of null-linked islands",	   &local.islands_ok},
 	{"short",		0, "Max length of short links",		&local.short_length},
+	{"split",		0, "Parse this long a segment at a time", &local.split_length},
+	{"staged",		1, "Try the cheapest disjuncts first",  &local.cost_staged},
+	{"unknown",		0, "Most disjuncts an unknown word starts with", &local.unknown_word_disjuncts},
 	{"batch",		1, "Batch mode",					   &local.batch_mode},
 	{"panic",		1, "Use of \"panic mode\"",			&local.panic_mode},
 	{"null",		 1, "Null links",					   &local.allow_null},
@@ -317,6 +323,9 @@ static void put_opts_in_local_vars(Parse_Options opts)
 	local.null_block = parse_options_get_null_block(opts);
 	local.islands_ok = parse_options_get_islands_ok(opts);
 	local.short_length = parse_options_get_short_length(opts);
+	local.split_length = parse_options_get_split_length(opts);
+	local.cost_staged = parse_options_get_cost_staged(opts);
+	local.unknown_word_disjuncts = parse_options_get_unknown_word_disjuncts(opts);
 	local.echo_on = parse_options_get_echo_on(opts);
 	local.batch_mode = parse_options_get_batch_mode(opts);
 	local.panic_mode = parse_options_get_panic_mode(opts);
@@ -342,6 +351,9 @@ static void put_local_vars_in_opts(Parse_Options opts)
 	parse_options_set_null_block(opts, local.null_block);
 	parse_options_set_islands_ok(opts, local.islands_ok);
 	parse_options_set_short_length(opts, local.short_length);
+	parse_options_set_split_length(opts, local.split_length);
+	parse_options_set_cost_staged(opts, local.cost_staged);
+	parse_options_set_unknown_word_disjuncts(opts, local.unknown_word_disjuncts);
 	parse_options_set_echo_on(opts, local.echo_on);
 	parse_options_set_batch_mode(opts, local.batch_mode);
 	parse_options_set_panic_mode(opts, local.panic_mode);
@@ -16,12 +16,10 @@
 #include <link-grammar/api.h>
 #include "constituents.h"
 
-#define MAXCONSTITUENTS 1024
 #define MAXSUBL 16
 #define OPEN_BRACKET '['
 #define CLOSE_BRACKET ']'
 
-typedef enum {OPEN_TOK, CLOSE_TOK, WORD_TOK} CType;
 typedef enum {NONE, STYPE, PTYPE, QTYPE, QDTYPE} WType;
 
 typedef struct
@@ -41,8 +39,8 @@ typedef struct
 	 2: it's an AUX, and print it */
 } constituent_t;
 
-/* XXX it seems like the old code worked fine with MAX_ELTS=10 */
-#define MAX_ELTS 100
+/* The elements of an andlist all come from different sublinkages */
+#define MAX_ELTS MAXSUBL
 typedef struct
 {
   int num;
@@ -53,20 +51,98 @@ typedef struct
 /*
  * Context used to store assorted intermediate data
  * when the constituent string is being generated.
+ * The arrays are sized for the linkage, and the
+ * constituents and andlists grow as they are added.
  */
-#define MAX_ANDS 1024
 typedef struct
 {
 	String_set * phrase_ss;
-	WType wordtype[MAX_SENTENCE];
-	int word_used[MAXSUBL][MAX_SENTENCE];
+	int num_words;
+	int num_subl;
+	WType * wordtype;          /* one per word */
+	int * word_used[MAXSUBL];  /* one per word, for each sublinkage */
 	int templist[MAX_ELTS];
-	constituent_t constituent[MAXCONSTITUENTS];
-	andlist_t andlist[MAX_ANDS];
+	constituent_t * constituent;
+	int constituent_size;
+	andlist_t * andlist;
+	int andlist_size;
 } con_context_t;
 
 /* ================================================================ */
 
+static con_context_t * con_context_create(Linkage linkage)
+{
+	con_context_t *ctxt;
+	int i;
+
+	ctxt = (con_context_t *) exalloc(sizeof(con_context_t));
+	ctxt->phrase_ss = NULL;
+	ctxt->num_words = linkage->num_words;
+	ctxt->num_subl = linkage->num_sublinkages;
+	if (ctxt->num_subl > MAXSUBL) ctxt->num_subl = MAXSUBL;
+
+	ctxt->wordtype = (WType *) exalloc(ctxt->num_words*sizeof(WType));
+	for (i=0; i<ctxt->num_subl; i++) {
+		ctxt->word_used[i] = (int *) exalloc(ctxt->num_words*sizeof(int));
+	}
+
+	/* Each sublinkage makes a few constituents for most of its words */
+	ctxt->constituent_size = 2*ctxt->num_words*ctxt->num_subl + 8;
+	ctxt->constituent = (constituent_t *)
+		exalloc(ctxt->constituent_size*sizeof(constituent_t));
+	memset(ctxt->constituent, 0, ctxt->constituent_size*sizeof(constituent_t));
+
+	ctxt->andlist_size = 16;
+	ctxt->andlist = (andlist_t *) exalloc(ctxt->andlist_size*sizeof(andlist_t));
+	return ctxt;
+}
+
+static void con_context_delete(con_context_t *ctxt)
+{
+	int i;
+
+	exfree(ctxt->andlist, ctxt->andlist_size*sizeof(andlist_t));
+	exfree(ctxt->constituent, ctxt->constituent_size*sizeof(constituent_t));
+	for (i=0; i<ctxt->num_subl; i++) {
+		exfree(ctxt->word_used[i], ctxt->num_words*sizeof(int));
+	}
+	exfree(ctxt->wordtype, ctxt->num_words*sizeof(WType));
+	exfree(ctxt, sizeof(con_context_t));
+}
+
+/** Makes room for constituent c; the new ones start out zeroed. */
+static void need_constituent(con_context_t *ctxt, int c)
+{
+	constituent_t * old;
+	int old_size;
+
+	if (c < ctxt->constituent_size) return;
+	old = ctxt->constituent;
+	old_size = ctxt->constituent_size;
+	while (ctxt->constituent_size <= c) ctxt->constituent_size *= 2;
+	ctxt->constituent = (constituent_t *)
+		exalloc(ctxt->constituent_size*sizeof(constituent_t));
+	memcpy(ctxt->constituent, old, old_size*sizeof(constituent_t));
+	memset(ctxt->constituent + old_size, 0,
+		   (ctxt->constituent_size - old_size)*sizeof(constituent_t));
+	exfree(old, old_size*sizeof(constituent_t));
+}
+
+/** Makes room for andlist n. */
+static void need_andlist(con_context_t *ctxt, int n)
+{
+	andlist_t * old;
+	int old_size;
+
+	if (n < ctxt->andlist_size) return;
+	old = ctxt->andlist;
+	old_size = ctxt->andlist_size;
+	while (ctxt->andlist_size <= n) ctxt->andlist_size *= 2;
+	ctxt->andlist = (andlist_t *) exalloc(ctxt->andlist_size*sizeof(andlist_t));
+	memcpy(ctxt->andlist, old, old_size*sizeof(andlist_t));
+	exfree(old, old_size*sizeof(andlist_t));
+}
+
 static inline int uppercompare(const char * s, const char * t)
 {
 	return (FALSE == utf8_upper_match(s,t));
@@ -216,6 +292,8 @@ static int gen_comp(con_context_t *ctxt, Linkage linkage, int numcon_total, int
 					if (!(strcmp(ctxt->constituent[c2].type, ctype2)==0))
 						continue;
 
+					need_constituent(ctxt, c);
+
 					/* if the new constituent (c) is to the left
 					   of c1, its right edge should be adjacent to the
 					   left edge of c1 - or as close as possible
@@ -272,7 +350,6 @@ static int gen_comp(con_context_t *ctxt, Linkage linkage, int numcon_total, int
 						print_constituent(ctxt, linkage, c);
 					}
 					c++;
-					assert(c < MAXCONSTITUENTS, "Too many constituents");
 					done = 1;
 				}
 			}
@@ -412,12 +489,12 @@ static int find_next_element(con_context_t *ctxt,
 	}
 	if (addedone == 0 && num_elements > 1)
 	{
+		need_andlist(ctxt, num_lists);
 		for (a=0; a<num_elements; a++) {
 			ctxt->andlist[num_lists].e[a] = ctxt->templist[a];
 			ctxt->andlist[num_lists].num = num_elements;
 		}
 		num_lists++;
-		assert(num_lists < MAX_ANDS, "Constituent overflowed andlist!\n");
 	}
 	return num_lists;
 }
@@ -647,7 +724,7 @@ static int merge_constituents(con_context_t *ctxt, Linkage linkage, int numcon_t
 	c1 = numcon_total;
 	for (n=0; n<num_lists; n++) {
 		if (ctxt->andlist[n].valid == 0) continue;
-		leftend=256;
+		leftend=linkage->num_words;
 		rightend=-1;
 		for (a=0; a < ctxt->andlist[n].num; a++) {
 			c2 = ctxt->andlist[n].e[a];
@@ -659,6 +736,7 @@ static int merge_constituents(con_context_t *ctxt, Linkage linkage, int numcon_t
 			}
 		}
 
+		need_constituent(ctxt, c1);
 		ctxt->constituent[c1].left=leftend;
 		ctxt->constituent[c1].right=rightend;
 		ctxt->constituent[c1].type = ctxt->constituent[c2].type;
@@ -666,6 +744,7 @@ static int merge_constituents(con_context_t *ctxt, Linkage linkage, int numcon_t
 		ctxt->constituent[c1].valid=1;
 		ctxt->constituent[c1].start_link = ctxt->constituent[c2].start_link;  /* bogus */
 		ctxt->constituent[c1].start_num = ctxt->constituent[c2].start_num;	/* bogus */
+		ctxt->constituent[c1].aux = 0;
 
 		/* If a constituent within the andlist is an aux (aux==1),
 		   set aux for the whole-list constituent to 2, also set
@@ -864,11 +943,13 @@ static int last_minute_fixes(con_context_t *ctxt, Linkage linkage, int numcon_to
 	if ((global_leftend_found==0) || (global_rightend_found==0))
 	{
 		c = numcon_total;
+		need_constituent(ctxt, c);
 		ctxt->constituent[c].left = 1;
 		ctxt->constituent[c].right = linkage->num_words-1;
 		ctxt->constituent[c].type = string_set_add("S", ctxt->phrase_ss);
 		ctxt->constituent[c].valid = 1;
 		ctxt->constituent[c].domain_type = 'x';
+		ctxt->constituent[c].aux = 0;
 		numcon_total++;
 		if (verbosity >= 2)
 			printf("Adding global sentence constituent:\n");
@@ -910,7 +991,7 @@ static void count_words_used(con_context_t *ctxt, Linkage linkage)
 {
 	int i, w, link, num_subl;
 
-	num_subl = linkage->num_sublinkages;
+	num_subl = ctxt->num_subl;
 	if(linkage->unionized==1 && num_subl>1) num_subl--;
 
 	if (verbosity>=2)
@@ -939,6 +1020,7 @@ static int add_constituent(con_context_t *ctxt, int c, Linkage linkage, Domain d
                            int l, int r, const char * name)
 {
 	c++;
+	need_constituent(ctxt, c);
 
 	/* Avoid running off end, to walls. */
 	if (l < 1) l=1;
@@ -1005,8 +1087,7 @@ static const char * cons_of_domain(char domain_type)
 static int read_constituents_from_domains(con_context_t *ctxt, Linkage linkage,
                                           int numcon_total, int s)
 {
-	int d, c, leftlimit, l, leftmost, rightmost, w, c2, numcon_subl=0, w2;
-	List_o_links * dlink;
+	int d, c, leftlimit, l, leftmost, rightmost, w, c2, numcon_subl=0, w2, i;
 	int rootright, rootleft, adjustment_made;
 	Sublinkage * subl;
 	const char * name;
@@ -1043,8 +1124,8 @@ static int read_constituents_from_domains(con_context_t *ctxt, Linkage linkage,
 		   in the constituent. This will also handle the case
 		   where the domain contains no links. */
 
-		for (dlink = domain.lol; dlink!=NULL; dlink=dlink->next) {
-			l=dlink->link;
+		for (i=domain.first; i<domain.first+domain.size; i++) {
+			l=subl->pp_data.domain_links[i];
 
 			if ((linkage_get_link_lword(linkage, l) < leftmost) &&
 				(linkage_get_link_lword(linkage, l) >= leftlimit))
@@ -1271,18 +1352,57 @@ static int read_constituents_from_domains(con_context_t *ctxt, Linkage linkage,
 	return numcon_subl;
 }
 
-static char * exprint_constituent_structure(con_context_t *ctxt, Linkage linkage, int numcon_total)
+static CNode * make_CNode(const char *q) {
+	CNode * cn;
+	cn = exalloc(sizeof(CNode));
+	cn->label = (char *) exalloc(sizeof(char)*(strlen(q)+1));
+	strcpy(cn->label, q);
+	cn->child = cn->next = (CNode *) NULL;
+	cn->next = (CNode *) NULL;
+	cn->start = cn->end = -1;
+	return cn;
+}
+
+/** Makes m the last child of n. */
+static void add_child(CNode * n, CNode * m)
+{
+	CNode * x;
+
+	if (n->child == NULL) {
+		n->child = m;
+		return;
+	}
+	for (x=n->child; x->next!=NULL; x=x->next)
+		;
+	x->next = m;
+}
+
+/**
+ * Walks the words left to right, opening and closing the constituents
+ * that start and end at each one.  This gives both the flat, bracketed
+ * string and the tree, which are left on the linkage.  The tree is the
+ * first constituent to open, with everything inside it.
+ */
+static void exprint_constituent_structure(con_context_t *ctxt, Linkage linkage, int numcon_total)
 {
 	int c, w;
-	int leftdone[MAXCONSTITUENTS];
-	int rightdone[MAXCONSTITUENTS];
+	int * leftdone;
+	int * rightdone;
 	int best, bestright, bestleft;
+	int depth, done;
+	CNode ** stack;
+	CNode * root, * n;
 	Sentence sent;
-	char s[100], * p;
+	char s[100];
 	String * cs = String_create();
 
-	assert (numcon_total < MAXCONSTITUENTS, "Too many constituents");
 	sent = linkage_get_sentence(linkage);
+	leftdone = (int *) exalloc((numcon_total+1)*sizeof(int));
+	rightdone = (int *) exalloc((numcon_total+1)*sizeof(int));
+	stack = (CNode **) exalloc((numcon_total+1)*sizeof(CNode *));
+	root = NULL;
+	depth = 0;
+	done = FALSE;
 
 	for(c=0; c<numcon_total; c++) {
 		leftdone[c]=0;
@@ -1312,6 +1432,11 @@ static char * exprint_constituent_structure(con_context_t *ctxt, Linkage linkage
 			leftdone[best]=1;
 			if(ctxt->constituent[best].aux==1) continue;
 			append_string(cs, "%c%s ", OPEN_BRACKET, ctxt->constituent[best].type);
+			if (done) continue;
+			n = make_CNode(ctxt->constituent[best].type);
+			if (depth == 0) root = n;
+			else add_child(stack[depth-1], n);
+			stack[depth++] = n;
 		}
 
 		if (w<linkage->num_words-1) {
@@ -1323,6 +1448,7 @@ static char * exprint_constituent_structure(con_context_t *ctxt, Linkage linkage
 			if (sent->word[w].firstupper ==1 )
 				upcase_utf8_str(s, s, MAX_WORD);
 			append_string(cs, "%s ", s);
+			if (!done && depth > 0) add_child(stack[depth-1], make_CNode(s));
 		}
 
 		while(1) {
@@ -1342,29 +1468,44 @@ static char * exprint_constituent_structure(con_context_t *ctxt, Linkage linkage
 			if (ctxt->constituent[best].aux==1)
 				continue;
 			append_string(cs, "%s%c ", ctxt->constituent[best].type, CLOSE_BRACKET);
+			if (!done && depth > 0 && --depth == 0) done = TRUE;
 		}
 	}
 
+	exfree(leftdone, (numcon_total+1)*sizeof(int));
+	exfree(rightdone, (numcon_total+1)*sizeof(int));
+	exfree(stack, (numcon_total+1)*sizeof(CNode *));
+
 	append_string(cs, "\n");
-	p = exalloc(strlen(cs->p)+1);
-	strcpy(p, cs->p);
+	linkage->constituent_string = exalloc(strlen(cs->p)+1);
+	strcpy(linkage->constituent_string, cs->p);
 	exfree(cs->p, sizeof(char)*cs->allocated);
 	exfree(cs, sizeof(String));
-	return p;
+	linkage->constituent_tree = root;
 }
 
-static char * print_flat_constituents(con_context_t *ctxt, Linkage linkage)
+static int assign_spans(CNode * n, int start);
+
+/**
+ * Works out the constituents of the linkage, and leaves the tree and
+ * the flat string on it, unless they are there already.
+ */
+static void build_constituents(Linkage linkage)
 {
 	int num_words;
 	Sentence sent;
 	Postprocessor * pp;
-	int s, numcon_total, numcon_subl, num_subl;
-	char * q;
+	int s, numcon_total, numcon_subl, num_subl, current;
+	con_context_t *ctxt;
+
+	if (linkage->constituent_string != NULL) return;
 
 	sent = linkage_get_sentence(linkage);
+	ctxt = con_context_create(linkage);
 	ctxt->phrase_ss = string_set_create();
-	pp = linkage->sent->dict->constituent_pp;
+	pp = linkage->dict->constituent_pp;
 	numcon_total = 0;
+	current = linkage->current;
 
 	count_words_used(ctxt, linkage);
 
@@ -1382,70 +1523,20 @@ static char * print_flat_constituents(con_context_t *ctxt, Linkage linkage)
 		numcon_subl = read_constituents_from_domains(ctxt, linkage, numcon_total, s);
 		numcon_total = numcon_total + numcon_subl;
 	}
+	for (s=0; s<linkage->num_sublinkages; s++) {
+		post_process_free_domains(&linkage->sublinkage[s].pp_data);
+	}
 	numcon_total = merge_constituents(ctxt, linkage, numcon_total);
 	numcon_total = last_minute_fixes(ctxt, linkage, numcon_total);
-	q = exprint_constituent_structure(ctxt, linkage, numcon_total);
+	exprint_constituent_structure(ctxt, linkage, numcon_total);
+	assign_spans(linkage->constituent_tree, 0);
 	string_set_delete(ctxt->phrase_ss);
 	ctxt->phrase_ss = NULL;
-	return q;
+	con_context_delete(ctxt);
+	linkage->current = current;
 }
 
-static CType token_type (char *token)
-{
-	if ((token[0] == OPEN_BRACKET) && (strlen(token)>1))
-		return OPEN_TOK;
-	if ((strlen(token)>1) && (token[strlen(token)-1] == CLOSE_BRACKET))
-		return CLOSE_TOK;
-	return WORD_TOK;
-}
-
-static CNode * make_CNode(char *q) {
-	CNode * cn;
-	cn = exalloc(sizeof(CNode));
-	cn->label = (char *) exalloc(sizeof(char)*(strlen(q)+1));
-	strcpy(cn->label, q);
-	cn->child = cn->next = (CNode *) NULL;
-	cn->next = (CNode *) NULL;
-	cn->start = cn->end = -1;
-	return cn;
-}
-
-static CNode * parse_string(CNode * n, char **saveptr)
-{
-	char *q;
-	CNode *m, *last_child=NULL;
-
-	while ((q = strtok_r(NULL, " ", saveptr))) {
-		switch (token_type(q)) {
-		case CLOSE_TOK :
-			q[strlen(q)-1]='\0';
-			assert(strcmp(q, n->label)==0,
-				   "Constituent tree: Labels do not match.");
-			return n;
-			break;
-		case OPEN_TOK:
-			m = make_CNode(q+1);
-			m = parse_string(m, saveptr);
-			break;
-		case WORD_TOK:
-			m = make_CNode(q);
-			break;
-		default:
-			assert(0, "Constituent tree: Illegal token type");
-		}
-		if (n->child == NULL) {
-			last_child = n->child = m;
-		}
-		else {
-			last_child->next = m;
-			last_child = m;
-		}
-	}
-	assert(0, "Constituent tree: Constituent did not close");
-	return NULL;
-}
-
-static void print_tree(String * cs, int indent, CNode * n, int o1, int o2)
+static void print_tree(String * cs, int indent, const CNode * n, int o1, int o2)
 {
 	int i, child_offset;
 	CNode * m;
@@ -1504,30 +1595,57 @@ static int assign_spans(CNode * n, int start) {
 	return num_words;
 }
 
-CNode * linkage_constituent_tree(Linkage linkage)
+static CNode * copy_constituent_tree(const CNode * n)
 {
-	char *p, *q, *saveptr;
-	int len;
-	CNode * root;
-	con_context_t *ctxt;
+	CNode * m;
 
-	ctxt = (con_context_t *) malloc(sizeof(con_context_t));
-	p = print_flat_constituents(ctxt, linkage);
-	free(ctxt);
-
-	len = strlen(p);
-	q = strtok_r(p, " ", &saveptr);
-	assert(token_type(q) == OPEN_TOK, "Illegal beginning of string");
-	root = make_CNode(q+1);
-	root = parse_string(root, &saveptr);
-	assign_spans(root, 0);
-	exfree(p, sizeof(char)*(len+1));
-	return root;
+	if (n == NULL) return NULL;
+	m = make_CNode(n->label);
+	m->start = n->start;
+	m->end = n->end;
+	m->child = copy_constituent_tree(n->child);
+	m->next = copy_constituent_tree(n->next);
+	return m;
+}
+
+static int constituent_tree_memory_in_use(const CNode * n)
+{
+	int space = 0;
+
+	for ( ; n != NULL; n = n->next) {
+		space += sizeof(CNode) + strlen(n->label) + 1;
+		space += constituent_tree_memory_in_use(n->child);
+	}
+	return space;
+}
+
+/**
+ * Returns the constituent tree of the linkage.  It is worked out the
+ * first time it is asked for, along with the flat string that
+ * linkage_print_constituent_tree() gives in mode 2, and both are kept
+ * until the linkage is deleted.  The tree belongs to the linkage.
+ */
+const CNode * linkage_get_constituent_tree(Linkage linkage)
+{
+	if ((linkage->sent == NULL) || (linkage->dict->constituent_pp == NULL))
+		return NULL;
+	build_constituents(linkage);
+	return linkage->constituent_tree;
+}
+
+/**
+ * Returns a copy of the constituent tree of the linkage, which the
+ * caller frees with linkage_free_constituent_tree().
+ */
+CNode * linkage_constituent_tree(Linkage linkage)
+{
+	return copy_constituent_tree(linkage_get_constituent_tree(linkage));
 }
 
 void linkage_free_constituent_tree(CNode * n)
 {
 	CNode *m, *x;
+	if (n == NULL) return;
 	for (m=n->child; m!=NULL; m=x) {
 		x=m->next;
 		linkage_free_constituent_tree(m);
@@ -1536,6 +1654,33 @@ void linkage_free_constituent_tree(CNode * n)
 	exfree(n, sizeof(CNode));
 }
 
+/** Frees the constituent tree and string kept on the linkage, if any. */
+void linkage_free_constituents(Linkage linkage)
+{
+	CNode *m, *x;
+
+	for (m=linkage->constituent_tree; m!=NULL; m=x) {
+		x=m->next;
+		linkage_free_constituent_tree(m);
+	}
+	linkage->constituent_tree = NULL;
+	if (linkage->constituent_string != NULL) {
+		exfree(linkage->constituent_string, strlen(linkage->constituent_string)+1);
+		linkage->constituent_string = NULL;
+	}
+}
+
+/** Returns the space taken by the constituents kept on the linkage. */
+int linkage_constituents_memory_in_use(Linkage linkage)
+{
+	int space;
+
+	space = constituent_tree_memory_in_use(linkage->constituent_tree);
+	if (linkage->constituent_string != NULL)
+		space += strlen(linkage->constituent_string) + 1;
+	return space;
+}
+
 /**
  * Print out the constituent tree.
  * mode 1: treebank-style constituent tree
@@ -1545,19 +1690,16 @@ void linkage_free_constituent_tree(CNode * n)
 char * linkage_print_constituent_tree(Linkage linkage, int mode)
 {
 	String * cs;
-	CNode * root;
 	char * p;
 
-	if ((mode == 0) || (linkage->sent->dict->constituent_pp == NULL))
+	if ((mode == 0) || (linkage->sent == NULL) || (linkage->dict->constituent_pp == NULL))
 	{
 		return NULL;
 	}
 	else if (mode == 1 || mode == 3)
 	{
 		cs = String_create();
-		root = linkage_constituent_tree(linkage);
-		print_tree(cs, (mode==1), root, 0, 0);
-		linkage_free_constituent_tree(root);
+		print_tree(cs, (mode==1), linkage_get_constituent_tree(linkage), 0, 0);
 		append_string(cs, "\n");
 		p = exalloc(strlen(cs->p)+1);
 		strcpy(p, cs->p);
@@ -1567,14 +1709,10 @@ char * linkage_print_constituent_tree(Linkage linkage, int mode)
 	}
 	else if (mode == 2)
 	{
-		char * str;
-		con_context_t *ctxt;
-
-		ctxt = (con_context_t *) malloc(sizeof(con_context_t));
-		str = print_flat_constituents(ctxt, linkage);
-		free(ctxt);
-
-		return str;
+		build_constituents(linkage);
+		p = exalloc(strlen(linkage->constituent_string)+1);
+		strcpy(p, linkage->constituent_string);
+		return p;
 	}
 	assert(0, "Illegal mode in linkage_print_constituent_tree");
 	return NULL;
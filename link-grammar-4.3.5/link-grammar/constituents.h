@@ -23,4 +23,7 @@ struct CNode_s {
   int   start, end;
 };
 
+void linkage_free_constituents(Linkage linkage);
+int  linkage_constituents_memory_in_use(Linkage linkage);
+
 #endif
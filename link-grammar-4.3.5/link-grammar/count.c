@@ -16,7 +16,7 @@
 /* This file contains the exhaustive search algorithm. */
 
 static char ** deletable;
-static char ** effective_dist; 
+static short ** effective_dist; 
 static Word *  local_sent;
 static int	 null_block, islands_ok, null_links;
 static Resources current_resources;
@@ -210,8 +210,11 @@ static Table_connector * find_table_pointer(int lw, int rw,
 
 	/* Create a new connector only if resources are exhausted.
 	 * (???) Huh? I guess we're in panic parse mode in that case.
+	 * Every call of count() that isn't answered by the table comes
+	 * through here, so this is where count() watches the clock; the
+	 * check is amortized, since it's made so often.
 	 */
-	if ((current_resources != NULL) && resources_exhausted(current_resources)) {
+	if ((current_resources != NULL) && resources_check(current_resources)) {
 		return table_store(lw, rw, le, re, cost, 0);
 	}
 	else return NULL;
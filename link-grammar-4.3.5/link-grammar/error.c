@@ -38,7 +38,7 @@ static const char * msg_of_lperror(int lperr)
 	case NOTINDICT:
 		return "Sentence not in dictionary ";
 	case CHARSET:
-		return "Unable to process input string in current locale ";
+		return "Input string is not valid UTF-8 ";
 	case BUILDEXPR:
 		return "Could not build sentence expressions ";
 	case INTERNALERROR:
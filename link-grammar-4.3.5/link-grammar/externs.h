@@ -16,6 +16,7 @@ extern int space_in_use;              /* space used but not yet freed during par
 extern int max_space_in_use;          /* maximum of the above for this parse */
 extern int external_space_in_use;     /* space used by "user" */
 extern int max_external_space_in_use; /* maximum of the above */
+extern Resources charged_resources;   /* the parse xalloc() charges, if any */
 
 #define RTSIZE 256
 /* size of random table for computing the
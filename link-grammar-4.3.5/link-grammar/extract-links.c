@@ -25,6 +25,7 @@
 
 static Word * local_sent;
 static int	islands_ok;
+static Resources current_resources;
 
 static Parse_set * dummy_set(void) {
 	static Parse_set ds;
@@ -109,6 +110,13 @@ void init_x_table(Sentence sent) {
 
 	pi = sent->parse_info = (Parse_info) xalloc(sizeof(struct Parse_info_struct));
 	pi->N_words = sent->length;
+	pi->chosen_disjuncts = (Disjunct **) xalloc(pi->N_words * sizeof(Disjunct *));
+	pi->has_fat_down = (char *) xalloc(pi->N_words * sizeof(char));
+	pi->link_array = (struct Link_s *) xalloc(MAX_LINKS(pi->N_words) * sizeof(struct Link_s));
+	pi->N_links = 0;
+	for (i=0; i<pi->N_words; i++) {
+		pi->chosen_disjuncts[i] = NULL;
+	}
 
 	if (pi->N_words >= 10) {
 		x_table_size = (1<<14);
@@ -220,6 +228,10 @@ static Parse_set * parse_set(Disjunct *ld, Disjunct *rd, int lw, int rw,
 
 	assert(cost >= 0, "parse_set() called with cost < 0.");
 
+	/* Once the resources run out the set is left unfinished;
+	   post_process_linkages() takes no linkages from it. */
+	if (resources_check(current_resources)) return NULL;
+
 	count = table_lookup(lw, rw, le, re, cost);
 
 	/*
@@ -417,6 +429,7 @@ int build_parse_set(Sentence sent, int cost, Parse_Options opts)
 
 	local_sent = sent->word;
 	islands_ok = opts->islands_ok;
+	current_resources = opts->resources;
 
 	whole_set =
 		parse_set(NULL, NULL, -1, sent->length, NULL, NULL, cost+1, sent->parse_info);
@@ -428,15 +441,23 @@ int build_parse_set(Sentence sent, int cost, Parse_Options opts)
 	sent->parse_info->parse_set = whole_set;
 
 	local_sent = NULL;
+	current_resources = NULL;
 	return verify_set(sent->parse_info);
 }
 
+static void free_parse_info_arrays(Parse_info pi) {
+	xfree(pi->chosen_disjuncts, pi->N_words * sizeof(Disjunct *));
+	xfree(pi->has_fat_down, pi->N_words * sizeof(char));
+	xfree(pi->link_array, MAX_LINKS(pi->N_words) * sizeof(struct Link_s));
+}
+
 void free_parse_set(Sentence sent) {
 	/* This uses the x_table to free the whole parse set (the set itself
 	   cannot be used cause it's a dag).  called from the outside world */
 	if (sent->parse_info != NULL) {
 		free_x_table(sent->parse_info);
 		sent->parse_info->parse_set = NULL;
+		free_parse_info_arrays(sent->parse_info);
 		xfree((void *) sent->parse_info, sizeof(struct Parse_info_struct));
 		sent->parse_info = NULL;
 	}
@@ -451,7 +472,7 @@ static void initialize_links(Parse_info pi) {
 }
 
 static void issue_link(Parse_info pi, Disjunct * ld, Disjunct * rd, struct Link_s link) {
-	assert(pi->N_links <= MAX_LINKS-1, "Too many links");
+	assert(pi->N_links < MAX_LINKS(pi->N_words), "Too many links");
 	pi->link_array[pi->N_links] = link;
 	pi->N_links++;
 
@@ -32,12 +32,13 @@ static int right_disjunct_list_length(Disjunct * d) {
 
 static int match_cost;
 
-static int l_table_size[MAX_SENTENCE];  /* the sizes of the hash tables */
-static int r_table_size[MAX_SENTENCE];
+/* These have one entry for each word of the sentence */
+static int *l_table_size;  /* the sizes of the hash tables */
+static int *r_table_size;
 
-static Match_node ** l_table[MAX_SENTENCE]; 
+static Match_node *** l_table; 
                  /* the beginnings of the hash tables */
-static Match_node ** r_table[MAX_SENTENCE];
+static Match_node *** r_table;
 
 static Match_node * mn_free_list = NULL;
    /* I'll pedantically maintain my own list of these cells */
@@ -87,6 +88,10 @@ void free_fast_matcher(Sentence sent) {
 	}
 	xfree((char *)r_table[w], r_table_size[w] * sizeof (Match_node *));
     }
+    xfree(l_table_size, sent->length * sizeof(int));
+    xfree(r_table_size, sent->length * sizeof(int));
+    xfree(l_table, sent->length * sizeof(Match_node **));
+    xfree(r_table, sent->length * sizeof(Match_node **));
     free_match_list(mn_free_list);
     mn_free_list = NULL;
 }
@@ -163,6 +168,10 @@ void init_fast_matcher(Sentence sent) {
     Match_node ** t;
     Disjunct * d;
     match_cost = 0;
+    l_table_size = (int *) xalloc(sent->length * sizeof(int));
+    r_table_size = (int *) xalloc(sent->length * sizeof(int));
+    l_table = (Match_node ***) xalloc(sent->length * sizeof(Match_node **));
+    r_table = (Match_node ***) xalloc(sent->length * sizeof(Match_node **));
     for (w=0; w<sent->length; w++) {
 	len = left_disjunct_list_length(sent->word[w].d);
 	size = next_power_of_two_up(len);
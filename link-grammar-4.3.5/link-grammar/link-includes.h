@@ -36,6 +36,40 @@ link_public_api(int)
      dictionary_delete(Dictionary dict);
 link_public_api(int)
      dictionary_get_max_cost(Dictionary dict);
+link_public_api(long)
+     dictionary_get_unknown_word_limits(Dictionary dict);
+link_public_api(long)
+     dictionary_get_unknown_word_fallbacks(Dictionary dict);
+link_public_api(void)
+     dictionary_set_parse_cache_size(Dictionary dict, long max_bytes);
+link_public_api(long)
+     dictionary_get_parse_cache_size(Dictionary dict);
+link_public_api(long)
+     dictionary_get_parse_cache_bytes(Dictionary dict);
+link_public_api(long)
+     dictionary_get_parse_cache_entries(Dictionary dict);
+link_public_api(long)
+     dictionary_get_parse_cache_hits(Dictionary dict);
+link_public_api(long)
+     dictionary_get_parse_cache_misses(Dictionary dict);
+link_public_api(long)
+     dictionary_get_parse_cache_evictions(Dictionary dict);
+link_public_api(void)
+     dictionary_set_word_cache_size(Dictionary dict, int max_entries);
+link_public_api(int)
+     dictionary_get_word_cache_size(Dictionary dict);
+link_public_api(long)
+     dictionary_get_word_cache_hits(Dictionary dict);
+link_public_api(long)
+     dictionary_get_word_cache_misses(Dictionary dict);
+link_public_api(int)
+     dictionary_open_parse_store(Dictionary dict, const char * path);
+link_public_api(void)
+     dictionary_close_parse_store(Dictionary dict);
+link_public_api(long)
+     dictionary_get_parse_store_hits(Dictionary dict);
+link_public_api(long)
+     dictionary_get_parse_store_records(Dictionary dict);
 
 /*****************************************************************************
 *
@@ -49,6 +83,10 @@ link_public_api(Parse_Options)
      parse_options_create(void);
 link_public_api(int)
      parse_options_delete(Parse_Options opts);
+link_public_api(Parse_Options)
+     parse_options_copy(Parse_Options opts);
+link_public_api(void)
+     parse_options_copy_into(Parse_Options to, Parse_Options from);
 link_public_api(void)
      parse_options_set_verbosity(Parse_Options opts, int verbosity);
 link_public_api(int)
@@ -57,6 +95,22 @@ link_public_api(void)
      parse_options_set_linkage_limit(Parse_Options opts, int linkage_limit);
 link_public_api(int)
      parse_options_get_linkage_limit(Parse_Options opts);
+link_public_api(void)
+     parse_options_set_compact_after(Parse_Options opts, int linkages);
+link_public_api(int)
+     parse_options_get_compact_after(Parse_Options opts);
+link_public_api(void)
+     parse_options_set_split_length(Parse_Options opts, int words);
+link_public_api(int)
+     parse_options_get_split_length(Parse_Options opts);
+link_public_api(void)
+     parse_options_set_cost_staged(Parse_Options opts, int val);
+link_public_api(int)
+     parse_options_get_cost_staged(Parse_Options opts);
+link_public_api(void)
+     parse_options_set_unknown_word_disjuncts(Parse_Options opts, int disjuncts);
+link_public_api(int)
+     parse_options_get_unknown_word_disjuncts(Parse_Options opts);
 link_public_api(void)
      parse_options_set_disjunct_cost(Parse_Options opts, int disjunct_cost);
 link_public_api(int)
@@ -93,6 +147,14 @@ link_public_api(void)
      parse_options_set_max_parse_time(Parse_Options  opts, int secs);
 link_public_api(int)
      parse_options_get_max_parse_time(Parse_Options opts);
+link_public_api(void)
+     parse_options_set_max_parse_msecs(Parse_Options  opts, int msecs);
+link_public_api(int)
+     parse_options_get_max_parse_msecs(Parse_Options opts);
+link_public_api(void)
+     parse_options_set_max_wall_msecs(Parse_Options  opts, int msecs);
+link_public_api(int)
+     parse_options_get_max_wall_msecs(Parse_Options opts);
 link_public_api(void)
      parse_options_set_cost_model_type(Parse_Options opts, int cm);
 link_public_api(int)
@@ -178,10 +240,16 @@ typedef struct Sentence_s * Sentence;
 
 link_public_api(Sentence)
      sentence_create(char *input_string, Dictionary dict);
+link_public_api(Sentence)
+     sentence_create_from_tokens(const char **tokens, int num_tokens, Dictionary dict);
 link_public_api(void)
      sentence_delete(Sentence sent);
+link_public_api(void)
+     sentence_compact(Sentence sent);
 link_public_api(int)
      sentence_parse(Sentence sent, Parse_Options opts);
+link_public_api(int)
+     sentence_parse_racing(Sentence sent, Parse_Options opts, Parse_Options panic_opts);
 link_public_api(int)
      sentence_length(Sentence sent);
 link_public_api(char *)
@@ -192,6 +260,10 @@ link_public_api(int)
      sentence_num_linkages_found(Sentence sent);
 link_public_api(int)
      sentence_num_valid_linkages(Sentence sent);
+link_public_api(int)
+     sentence_peak_memory(Sentence sent);
+link_public_api(int)
+     sentence_memory_in_use(Sentence sent);
 link_public_api(int)
      sentence_num_linkages_post_processed(Sentence sent);
 link_public_api(int)
@@ -208,6 +280,27 @@ link_public_api(char *)
 link_public_api(int)
      sentence_nth_word_has_disjunction(Sentence sent, int i);
 
+/*****************************************************************************
+*
+* Functions that read Sentences from a file descriptor
+*
+*****************************************************************************/
+
+typedef struct Sentence_stream_s * Sentence_stream;
+
+link_public_api(Sentence_stream)
+     sentence_stream_create(int fd, int max_pending);
+link_public_api(char *)
+     sentence_stream_next(Sentence_stream ss);
+link_public_api(int)
+     sentence_stream_ready(Sentence_stream ss);
+link_public_api(int)
+     sentence_stream_wait_fd(Sentence_stream ss);
+link_public_api(int)
+     sentence_stream_error(Sentence_stream ss);
+link_public_api(void)
+     sentence_stream_delete(Sentence_stream ss);
+
 /*****************************************************************************
 *
 * Functions that create and manipulate Linkages.
@@ -222,12 +315,20 @@ typedef struct Linkage_s * Linkage;
 
 link_public_api(Linkage)
      linkage_create(int index, Sentence sent, Parse_Options opts);
+link_public_api(char *)
+     linkage_pack(Linkage linkage, int *size);
+link_public_api(void)
+     linkage_pack_delete(char *packed);
+link_public_api(Linkage)
+     linkage_unpack(const char *packed, int size, Dictionary dict, Parse_Options opts);
 link_public_api(int)
      linkage_get_current_sublinkage(Linkage linkage);
 link_public_api(int)
      linkage_set_current_sublinkage(Linkage linkage, int index);
 link_public_api(void)
      linkage_delete(Linkage linkage);
+link_public_api(int)
+     linkage_memory_in_use(Linkage linkage);
 link_public_api(Sentence)
      linkage_get_sentence(Linkage linkage);
 link_public_api(int)
@@ -318,6 +419,8 @@ typedef struct CNode_s CNode;
 
 link_public_api(CNode *) 
      linkage_constituent_tree(Linkage linkage);
+link_public_api(const CNode *)
+     linkage_get_constituent_tree(Linkage linkage);
 link_public_api(void)
      linkage_free_constituent_tree(CNode * n);
 link_public_api(char *)
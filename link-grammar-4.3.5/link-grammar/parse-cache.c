@@ -0,0 +1,1290 @@
+/********************************************************************************/
+/* Copyright (c) 2004                                                           */
+/* Daniel Sleator, David Temperley, and John Lafferty                           */
+/* All rights reserved                                                          */
+/*                                                                              */
+/* Use of the link grammar parsing system is subject to the terms of the        */
+/* license set forth in the LICENSE file included with this software,           */
+/* and also available at http://www.link.cs.cmu.edu/link/license.html           */
+/* This license allows free redistribution and use in source and binary         */
+/* forms, with or without modification, subject to certain conditions.          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <link-grammar/api.h>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+/* A parse cache remembers the outcome of sentence_parse() for recently
+   seen sentences, so that a repeated sentence skips pruning, counting
+   and post-processing altogether.
+
+   The key is the option values that change what the parser produces,
+   followed by the tokenized words separated by blanks.  Keying on the
+   tokens rather than the raw input means that sentences which differ
+   only in spacing share an entry.
+
+   An entry holds the sentence-level counts, the cost information of
+   every post-processed linkage, and a compact image of each linkage
+   that has been asked for.  Images are added the first time
+   linkage_create() builds that linkage the long way; after that the
+   entry never changes.  A sentence restored from the cache has no
+   parse set, so asking it for a linkage with no image yet makes
+   linkage_create() parse it for real.  That parse is deterministic,
+   so it produces the same linkages in the same order.
+
+   Entries are kept on a list in order of use and the least recently
+   used ones are dropped whenever the bytes held exceed the limit.
+   Sentences hold a reference to the entry they were restored from
+   (or inserted), so an entry that is dropped while in use is only
+   unlinked from the cache and is freed by the last parse_cache_release().
+
+   Entries can also be written to and read back from a parse store
+   (see parse-store.c), which keeps them across processes.
+
+   One lock serializes every cache in the process; nothing expensive
+   is done while it is held. */
+
+#define PC_LINKAGE_LIMIT   0
+#define PC_DISJUNCT_COST   1
+#define PC_MIN_NULL_COUNT  2
+#define PC_MAX_NULL_COUNT  3
+#define PC_NULL_BLOCK      4
+#define PC_ISLANDS_OK      5
+#define PC_SHORT_LENGTH    6
+#define PC_ALL_SHORT       7
+#define PC_TWOPASS_LENGTH  8
+#define PC_COST_MODEL      9
+#define PC_UNKNOWN_WORDS  10
+#define PC_N_OPTIONS      11
+
+#define PC_INITIAL_TABLE_SIZE 64
+
+typedef struct {
+	int    index;
+	char   fat;
+	char   canonical;
+	char   improper_fat_linkage;
+	char   inconsistent_domains;
+	short  N_violations, null_cost, unused_word_cost, disjunct_cost, and_cost;
+	int    link_cost;
+} Cached_info;
+
+/* A linkage image is one block: the Cached_linkage header, then the
+   word and sublinkage arrays, the links, and finally all of the
+   strings.  Everything inside it is found by its offset from the start
+   of the block, so an image can be written to a file and read back, or
+   used straight out of a mapped file. */
+
+typedef struct {
+	short          label;
+	unsigned short word;
+	unsigned short length_limit;
+	char           priority;
+	char           multi;
+	int            string;
+} Cached_connector;
+
+typedef struct {
+	int              l, r;
+	int              name;
+	Cached_connector lc, rc;
+	int              num_domains;
+	int              domains;    /* one letter per domain */
+} Cached_link;
+
+typedef struct {
+	int num_links;
+	int link;
+	int has_pp_info;
+	int violation;               /* -1 if there is none */
+} Cached_sublinkage;
+
+typedef struct {
+	int size;
+	int num_words;
+	int num_sublinkages;
+	int word;                    /* num_words offsets of the spellings */
+	int sublinkage;
+} Cached_linkage;
+
+#define IMAGE_AT(img, offset) ((char *)(img) + (offset))
+
+struct Parse_cache_entry_s {
+	Parse_cache_entry * next;          /* hash chain */
+	Parse_cache_entry * older, * newer;
+	Parse_cache *       cache;         /* NULL once evicted */
+	unsigned int        hash;
+	int                 key_len;
+	char *              key;
+	int                 refcount;
+	int                 saved;         /* TRUE once in a parse store */
+	int                 size;          /* bytes charged to the cache */
+	int                 length;
+	int                 num_linkages_found;
+	int                 num_linkages_alloced;
+	int                 num_linkages_post_processed;
+	int                 num_valid_linkages;
+	int                 null_count;
+	char *              has_disjunction;  /* NULL if there was no parse set */
+	Cached_info *       info;
+	Cached_linkage **   linkage;       /* filled in lazily */
+};
+
+struct Parse_cache_s {
+	long                 max_bytes;
+	long                 bytes;
+	long                 N_entries;
+	long                 hits, misses, evictions;
+	int                  table_size;
+	Parse_cache_entry ** table;
+	Parse_cache_entry *  newest, * oldest;
+};
+
+#ifndef _WIN32
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+#define LOCK_CACHE()   pthread_mutex_lock(&cache_lock)
+#define UNLOCK_CACHE() pthread_mutex_unlock(&cache_lock)
+#else
+#define LOCK_CACHE()
+#define UNLOCK_CACHE()
+#endif
+
+/* Bytes needed to hold n objects of type t, rounded up so that the
+   next region of a linkage image or a saved entry stays aligned. */
+#define PC_ALIGN(n) (((n) + (int)sizeof(int) - 1) & ~((int)sizeof(int) - 1))
+#define PC_ALIGNED(n, t) PC_ALIGN((n)*(int)sizeof(t))
+
+/***************************************************************
+*
+* Keys
+*
+****************************************************************/
+
+unsigned int parse_cache_hash_key(const char *key, int len)
+{
+	unsigned int accum = 2166136261U;
+	int i;
+	for (i=0; i<len; i++) {
+		accum ^= (unsigned char) key[i];
+		accum *= 16777619U;
+	}
+	return accum;
+}
+
+/**
+ * Returns the key of a sentence parsed with these options, allocated
+ * with exalloc(), and its length in *len.
+ */
+char * parse_cache_key(Sentence sent, Parse_Options opts, int *len)
+{
+	int option[PC_N_OPTIONS];
+	char *key, *p;
+	int i, n;
+
+	option[PC_LINKAGE_LIMIT]  = opts->linkage_limit;
+	option[PC_DISJUNCT_COST]  = opts->disjunct_cost;
+	option[PC_MIN_NULL_COUNT] = opts->min_null_count;
+	option[PC_MAX_NULL_COUNT] = opts->max_null_count;
+	option[PC_NULL_BLOCK]     = opts->null_block;
+	option[PC_ISLANDS_OK]     = opts->islands_ok;
+	option[PC_SHORT_LENGTH]   = opts->short_length;
+	option[PC_ALL_SHORT]      = opts->all_short;
+	option[PC_TWOPASS_LENGTH] = opts->twopass_length;
+	option[PC_COST_MODEL]     = opts->cost_model.type;
+	option[PC_UNKNOWN_WORDS]  = opts->unknown_word_disjuncts;
+
+	n = sizeof(option);
+	for (i=0; i<sent->length; i++) {
+		n += strlen(sent->word[i].string) + 1;
+	}
+
+	key = (char *) exalloc(n);
+	memcpy(key, option, sizeof(option));
+	p = key + sizeof(option);
+	for (i=0; i<sent->length; i++) {
+		strcpy(p, sent->word[i].string);
+		p += strlen(p);
+		*p++ = ' ';
+	}
+	*len = n;
+	return key;
+}
+
+/***************************************************************
+*
+* The table and the use list.  The caller holds the lock.
+*
+****************************************************************/
+
+static void unlink_use(Parse_cache *pc, Parse_cache_entry *e)
+{
+	if (e->newer != NULL) e->newer->older = e->older;
+	else pc->newest = e->older;
+	if (e->older != NULL) e->older->newer = e->newer;
+	else pc->oldest = e->newer;
+	e->older = e->newer = NULL;
+}
+
+static void link_use(Parse_cache *pc, Parse_cache_entry *e)
+{
+	e->older = pc->newest;
+	e->newer = NULL;
+	if (pc->newest != NULL) pc->newest->newer = e;
+	else pc->oldest = e;
+	pc->newest = e;
+}
+
+static void free_image(Cached_linkage *img)
+{
+	exfree(img, img->size);
+}
+
+static void free_entry(Parse_cache_entry *e)
+{
+	int k;
+	for (k=0; k<e->num_linkages_post_processed; k++) {
+		if (e->linkage[k] != NULL) free_image(e->linkage[k]);
+	}
+	if (e->num_linkages_post_processed > 0) {
+		exfree(e->linkage, e->num_linkages_post_processed*sizeof(Cached_linkage *));
+		exfree(e->info, e->num_linkages_post_processed*sizeof(Cached_info));
+	}
+	if (e->has_disjunction != NULL) exfree(e->has_disjunction, e->length);
+	exfree(e->key, e->key_len);
+	exfree(e, sizeof(Parse_cache_entry));
+}
+
+static void evict(Parse_cache *pc, Parse_cache_entry *e)
+{
+	Parse_cache_entry **p;
+
+	for (p = &pc->table[e->hash & (pc->table_size-1)]; *p != e; p = &(*p)->next)
+		;
+	*p = e->next;
+	e->next = NULL;
+	unlink_use(pc, e);
+	pc->bytes -= e->size;
+	pc->N_entries--;
+	pc->evictions++;
+	e->cache = NULL;
+	if (e->refcount == 0) free_entry(e);
+}
+
+static void trim(Parse_cache *pc)
+{
+	while ((pc->bytes > pc->max_bytes) && (pc->oldest != NULL)) {
+		evict(pc, pc->oldest);
+	}
+}
+
+static void grow_table(Parse_cache *pc)
+{
+	Parse_cache_entry **table, *e, *next;
+	int i, size;
+
+	size = 2*pc->table_size;
+	table = (Parse_cache_entry **) exalloc(size*sizeof(Parse_cache_entry *));
+	for (i=0; i<size; i++) table[i] = NULL;
+	for (i=0; i<pc->table_size; i++) {
+		for (e = pc->table[i]; e != NULL; e = next) {
+			next = e->next;
+			e->next = table[e->hash & (size-1)];
+			table[e->hash & (size-1)] = e;
+		}
+	}
+	exfree(pc->table, pc->table_size*sizeof(Parse_cache_entry *));
+	pc->table = table;
+	pc->table_size = size;
+}
+
+/***************************************************************
+*
+* Caches and entries
+*
+****************************************************************/
+
+Parse_cache * parse_cache_create(long max_bytes)
+{
+	Parse_cache *pc;
+	int i;
+
+	pc = (Parse_cache *) exalloc(sizeof(Parse_cache));
+	pc->max_bytes = max_bytes;
+	pc->bytes = 0;
+	pc->N_entries = 0;
+	pc->hits = pc->misses = pc->evictions = 0;
+	pc->table_size = PC_INITIAL_TABLE_SIZE;
+	pc->table = (Parse_cache_entry **) exalloc(pc->table_size*sizeof(Parse_cache_entry *));
+	for (i=0; i<pc->table_size; i++) pc->table[i] = NULL;
+	pc->newest = pc->oldest = NULL;
+	return pc;
+}
+
+void parse_cache_delete(Parse_cache *pc)
+{
+	if (pc == NULL) return;
+	LOCK_CACHE();
+	while (pc->oldest != NULL) evict(pc, pc->oldest);
+	UNLOCK_CACHE();
+	exfree(pc->table, pc->table_size*sizeof(Parse_cache_entry *));
+	exfree(pc, sizeof(Parse_cache));
+}
+
+/**
+ * Returns the entry for this sentence parsed with these options, with
+ * a reference held for the caller, or NULL if there is none.
+ */
+Parse_cache_entry * parse_cache_lookup(Parse_cache *pc, Sentence sent, Parse_Options opts)
+{
+	Parse_cache_entry *e;
+	unsigned int hash;
+	char *key;
+	int len;
+
+	key = parse_cache_key(sent, opts, &len);
+	hash = parse_cache_hash_key(key, len);
+
+	LOCK_CACHE();
+	for (e = pc->table[hash & (pc->table_size-1)]; e != NULL; e = e->next) {
+		if ((e->hash == hash) && (e->key_len == len) &&
+			(memcmp(e->key, key, len) == 0)) break;
+	}
+	if (e != NULL) {
+		e->refcount++;
+		unlink_use(pc, e);
+		link_use(pc, e);
+		pc->hits++;
+	}
+	else {
+		pc->misses++;
+	}
+	UNLOCK_CACHE();
+
+	exfree(key, len);
+	return e;
+}
+
+/* An entry with room for N linkages and no images yet */
+static void cache_info(Cached_info *ci, Linkage_info *li)
+{
+	ci->index = li->index;
+	ci->fat = li->fat;
+	ci->canonical = li->canonical;
+	ci->improper_fat_linkage = li->improper_fat_linkage;
+	ci->inconsistent_domains = li->inconsistent_domains;
+	ci->N_violations = li->N_violations;
+	ci->null_cost = li->null_cost;
+	ci->unused_word_cost = li->unused_word_cost;
+	ci->disjunct_cost = li->disjunct_cost;
+	ci->and_cost = li->and_cost;
+	ci->link_cost = li->link_cost;
+}
+
+static void restore_info(Linkage_info *li, Cached_info *ci)
+{
+	li->index = ci->index;
+	li->fat = ci->fat;
+	li->canonical = ci->canonical;
+	li->improper_fat_linkage = ci->improper_fat_linkage;
+	li->inconsistent_domains = ci->inconsistent_domains;
+	li->N_violations = ci->N_violations;
+	li->null_cost = ci->null_cost;
+	li->unused_word_cost = ci->unused_word_cost;
+	li->disjunct_cost = ci->disjunct_cost;
+	li->and_cost = ci->and_cost;
+	li->link_cost = ci->link_cost;
+}
+
+static Parse_cache_entry * new_entry(int key_len, int length, int N)
+{
+	Parse_cache_entry *e;
+	int k;
+
+	e = (Parse_cache_entry *) exalloc(sizeof(Parse_cache_entry));
+	e->key = (char *) exalloc(key_len);
+	e->key_len = key_len;
+	e->next = e->older = e->newer = NULL;
+	e->cache = NULL;
+	e->refcount = 1;
+	e->length = length;
+	e->num_linkages_post_processed = N;
+	e->saved = FALSE;
+	e->has_disjunction = NULL;
+	e->info = NULL;
+	e->linkage = NULL;
+	e->size = sizeof(Parse_cache_entry) + key_len;
+	if (N > 0) {
+		e->info = (Cached_info *) exalloc(N*sizeof(Cached_info));
+		e->linkage = (Cached_linkage **) exalloc(N*sizeof(Cached_linkage *));
+		for (k=0; k<N; k++) e->linkage[k] = NULL;
+		e->size += N*(sizeof(Cached_info) + sizeof(Cached_linkage *));
+	}
+	return e;
+}
+
+/**
+ * Records the outcome of a completed sentence_parse() in a new entry
+ * that belongs to no cache yet, with a reference held for the caller.
+ */
+Parse_cache_entry * parse_cache_entry_create(Sentence sent, Parse_Options opts)
+{
+	Parse_cache_entry *e;
+	char *key;
+	int k, i, len;
+
+	key = parse_cache_key(sent, opts, &len);
+	e = new_entry(len, sent->length, sent->num_linkages_post_processed);
+	memcpy(e->key, key, len);
+	exfree(key, len);
+	e->hash = parse_cache_hash_key(e->key, e->key_len);
+	e->num_linkages_found = sent->num_linkages_found;
+	e->num_linkages_alloced = sent->num_linkages_alloced;
+	e->num_valid_linkages = sent->num_valid_linkages;
+	e->null_count = sent->null_count;
+
+	if (sent->parse_info != NULL) {
+		e->has_disjunction = (char *) exalloc(e->length);
+		for (i=0; i<e->length; i++) {
+			e->has_disjunction[i] = (sent->parse_info->chosen_disjuncts[i] != NULL);
+		}
+		e->size += e->length;
+	}
+
+	for (k=0; k<e->num_linkages_post_processed; k++) {
+		cache_info(&e->info[k], &sent->link_info[k]);
+	}
+	return e;
+}
+
+/**
+ * Puts a new entry into the cache.  The caller's reference to it is
+ * passed on to the entry returned, which is the one already cached
+ * under the same key if another thread got there first.
+ */
+Parse_cache_entry * parse_cache_add(Parse_cache *pc, Parse_cache_entry *e)
+{
+	Parse_cache_entry *old;
+
+	LOCK_CACHE();
+	for (old = pc->table[e->hash & (pc->table_size-1)]; old != NULL; old = old->next) {
+		if ((old->hash == e->hash) && (old->key_len == e->key_len) &&
+			(memcmp(old->key, e->key, e->key_len) == 0)) break;
+	}
+	if (old != NULL) {
+		old->refcount++;
+		UNLOCK_CACHE();
+		parse_cache_release(e);
+		return old;
+	}
+	e->cache = pc;
+	if (pc->N_entries >= pc->table_size) grow_table(pc);
+	e->next = pc->table[e->hash & (pc->table_size-1)];
+	pc->table[e->hash & (pc->table_size-1)] = e;
+	link_use(pc, e);
+	pc->N_entries++;
+	pc->bytes += e->size;
+	trim(pc);
+	UNLOCK_CACHE();
+
+	return e;
+}
+
+void parse_cache_release(Parse_cache_entry *e)
+{
+	if (e == NULL) return;
+	LOCK_CACHE();
+	e->refcount--;
+	if ((e->refcount == 0) && (e->cache == NULL)) free_entry(e);
+	UNLOCK_CACHE();
+}
+
+/**
+ * Gives the sentence the counts and linkage costs of a cached parse.
+ * Any previous post-processing results must have been freed.
+ */
+void parse_cache_restore(Parse_cache_entry *e, Sentence sent)
+{
+	int k;
+
+	sent->num_linkages_found = e->num_linkages_found;
+	sent->num_linkages_alloced = e->num_linkages_alloced;
+	sent->num_linkages_post_processed = e->num_linkages_post_processed;
+	sent->num_valid_linkages = e->num_valid_linkages;
+	sent->null_count = e->null_count;
+	sent->link_info = NULL;
+	if (e->num_linkages_alloced == 0) return;
+
+	sent->link_info = (Linkage_info *) xalloc(e->num_linkages_alloced*sizeof(Linkage_info));
+	memset(sent->link_info, 0, e->num_linkages_alloced*sizeof(Linkage_info));
+	for (k=0; k<e->num_linkages_post_processed; k++) {
+		restore_info(&sent->link_info[k], &e->info[k]);
+	}
+}
+
+/**
+ * Sets the options that were in effect when the entry was parsed, so
+ * that a restored sentence can be parsed again to the same result.
+ */
+void parse_cache_entry_options(Parse_cache_entry *e, Parse_Options opts)
+{
+	int option[PC_N_OPTIONS];
+
+	memcpy(option, e->key, sizeof(option));
+	opts->linkage_limit = option[PC_LINKAGE_LIMIT];
+	opts->disjunct_cost = option[PC_DISJUNCT_COST];
+	opts->min_null_count = option[PC_MIN_NULL_COUNT];
+	opts->max_null_count = option[PC_MAX_NULL_COUNT];
+	opts->null_block = option[PC_NULL_BLOCK];
+	opts->islands_ok = option[PC_ISLANDS_OK];
+	opts->short_length = option[PC_SHORT_LENGTH];
+	opts->all_short = option[PC_ALL_SHORT];
+	opts->twopass_length = option[PC_TWOPASS_LENGTH];
+	parse_options_set_cost_model_type(opts, option[PC_COST_MODEL]);
+	opts->unknown_word_disjuncts = option[PC_UNKNOWN_WORDS];
+}
+
+int parse_cache_has_disjunction(Parse_cache_entry *e, int w)
+{
+	if (e->has_disjunction == NULL) return FALSE;
+	return e->has_disjunction[w];
+}
+
+/***************************************************************
+*
+* Linkage images
+*
+****************************************************************/
+
+/* The strings of an image are pooled: a word or a label that turns up
+   more than once (and most link labels do) is stored once, and every
+   use of it shares its offset. */
+typedef struct {
+	int           size;          /* a power of two */
+	const char ** string;
+	int *         offset;        /* -1 until it is copied in */
+} String_pool;
+
+static void pool_create(String_pool *sp, int N)
+{
+	int i;
+	for (sp->size = 16; sp->size < 2*N; sp->size *= 2)
+		;
+	sp->string = (const char **) exalloc(sp->size*sizeof(char *));
+	sp->offset = (int *) exalloc(sp->size*sizeof(int));
+	for (i=0; i<sp->size; i++) {
+		sp->string[i] = NULL;
+		sp->offset[i] = -1;
+	}
+}
+
+static void pool_delete(String_pool *sp)
+{
+	exfree(sp->string, sp->size*sizeof(char *));
+	exfree(sp->offset, sp->size*sizeof(int));
+}
+
+static int pool_slot(String_pool *sp, const char *s)
+{
+	int i = parse_cache_hash_key(s, strlen(s)) & (sp->size-1);
+	while ((sp->string[i] != NULL) && (strcmp(sp->string[i], s) != 0)) {
+		i = (i+1) & (sp->size-1);
+	}
+	return i;
+}
+
+/* Returns the bytes s adds to the pool: none if it's already there */
+static int pool_count(String_pool *sp, const char *s)
+{
+	int i = pool_slot(sp, s);
+	if (sp->string[i] != NULL) return 0;
+	sp->string[i] = s;
+	return strlen(s) + 1;
+}
+
+/* Copies s to the end of the image, unless it is there already, and
+   returns its offset */
+static int pool_add(Cached_linkage *img, String_pool *sp, int *pool, const char *s)
+{
+	int i = pool_slot(sp, s);
+	if (sp->offset[i] < 0) {
+		sp->offset[i] = *pool;
+		strcpy(IMAGE_AT(img, *pool), s);
+		*pool += strlen(s) + 1;
+	}
+	return sp->offset[i];
+}
+
+static void image_connector(Cached_linkage *img, String_pool *sp, int *pool,
+							Cached_connector *cc, Connector *c)
+{
+	cc->label = c->label;
+	cc->word = c->word;
+	cc->length_limit = c->length_limit;
+	cc->priority = c->priority;
+	cc->multi = c->multi;
+	cc->string = pool_add(img, sp, pool, c->string);
+}
+
+static Cached_linkage * make_image(Linkage linkage)
+{
+	Cached_linkage *img;
+	Cached_sublinkage *cs;
+	Cached_link *cl;
+	Sublinkage *s;
+	String_pool sp;
+	Link link;
+	int *word;
+	int i, j, d, num_links, num_chars, size, offset, pool;
+
+	num_links = 0;
+	for (i=0; i<linkage->num_sublinkages; i++) {
+		num_links += linkage->sublinkage[i].num_links;
+	}
+	pool_create(&sp, linkage->num_words + linkage->num_sublinkages + 3*num_links);
+
+	num_chars = 0;
+	for (i=0; i<linkage->num_words; i++) {
+		num_chars += pool_count(&sp, linkage->word[i]);
+	}
+	for (i=0; i<linkage->num_sublinkages; i++) {
+		s = &linkage->sublinkage[i];
+		if (s->violation != NULL) num_chars += pool_count(&sp, s->violation);
+		for (j=0; j<s->num_links; j++) {
+			link = s->link[j];
+			num_chars += pool_count(&sp, link->name);
+			num_chars += pool_count(&sp, link->lc->string);
+			num_chars += pool_count(&sp, link->rc->string);
+			if (s->pp_info != NULL) num_chars += s->pp_info[j].num_domains + 1;
+		}
+	}
+
+	size = PC_ALIGNED(1, Cached_linkage) +
+		PC_ALIGNED(linkage->num_words, int) +
+		PC_ALIGNED(linkage->num_sublinkages, Cached_sublinkage) +
+		PC_ALIGNED(num_links, Cached_link) + PC_ALIGN(num_chars);
+
+	img = (Cached_linkage *) exalloc(size);
+	memset(img, 0, size);
+	img->size = size;
+	img->num_words = linkage->num_words;
+	img->num_sublinkages = linkage->num_sublinkages;
+	img->word = PC_ALIGNED(1, Cached_linkage);
+	img->sublinkage = img->word + PC_ALIGNED(linkage->num_words, int);
+	offset = img->sublinkage + PC_ALIGNED(linkage->num_sublinkages, Cached_sublinkage);
+	pool = offset + PC_ALIGNED(num_links, Cached_link);
+
+	word = (int *) IMAGE_AT(img, img->word);
+	for (i=0; i<linkage->num_words; i++) {
+		word[i] = pool_add(img, &sp, &pool, linkage->word[i]);
+	}
+	for (i=0; i<linkage->num_sublinkages; i++) {
+		s = &linkage->sublinkage[i];
+		cs = &((Cached_sublinkage *) IMAGE_AT(img, img->sublinkage))[i];
+		cs->num_links = s->num_links;
+		cs->link = offset;
+		cs->has_pp_info = (s->pp_info != NULL);
+		cs->violation = -1;
+		if (s->violation != NULL) cs->violation = pool_add(img, &sp, &pool, s->violation);
+		for (j=0; j<s->num_links; j++, offset += sizeof(Cached_link)) {
+			cl = (Cached_link *) IMAGE_AT(img, offset);
+			link = s->link[j];
+			cl->l = link->l;
+			cl->r = link->r;
+			cl->name = pool_add(img, &sp, &pool, link->name);
+			image_connector(img, &sp, &pool, &cl->lc, link->lc);
+			image_connector(img, &sp, &pool, &cl->rc, link->rc);
+			cl->num_domains = 0;
+			cl->domains = -1;
+			if (s->pp_info != NULL) {
+				cl->num_domains = s->pp_info[j].num_domains;
+				cl->domains = pool;
+				for (d=0; d<cl->num_domains; d++) {
+					*IMAGE_AT(img, pool++) = s->pp_info[j].domain_name[d][0];
+				}
+				*IMAGE_AT(img, pool++) = '\0';
+			}
+		}
+	}
+	pool_delete(&sp);
+	return img;
+}
+
+static void connector_of_image(Cached_linkage *img, Connector *c, Cached_connector *cc)
+{
+	init_connector(c);
+	c->label = cc->label;
+	c->word = cc->word;
+	c->length_limit = cc->length_limit;
+	c->priority = cc->priority;
+	c->multi = cc->multi;
+	c->next = NULL;
+	c->string = IMAGE_AT(img, cc->string);
+}
+
+/* Builds a linkage from an image */
+static Linkage linkage_of_image(Cached_linkage *img, Sentence sent,
+								Dictionary dict, Parse_Options opts)
+{
+	Cached_sublinkage *cs;
+	Cached_link *cl;
+	Sublinkage *s;
+	Linkage linkage;
+	struct Link_s link;
+	Connector lc, rc;
+	const char *str;
+	int *word;
+	int i, j, d;
+
+	linkage = (Linkage) exalloc(sizeof(struct Linkage_s));
+	linkage->num_words = img->num_words;
+	linkage->word = (const char **) exalloc(linkage->num_words*sizeof(char *));
+	word = (int *) IMAGE_AT(img, img->word);
+	for (i=0; i<img->num_words; i++) {
+		str = IMAGE_AT(img, word[i]);
+		linkage->word[i] = strcpy((char *) exalloc(strlen(str)+1), str);
+	}
+	linkage->current = 0;
+	linkage->unionized = FALSE;
+	linkage->sent = sent;
+	linkage->dict = dict;
+	linkage->opts = opts;
+	linkage->constituent_tree = NULL;
+	linkage->constituent_string = NULL;
+	linkage->num_sublinkages = img->num_sublinkages;
+	linkage->sublinkage = (Sublinkage *) exalloc(img->num_sublinkages*sizeof(Sublinkage));
+
+	for (i=0; i<img->num_sublinkages; i++) {
+		cs = &((Cached_sublinkage *) IMAGE_AT(img, img->sublinkage))[i];
+		s = &linkage->sublinkage[i];
+		memset(&s->pp_data, 0, sizeof(PP_data));
+		s->num_links = cs->num_links;
+		s->link = (Link *) exalloc(cs->num_links*sizeof(Link));
+		s->pp_info = NULL;
+		if (cs->has_pp_info) {
+			s->pp_info = (PP_info *) exalloc(cs->num_links*sizeof(PP_info));
+		}
+		s->violation = NULL;
+		if (cs->violation >= 0) {
+			str = IMAGE_AT(img, cs->violation);
+			s->violation = strcpy((char *) exalloc(strlen(str)+1), str);
+		}
+		for (j=0; j<cs->num_links; j++) {
+			cl = &((Cached_link *) IMAGE_AT(img, cs->link))[j];
+			connector_of_image(img, &lc, &cl->lc);
+			connector_of_image(img, &rc, &cl->rc);
+			link.l = cl->l;
+			link.r = cl->r;
+			link.name = IMAGE_AT(img, cl->name);
+			link.lc = &lc;
+			link.rc = &rc;
+			s->link[j] = excopy_link(&link);
+			if (s->pp_info == NULL) continue;
+			s->pp_info[j].num_domains = cl->num_domains;
+			s->pp_info[j].domain_name = NULL;
+			if (cl->num_domains == 0) continue;
+			s->pp_info[j].domain_name = (char **) exalloc(cl->num_domains*sizeof(char *));
+			for (d=0; d<cl->num_domains; d++) {
+				s->pp_info[j].domain_name[d] = (char *) exalloc(2);
+				s->pp_info[j].domain_name[d][0] = *IMAGE_AT(img, cl->domains + d);
+				s->pp_info[j].domain_name[d][1] = '\0';
+			}
+		}
+	}
+	return linkage;
+}
+
+/**
+ * Builds linkage k of a restored sentence from its image.  Returns NULL
+ * if nobody has built that linkage yet.
+ */
+Linkage parse_cache_linkage(Parse_cache_entry *e, int k, Sentence sent, Parse_Options opts)
+{
+	Cached_linkage *img;
+	Linkage linkage;
+
+	LOCK_CACHE();
+	img = e->linkage[k];
+	UNLOCK_CACHE();
+	if (img == NULL) return NULL;
+
+	linkage = linkage_of_image(img, sent, sent->dict, opts);
+	linkage->info = sent->link_info[k];
+	return linkage;
+}
+
+/**
+ * Keeps an image of a linkage just built by linkage_create(), unless
+ * the entry has one already.
+ */
+void parse_cache_store_linkage(Parse_cache_entry *e, int k, Linkage linkage)
+{
+	Cached_linkage *img;
+
+	LOCK_CACHE();
+	img = e->linkage[k];
+	UNLOCK_CACHE();
+	if (img != NULL) return;
+
+	img = make_image(linkage);
+
+	LOCK_CACHE();
+	if (e->linkage[k] != NULL) {
+		UNLOCK_CACHE();
+		free_image(img);
+		return;
+	}
+	e->linkage[k] = img;
+	e->size += img->size;
+	if (e->cache != NULL) {
+		e->cache->bytes += img->size;
+		trim(e->cache);
+	}
+	UNLOCK_CACHE();
+}
+
+/**
+ * Makes an entry, belonging to no cache, whose only linkage is the one
+ * given, for a sentence that was not parsed as a whole.  A word has a
+ * disjunction if some link of the linkage uses it, and the words that
+ * none does are its null count.
+ */
+Parse_cache_entry * parse_cache_entry_of_linkage(Sentence sent, Parse_Options opts,
+												 Linkage linkage)
+{
+	Parse_cache_entry *e;
+	Sublinkage *s;
+	char *key;
+	int i, j, len;
+
+	key = parse_cache_key(sent, opts, &len);
+	e = new_entry(len, sent->length, 1);
+	memcpy(e->key, key, len);
+	exfree(key, len);
+	e->hash = parse_cache_hash_key(e->key, e->key_len);
+	e->num_linkages_found = 1;
+	e->num_linkages_alloced = 1;
+	e->num_valid_linkages = (linkage->info.N_violations == 0);
+
+	e->has_disjunction = (char *) exalloc(e->length);
+	memset(e->has_disjunction, FALSE, e->length);
+	for (i=0; i<linkage->num_sublinkages; i++) {
+		s = &linkage->sublinkage[i];
+		for (j=0; j<s->num_links; j++) {
+			e->has_disjunction[s->link[j]->l] = TRUE;
+			e->has_disjunction[s->link[j]->r] = TRUE;
+		}
+	}
+	e->null_count = 0;
+	for (i=0; i<e->length; i++) {
+		if (!e->has_disjunction[i]) e->null_count++;
+	}
+	e->size += e->length;
+
+	cache_info(&e->info[0], &linkage->info);
+	e->linkage[0] = make_image(linkage);
+	e->size += e->linkage[0]->size;
+	return e;
+}
+
+/***************************************************************
+*
+* Saved entries
+*
+* A saved entry is a header of PC_HEADER ints, then the key, the
+* disjunction flags if there are any, the linkage costs, and the image
+* of every linkage one after the other, or just a zero size for those
+* that have none.  Each part is padded to the size of an int.
+*
+****************************************************************/
+
+#define PC_KEY_LEN         0
+#define PC_LENGTH          1
+#define PC_FOUND           2
+#define PC_ALLOCED         3
+#define PC_POST_PROCESSED  4
+#define PC_VALID           5
+#define PC_NULL_COUNT      6
+#define PC_HAS_DISJUNCTION 7
+#define PC_HEADER          8
+
+unsigned int parse_cache_entry_hash(Parse_cache_entry *e)
+{
+	return e->hash;
+}
+
+/**
+ * Marks the entry as saved and returns TRUE if it was already, so that
+ * only one caller writes it out.
+ */
+int parse_cache_entry_set_saved(Parse_cache_entry *e)
+{
+	int saved;
+	LOCK_CACHE();
+	saved = e->saved;
+	e->saved = TRUE;
+	UNLOCK_CACHE();
+	return saved;
+}
+
+/**
+ * Returns the entry in saved form, allocated with exalloc(), and its
+ * size in *size.  Linkages with no image yet are saved as a zero size.
+ */
+char * parse_cache_entry_serialize(Parse_cache_entry *e, int *size)
+{
+	int header[PC_HEADER];
+	char *buf, *p;
+	int k, n, N;
+
+	N = e->num_linkages_post_processed;
+	n = PC_ALIGNED(PC_HEADER, int) + PC_ALIGN(e->key_len) + PC_ALIGNED(N, Cached_info);
+	if (e->has_disjunction != NULL) n += PC_ALIGN(e->length);
+	LOCK_CACHE();
+	for (k=0; k<N; k++) {
+		n += (e->linkage[k] != NULL) ? e->linkage[k]->size : (int) sizeof(int);
+	}
+
+	header[PC_KEY_LEN] = e->key_len;
+	header[PC_LENGTH] = e->length;
+	header[PC_FOUND] = e->num_linkages_found;
+	header[PC_ALLOCED] = e->num_linkages_alloced;
+	header[PC_POST_PROCESSED] = N;
+	header[PC_VALID] = e->num_valid_linkages;
+	header[PC_NULL_COUNT] = e->null_count;
+	header[PC_HAS_DISJUNCTION] = (e->has_disjunction != NULL);
+
+	buf = (char *) exalloc(n);
+	memset(buf, 0, n);
+	memcpy(buf, header, sizeof(header));
+	p = buf + PC_ALIGNED(PC_HEADER, int);
+	memcpy(p, e->key, e->key_len);
+	p += PC_ALIGN(e->key_len);
+	if (e->has_disjunction != NULL) {
+		memcpy(p, e->has_disjunction, e->length);
+		p += PC_ALIGN(e->length);
+	}
+	if (N > 0) memcpy(p, e->info, N*sizeof(Cached_info));
+	p += PC_ALIGNED(N, Cached_info);
+	for (k=0; k<N; k++) {
+		if (e->linkage[k] == NULL) {
+			p += sizeof(int);
+			continue;
+		}
+		memcpy(p, e->linkage[k], e->linkage[k]->size);
+		p += e->linkage[k]->size;
+	}
+	UNLOCK_CACHE();
+	*size = n;
+	return buf;
+}
+
+/**
+ * Returns TRUE if the saved entry in buf has this key.
+ */
+int parse_cache_saved_key_matches(const char *buf, int size, const char *key, int len)
+{
+	int header[PC_HEADER];
+
+	if (size < PC_ALIGNED(PC_HEADER, int)) return FALSE;
+	memcpy(header, buf, sizeof(header));
+	if (header[PC_KEY_LEN] != len) return FALSE;
+	if (size - PC_ALIGNED(PC_HEADER, int) < len) return FALSE;
+	return (memcmp(buf + PC_ALIGNED(PC_HEADER, int), key, len) == 0);
+}
+
+/* Checks that a string offset of an image is inside it */
+#define STRING_OK(img, offset, size) (((offset) >= (img)->word) && ((offset) < (size)))
+
+/* Checks that every offset in an image stays inside it, and that every
+   link is between two of its words */
+static int image_ok(const Cached_linkage *img, int size)
+{
+	const Cached_sublinkage *cs;
+	const Cached_link *cl;
+	const int *word;
+	int i, j;
+
+	if ((img->size != size) || (img->num_words < 0) || (img->num_sublinkages < 0)) return FALSE;
+	/* the counts are divided into the room left, rather than multiplied
+	   out, so that a huge count can't overflow past the checks */
+	if ((img->word < (int) sizeof(Cached_linkage)) || (img->word > size) ||
+		(img->num_words > (size - img->word) / (int)sizeof(int))) return FALSE;
+	if ((img->sublinkage < 0) || (img->sublinkage > size) ||
+		(img->num_sublinkages > (size - img->sublinkage) / (int)sizeof(Cached_sublinkage))) return FALSE;
+	/* the strings come last, so this keeps them all inside */
+	if (IMAGE_AT(img, size)[-1] != '\0') return FALSE;
+
+	word = (const int *) IMAGE_AT(img, img->word);
+	for (i=0; i<img->num_words; i++) {
+		if (!STRING_OK(img, word[i], size)) return FALSE;
+	}
+	for (i=0; i<img->num_sublinkages; i++) {
+		cs = &((const Cached_sublinkage *) IMAGE_AT(img, img->sublinkage))[i];
+		if ((cs->num_links < 0) || (cs->link < 0) || (cs->link > size) ||
+			(cs->num_links > (size - cs->link) / (int)sizeof(Cached_link))) return FALSE;
+		if ((cs->violation >= 0) && !STRING_OK(img, cs->violation, size)) return FALSE;
+		for (j=0; j<cs->num_links; j++) {
+			cl = &((const Cached_link *) IMAGE_AT(img, cs->link))[j];
+			if ((cl->l < 0) || (cl->l >= img->num_words) ||
+				(cl->r < 0) || (cl->r >= img->num_words)) return FALSE;
+			if (!STRING_OK(img, cl->name, size) || !STRING_OK(img, cl->lc.string, size) ||
+				!STRING_OK(img, cl->rc.string, size)) return FALSE;
+			if (!cs->has_pp_info) continue;
+			if ((cl->num_domains < 0) || !STRING_OK(img, cl->domains, size) ||
+				(cl->num_domains >= size - cl->domains)) return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/**
+ * Rebuilds an entry from its saved form.  The entry belongs to no cache
+ * and has a reference held for the caller.  Returns NULL if buf does
+ * not hold a well formed entry.
+ */
+Parse_cache_entry * parse_cache_entry_deserialize(const char *buf, int size)
+{
+	int header[PC_HEADER];
+	Parse_cache_entry *e;
+	Cached_linkage img;
+	const char *p, *end;
+	int k, N;
+
+	if (size < PC_ALIGNED(PC_HEADER, int)) return NULL;
+	memcpy(header, buf, sizeof(header));
+	N = header[PC_POST_PROCESSED];
+	if ((header[PC_KEY_LEN] < (int) (PC_N_OPTIONS*sizeof(int))) || (header[PC_LENGTH] < 0) ||
+		(N < 0) || (N > header[PC_ALLOCED]) || (N > size)) return NULL;
+
+	p = buf + PC_ALIGNED(PC_HEADER, int);
+	end = buf + size;
+	if (end - p < PC_ALIGN(header[PC_KEY_LEN]) + PC_ALIGNED(N, Cached_info)) return NULL;
+	if (header[PC_HAS_DISJUNCTION] &&
+		(end - p < PC_ALIGN(header[PC_KEY_LEN]) + PC_ALIGN(header[PC_LENGTH]) +
+		 PC_ALIGNED(N, Cached_info))) return NULL;
+
+	e = new_entry(header[PC_KEY_LEN], header[PC_LENGTH], N);
+	memcpy(e->key, p, e->key_len);
+	p += PC_ALIGN(e->key_len);
+	e->hash = parse_cache_hash_key(e->key, e->key_len);
+	e->num_linkages_found = header[PC_FOUND];
+	e->num_linkages_alloced = header[PC_ALLOCED];
+	e->num_valid_linkages = header[PC_VALID];
+	e->null_count = header[PC_NULL_COUNT];
+	if (header[PC_HAS_DISJUNCTION]) {
+		e->has_disjunction = (char *) exalloc(e->length);
+		memcpy(e->has_disjunction, p, e->length);
+		p += PC_ALIGN(e->length);
+		e->size += e->length;
+	}
+	if (N > 0) memcpy(e->info, p, N*sizeof(Cached_info));
+	p += PC_ALIGNED(N, Cached_info);
+
+	for (k=0; k<N; k++) {
+		if (end - p < (int) sizeof(int)) break;
+		memcpy(&img.size, p, sizeof(int));
+		if (img.size == 0) {
+			p += sizeof(int);
+			continue;
+		}
+		if ((img.size < (int) sizeof(Cached_linkage)) || (img.size > end - p)) break;
+		e->linkage[k] = (Cached_linkage *) exalloc(img.size);
+		memcpy(e->linkage[k], p, img.size);
+		if (!image_ok(e->linkage[k], img.size)) {
+			free_image(e->linkage[k]);
+			e->linkage[k] = NULL;
+			break;
+		}
+		e->size += img.size;
+		p += img.size;
+	}
+	if ((k < N) || (p != end)) {
+		free_entry(e);
+		return NULL;
+	}
+	e->saved = TRUE;
+	return e;
+}
+
+/***************************************************************
+*
+* Packed linkages
+*
+* A packed linkage is a header of PK_HEADER ints, the linkage's costs
+* and then its image, so that it can be handed to another process and
+* turned back into a linkage there, without its sentence.  The header
+* starts with a magic number, the byte order and a format version;
+* a packed linkage from a different version or machine is refused.
+*
+****************************************************************/
+
+#define PK_MAGIC      0x4c474c4b     /* "LGLK" */
+#define PK_BYTE_ORDER 0x01020304
+#define PK_VERSION    2
+
+#define PK_MAGIC_NUM       0
+#define PK_ORDER           1
+#define PK_VERSION_NUM     2
+#define PK_SIZE            3
+#define PK_CURRENT         4
+#define PK_UNIONIZED       5
+#define PK_HEADER          6
+
+#define PK_IMAGE (PC_ALIGNED(PK_HEADER, int) + PC_ALIGNED(1, Cached_info))
+
+/**
+ * Returns the linkage in packed form, allocated with exalloc(), and its
+ * size in *size.
+ */
+char * parse_cache_pack_linkage(Linkage linkage, int *size)
+{
+	int header[PK_HEADER];
+	Cached_linkage *img;
+	Cached_info info;
+	char *buf;
+
+	img = make_image(linkage);
+	memset(&info, 0, sizeof(info));
+	cache_info(&info, &linkage->info);
+
+	header[PK_MAGIC_NUM] = PK_MAGIC;
+	header[PK_ORDER] = PK_BYTE_ORDER;
+	header[PK_VERSION_NUM] = PK_VERSION;
+	header[PK_SIZE] = PK_IMAGE + img->size;
+	header[PK_CURRENT] = linkage->current;
+	header[PK_UNIONIZED] = linkage->unionized;
+
+	buf = (char *) exalloc(header[PK_SIZE]);
+	memset(buf, 0, PK_IMAGE);
+	memcpy(buf, header, sizeof(header));
+	memcpy(buf + PC_ALIGNED(PK_HEADER, int), &info, sizeof(info));
+	memcpy(buf + PK_IMAGE, img, img->size);
+	free_image(img);
+
+	*size = header[PK_SIZE];
+	return buf;
+}
+
+void parse_cache_pack_delete(char *buf)
+{
+	int header[PK_HEADER];
+	memcpy(header, buf, sizeof(header));
+	exfree(buf, header[PK_SIZE]);
+}
+
+/**
+ * Rebuilds a linkage from its packed form.  The linkage has no
+ * sentence.  The image is used where it lies unless buf isn't aligned
+ * for it.  Returns NULL if buf does not hold a well formed packed
+ * linkage.
+ */
+Linkage parse_cache_unpack_linkage(const char *buf, int size,
+								   Dictionary dict, Parse_Options opts)
+{
+	int header[PK_HEADER];
+	Cached_linkage *img;
+	Cached_info info;
+	Linkage linkage;
+	int aligned;
+
+	if (size < PK_IMAGE + (int) sizeof(Cached_linkage)) return NULL;
+	memcpy(header, buf, sizeof(header));
+	if ((header[PK_MAGIC_NUM] != PK_MAGIC) || (header[PK_ORDER] != PK_BYTE_ORDER) ||
+		(header[PK_VERSION_NUM] != PK_VERSION) || (header[PK_SIZE] != size)) return NULL;
+	memcpy(&info, buf + PC_ALIGNED(PK_HEADER, int), sizeof(info));
+
+	aligned = (((long) (buf + PK_IMAGE)) % sizeof(int) == 0);
+	if (aligned) {
+		img = (Cached_linkage *) (buf + PK_IMAGE);
+	} else {
+		img = (Cached_linkage *) exalloc(size - PK_IMAGE);
+		memcpy(img, buf + PK_IMAGE, size - PK_IMAGE);
+	}
+
+	linkage = NULL;
+	if (image_ok(img, size - PK_IMAGE) &&
+		(header[PK_CURRENT] >= 0) && (header[PK_CURRENT] < img->num_sublinkages)) {
+		linkage = linkage_of_image(img, NULL, dict, opts);
+		memset(&linkage->info, 0, sizeof(Linkage_info));
+		restore_info(&linkage->info, &info);
+		linkage->current = header[PK_CURRENT];
+		linkage->unionized = (header[PK_UNIONIZED] != 0);
+	}
+	if (!aligned) exfree(img, size - PK_IMAGE);
+	return linkage;
+}
+
+/***************************************************************
+*
+* The public interface
+*
+****************************************************************/
+
+/**
+ * Attaches a parse cache of at most max_bytes to the dictionary, or
+ * changes the limit of the one it has.  Zero or less removes the cache.
+ * Do this before the dictionary is shared between threads.
+ */
+void dictionary_set_parse_cache_size(Dictionary dict, long max_bytes)
+{
+	if (max_bytes <= 0) {
+		parse_cache_delete(dict->parse_cache);
+		dict->parse_cache = NULL;
+		return;
+	}
+	if (dict->parse_cache == NULL) {
+		dict->parse_cache = parse_cache_create(max_bytes);
+		return;
+	}
+	LOCK_CACHE();
+	dict->parse_cache->max_bytes = max_bytes;
+	trim(dict->parse_cache);
+	UNLOCK_CACHE();
+}
+
+static long cache_stat(const long *field)
+{
+	long val;
+	LOCK_CACHE();
+	val = *field;
+	UNLOCK_CACHE();
+	return val;
+}
+
+long dictionary_get_parse_cache_size(Dictionary dict)
+{
+	if (dict->parse_cache == NULL) return 0;
+	return cache_stat(&dict->parse_cache->max_bytes);
+}
+
+long dictionary_get_parse_cache_bytes(Dictionary dict)
+{
+	if (dict->parse_cache == NULL) return 0;
+	return cache_stat(&dict->parse_cache->bytes);
+}
+
+long dictionary_get_parse_cache_entries(Dictionary dict)
+{
+	if (dict->parse_cache == NULL) return 0;
+	return cache_stat(&dict->parse_cache->N_entries);
+}
+
+long dictionary_get_parse_cache_hits(Dictionary dict)
+{
+	if (dict->parse_cache == NULL) return 0;
+	return cache_stat(&dict->parse_cache->hits);
+}
+
+long dictionary_get_parse_cache_misses(Dictionary dict)
+{
+	if (dict->parse_cache == NULL) return 0;
+	return cache_stat(&dict->parse_cache->misses);
+}
+
+long dictionary_get_parse_cache_evictions(Dictionary dict)
+{
+	if (dict->parse_cache == NULL) return 0;
+	return cache_stat(&dict->parse_cache->evictions);
+}
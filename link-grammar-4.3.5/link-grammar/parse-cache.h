@@ -0,0 +1,61 @@
+/********************************************************************************/
+/* Copyright (c) 2004                                                           */
+/* Daniel Sleator, David Temperley, and John Lafferty                           */
+/* All rights reserved                                                          */
+/*                                                                              */
+/* Use of the link grammar parsing system is subject to the terms of the        */
+/* license set forth in the LICENSE file included with this software,           */
+/* and also available at http://www.link.cs.cmu.edu/link/license.html           */
+/* This license allows free redistribution and use in source and binary         */
+/* forms, with or without modification, subject to certain conditions.          */
+/*                                                                              */
+/********************************************************************************/
+/**********************************************************************
+  Calling paradigm:
+   . dictionary_set_parse_cache_size() attaches a cache to a dictionary.
+   . sentence_parse() calls parse_cache_lookup(); on a hit it calls
+     parse_cache_restore() instead of parsing, otherwise it parses,
+     calls parse_cache_entry_create() and hands the entry to
+     parse_cache_add().
+   . linkage_create() calls parse_cache_linkage() for sentences that
+     were restored, and parse_cache_store_linkage() for the ones it
+     builds the long way.
+   . A sentence parsed in segments (see split-parse.c) is given an
+     entry of its own, from parse_cache_entry_of_linkage(), that is
+     restored like a cached one but never added to the cache.
+   . sentence_delete() calls parse_cache_release().
+   . The parse store saves entries with parse_cache_entry_serialize()
+     and reads them back with parse_cache_entry_deserialize().
+   . linkage_pack() and linkage_unpack() use the same linkage images,
+     through parse_cache_pack_linkage() and parse_cache_unpack_linkage().
+***********************************************************************/
+
+#ifndef _PARSECACHEH_
+#define _PARSECACHEH_
+
+Parse_cache *       parse_cache_create(long max_bytes);
+void                parse_cache_delete(Parse_cache *pc);
+Parse_cache_entry * parse_cache_lookup(Parse_cache *pc, Sentence sent, Parse_Options opts);
+Parse_cache_entry * parse_cache_entry_create(Sentence sent, Parse_Options opts);
+Parse_cache_entry * parse_cache_add(Parse_cache *pc, Parse_cache_entry *e);
+void                parse_cache_release(Parse_cache_entry *e);
+void                parse_cache_restore(Parse_cache_entry *e, Sentence sent);
+void                parse_cache_entry_options(Parse_cache_entry *e, Parse_Options opts);
+int                 parse_cache_has_disjunction(Parse_cache_entry *e, int w);
+Linkage             parse_cache_linkage(Parse_cache_entry *e, int k, Sentence sent, Parse_Options opts);
+void                parse_cache_store_linkage(Parse_cache_entry *e, int k, Linkage linkage);
+Parse_cache_entry * parse_cache_entry_of_linkage(Sentence sent, Parse_Options opts, Linkage linkage);
+
+char *              parse_cache_key(Sentence sent, Parse_Options opts, int *len);
+unsigned int        parse_cache_hash_key(const char *key, int len);
+unsigned int        parse_cache_entry_hash(Parse_cache_entry *e);
+int                 parse_cache_entry_set_saved(Parse_cache_entry *e);
+char *              parse_cache_entry_serialize(Parse_cache_entry *e, int *size);
+int                 parse_cache_saved_key_matches(const char *buf, int size, const char *key, int len);
+Parse_cache_entry * parse_cache_entry_deserialize(const char *buf, int size);
+
+char *              parse_cache_pack_linkage(Linkage linkage, int *size);
+void                parse_cache_pack_delete(char *buf);
+Linkage             parse_cache_unpack_linkage(const char *buf, int size, Dictionary dict, Parse_Options opts);
+
+#endif
@@ -0,0 +1,448 @@
+/********************************************************************************/
+/* Copyright (c) 2004                                                           */
+/* Daniel Sleator, David Temperley, and John Lafferty                           */
+/* All rights reserved                                                          */
+/*                                                                              */
+/* Use of the link grammar parsing system is subject to the terms of the        */
+/* license set forth in the LICENSE file included with this software,           */
+/* and also available at http://www.link.cs.cmu.edu/link/license.html           */
+/* This license allows free redistribution and use in source and binary         */
+/* forms, with or without modification, subject to certain conditions.          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <link-grammar/api.h>
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#endif
+
+/* A parse store keeps parse cache entries in a file, so that parses
+   made by one process can be used by the next.
+
+   The file starts with a Store_header and is followed by records, each
+   a Record_header and a saved entry (see parse-cache.c).  Records are
+   only ever appended, one write() apiece, by the single process that
+   holds an exclusive flock() on the file; any number of others may read
+   it at the same time.  A record whose checksum does not match is one
+   still being written, or one whose writer died; readers stop there and
+   look again next time, and the next writer to open the file cuts it
+   off.
+
+   Every record carries the identity of the dictionary that made it,
+   which changes whenever any of its data files does.  Records made by
+   another dictionary, or an older version of this one, are never
+   indexed, so they are never served.
+
+   The file is mapped read only.  Lookups first index whatever has been
+   added since the last one, then look the sentence up by the hash of
+   its key, compare the key itself, and copy the entry out of the map. */
+
+#define PS_MAGIC        "LGSTORE1"
+#define PS_BYTE_ORDER   0x01020304
+#define PS_VERSION      2
+#define PS_RECORD_MAGIC 0x4c475231
+
+#define PS_INITIAL_TABLE_SIZE 256
+
+typedef struct {
+	char         magic[8];
+	unsigned int byte_order;     /* files are only read on their own kind of machine */
+	int          version;
+} Store_header;
+
+typedef struct {
+	unsigned int magic;
+	int          size;           /* of the saved entry that follows */
+	unsigned int identity;       /* of the dictionary that parsed it */
+	unsigned int hash;           /* of its key */
+	unsigned int checksum;       /* of the saved entry */
+	int          pad;
+} Record_header;
+
+#ifndef _WIN32
+
+struct Parse_store_s {
+	int            fd;
+	int            writable;
+	int            bad;          /* TRUE if the file is not a parse store */
+	unsigned int   identity;
+	char *         map;
+	size_t         map_len;
+	off_t          scanned;      /* everything before this is indexed */
+	int            table_size;
+	long           N_records;
+	off_t *        offset;       /* of each record, -1 if the slot is free */
+	unsigned int * hash;
+	long           hits;
+};
+
+static pthread_mutex_t store_lock = PTHREAD_MUTEX_INITIALIZER;
+#define LOCK_STORE()   pthread_mutex_lock(&store_lock)
+#define UNLOCK_STORE() pthread_mutex_unlock(&store_lock)
+
+/***************************************************************
+*
+* The index.  The caller holds the lock.
+*
+****************************************************************/
+
+static void alloc_index(Parse_store *ps, int size)
+{
+	int i;
+	ps->table_size = size;
+	ps->offset = (off_t *) exalloc(size*sizeof(off_t));
+	ps->hash = (unsigned int *) exalloc(size*sizeof(unsigned int));
+	for (i=0; i<size; i++) ps->offset[i] = -1;
+}
+
+static void free_index(Parse_store *ps)
+{
+	exfree(ps->offset, ps->table_size*sizeof(off_t));
+	exfree(ps->hash, ps->table_size*sizeof(unsigned int));
+}
+
+static void index_insert(Parse_store *ps, unsigned int hash, off_t offset)
+{
+	int i;
+	for (i = hash & (ps->table_size-1); ps->offset[i] >= 0; i = (i+1) & (ps->table_size-1))
+		;
+	ps->offset[i] = offset;
+	ps->hash[i] = hash;
+}
+
+static void index_add(Parse_store *ps, unsigned int hash, off_t offset)
+{
+	off_t *old_offset;
+	unsigned int *old_hash;
+	int i, old_size;
+
+	if (2*(ps->N_records+1) > ps->table_size) {
+		old_offset = ps->offset;
+		old_hash = ps->hash;
+		old_size = ps->table_size;
+		alloc_index(ps, 2*old_size);
+		for (i=0; i<old_size; i++) {
+			if (old_offset[i] >= 0) index_insert(ps, old_hash[i], old_offset[i]);
+		}
+		exfree(old_offset, old_size*sizeof(off_t));
+		exfree(old_hash, old_size*sizeof(unsigned int));
+	}
+	index_insert(ps, hash, offset);
+	ps->N_records++;
+}
+
+/***************************************************************
+*
+* Reading the file.  The caller holds the lock.
+*
+****************************************************************/
+
+static int remap(Parse_store *ps, size_t len)
+{
+	void *map;
+
+	if (ps->map != NULL) munmap(ps->map, ps->map_len);
+	ps->map = NULL;
+	ps->map_len = 0;
+	if (len == 0) return TRUE;
+	map = mmap(NULL, len, PROT_READ, MAP_SHARED, ps->fd, 0);
+	if (map == MAP_FAILED) return FALSE;
+	ps->map = (char *) map;
+	ps->map_len = len;
+	return TRUE;
+}
+
+static void make_store_header(Store_header *fh)
+{
+	memset(fh, 0, sizeof(Store_header));
+	memcpy(fh->magic, PS_MAGIC, sizeof(fh->magic));
+	fh->byte_order = PS_BYTE_ORDER;
+	fh->version = PS_VERSION;
+}
+
+/**
+ * Indexes the records appended since the last scan, stopping at the
+ * first one that is not all there yet.
+ */
+static void scan(Parse_store *ps)
+{
+	Store_header fh;
+	Record_header rh;
+	struct stat st;
+	const char *payload;
+
+	if (ps->bad || (fstat(ps->fd, &st) != 0)) return;
+	if (((size_t) st.st_size != ps->map_len) && !remap(ps, st.st_size)) return;
+
+	if (ps->scanned == 0) {
+		if (ps->map_len < sizeof(Store_header)) return;
+		make_store_header(&fh);
+		if (memcmp(ps->map, &fh, sizeof(Store_header)) != 0) {
+			ps->bad = TRUE;
+			return;
+		}
+		ps->scanned = sizeof(Store_header);
+	}
+
+	while (ps->map_len - ps->scanned >= sizeof(Record_header)) {
+		memcpy(&rh, ps->map + ps->scanned, sizeof(Record_header));
+		if ((rh.magic != PS_RECORD_MAGIC) || (rh.size < 0) ||
+			(rh.size % sizeof(int) != 0) ||
+			((size_t) rh.size > ps->map_len - ps->scanned - sizeof(Record_header))) break;
+		payload = ps->map + ps->scanned + sizeof(Record_header);
+		if (parse_cache_hash_key(payload, rh.size) != rh.checksum) break;
+		if (rh.identity == ps->identity) index_add(ps, rh.hash, ps->scanned);
+		ps->scanned += sizeof(Record_header) + rh.size;
+	}
+}
+
+/***************************************************************
+*
+* Stores
+*
+****************************************************************/
+
+/**
+ * Starts a new store in a file that is empty, or holds the start of a
+ * header whose writer died.  Anything else is left alone.
+ */
+static int write_store_header(int fd, off_t size)
+{
+	Store_header fh, old;
+
+	make_store_header(&fh);
+	if (size > 0) {
+		if (pread(fd, &old, size, 0) != size) return FALSE;
+		if (memcmp(&old, &fh, size) != 0) return FALSE;
+		if (ftruncate(fd, 0) != 0) return FALSE;
+	}
+	return (write(fd, &fh, sizeof(Store_header)) == sizeof(Store_header));
+}
+
+/**
+ * Opens the store in the file at path, creating it if need be.  The
+ * store can be added to only if this is the one process holding the
+ * file for writing; otherwise it is read only.  Returns NULL if the
+ * file cannot be opened or is not a parse store.
+ */
+Parse_store * parse_store_open(const char *path, unsigned int identity)
+{
+	Parse_store *ps;
+	struct stat st;
+	int fd, writable;
+
+	writable = TRUE;
+	fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+	if (fd < 0) {
+		writable = FALSE;
+		fd = open(path, O_RDONLY);
+		if (fd < 0) return NULL;
+	}
+	if (writable && (flock(fd, LOCK_EX | LOCK_NB) != 0)) writable = FALSE;
+
+	ps = (Parse_store *) exalloc(sizeof(Parse_store));
+	ps->fd = fd;
+	ps->writable = writable;
+	ps->bad = FALSE;
+	ps->identity = identity;
+	ps->map = NULL;
+	ps->map_len = 0;
+	ps->scanned = 0;
+	ps->N_records = 0;
+	ps->hits = 0;
+	alloc_index(ps, PS_INITIAL_TABLE_SIZE);
+
+	if (writable && (fstat(fd, &st) == 0) && (st.st_size < (off_t) sizeof(Store_header))) {
+		if (!write_store_header(fd, st.st_size)) ps->bad = TRUE;
+	}
+	scan(ps);
+	if (ps->bad) {
+		parse_store_delete(ps);
+		return NULL;
+	}
+
+	/* Cut off what a writer that died left half written */
+	if (writable && (fstat(fd, &st) == 0) && (st.st_size > ps->scanned)) {
+		if (ftruncate(fd, ps->scanned) == 0) remap(ps, ps->scanned);
+	}
+	return ps;
+}
+
+void parse_store_delete(Parse_store *ps)
+{
+	if (ps == NULL) return;
+	if (ps->map != NULL) munmap(ps->map, ps->map_len);
+	close(ps->fd);
+	free_index(ps);
+	exfree(ps, sizeof(Parse_store));
+}
+
+int parse_store_writable(Parse_store *ps)
+{
+	return ps->writable;
+}
+
+/**
+ * Returns the entry saved for this sentence parsed with these options
+ * by this dictionary, with a reference held for the caller, or NULL.
+ */
+Parse_cache_entry * parse_store_lookup(Parse_store *ps, Sentence sent, Parse_Options opts)
+{
+	Parse_cache_entry *e;
+	Record_header rh;
+	const char *payload;
+	unsigned int hash;
+	char *key;
+	int i, len;
+
+	key = parse_cache_key(sent, opts, &len);
+	hash = parse_cache_hash_key(key, len);
+	e = NULL;
+
+	LOCK_STORE();
+	scan(ps);
+	for (i = hash & (ps->table_size-1); ps->offset[i] >= 0; i = (i+1) & (ps->table_size-1)) {
+		if (ps->hash[i] != hash) continue;
+		memcpy(&rh, ps->map + ps->offset[i], sizeof(Record_header));
+		payload = ps->map + ps->offset[i] + sizeof(Record_header);
+		if (!parse_cache_saved_key_matches(payload, rh.size, key, len)) continue;
+		e = parse_cache_entry_deserialize(payload, rh.size);
+		if (e != NULL) {
+			ps->hits++;
+			break;
+		}
+	}
+	UNLOCK_STORE();
+
+	exfree(key, len);
+	return e;
+}
+
+/**
+ * Appends the entry to the store, unless it is there already or the
+ * store is read only.
+ */
+void parse_store_save(Parse_store *ps, Parse_cache_entry *e)
+{
+	Record_header rh;
+	struct stat st;
+	char *payload, *buf;
+	int size, n;
+
+	if (!ps->writable || parse_cache_entry_set_saved(e)) return;
+
+	payload = parse_cache_entry_serialize(e, &size);
+	n = sizeof(Record_header) + size;
+	buf = (char *) exalloc(n);
+	rh.magic = PS_RECORD_MAGIC;
+	rh.size = size;
+	rh.identity = ps->identity;
+	rh.hash = parse_cache_entry_hash(e);
+	rh.checksum = parse_cache_hash_key(payload, size);
+	rh.pad = 0;
+	memcpy(buf, &rh, sizeof(Record_header));
+	memcpy(buf + sizeof(Record_header), payload, size);
+	exfree(payload, size);
+
+	LOCK_STORE();
+	if (fstat(ps->fd, &st) == 0) {
+		/* Readers skip a short record anyway, but don't leave one
+		   in front of the next. */
+		if (write(ps->fd, buf, n) != n) {
+			if (ftruncate(ps->fd, st.st_size) != 0) ps->writable = FALSE;
+		}
+	}
+	UNLOCK_STORE();
+
+	exfree(buf, n);
+}
+
+static long store_stat(Parse_store *ps, const long *field)
+{
+	long val;
+	LOCK_STORE();
+	scan(ps);
+	val = *field;
+	UNLOCK_STORE();
+	return val;
+}
+
+#else /* _WIN32 */
+
+struct Parse_store_s {
+	int  writable;
+	long N_records;
+	long hits;
+};
+
+#define store_stat(ps, field) (*(field))
+
+Parse_store * parse_store_open(const char *path, unsigned int identity)
+{
+	return NULL;
+}
+
+void parse_store_delete(Parse_store *ps)
+{
+}
+
+int parse_store_writable(Parse_store *ps)
+{
+	return FALSE;
+}
+
+Parse_cache_entry * parse_store_lookup(Parse_store *ps, Sentence sent, Parse_Options opts)
+{
+	return NULL;
+}
+
+void parse_store_save(Parse_store *ps, Parse_cache_entry *e)
+{
+}
+
+#endif /* _WIN32 */
+
+/***************************************************************
+*
+* The public interface
+*
+****************************************************************/
+
+/**
+ * Attaches the parse store in the file at path to the dictionary, in
+ * place of any it had.  Returns 1 if parses will be added to it, 0 if
+ * another process is adding to it so it can only be read, and -1 if it
+ * could not be opened.  Do this before the dictionary is shared
+ * between threads.
+ */
+int dictionary_open_parse_store(Dictionary dict, const char *path)
+{
+	dictionary_close_parse_store(dict);
+	dict->parse_store = parse_store_open(path, dict->identity);
+	if (dict->parse_store == NULL) return -1;
+	return parse_store_writable(dict->parse_store);
+}
+
+void dictionary_close_parse_store(Dictionary dict)
+{
+	parse_store_delete(dict->parse_store);
+	dict->parse_store = NULL;
+}
+
+long dictionary_get_parse_store_hits(Dictionary dict)
+{
+	if (dict->parse_store == NULL) return 0;
+	return store_stat(dict->parse_store, &dict->parse_store->hits);
+}
+
+long dictionary_get_parse_store_records(Dictionary dict)
+{
+	if (dict->parse_store == NULL) return 0;
+	return store_stat(dict->parse_store, &dict->parse_store->N_records);
+}
@@ -0,0 +1,33 @@
+/********************************************************************************/
+/* Copyright (c) 2004                                                           */
+/* Daniel Sleator, David Temperley, and John Lafferty                           */
+/* All rights reserved                                                          */
+/*                                                                              */
+/* Use of the link grammar parsing system is subject to the terms of the        */
+/* license set forth in the LICENSE file included with this software,           */
+/* and also available at http://www.link.cs.cmu.edu/link/license.html           */
+/* This license allows free redistribution and use in source and binary         */
+/* forms, with or without modification, subject to certain conditions.          */
+/*                                                                              */
+/********************************************************************************/
+/**********************************************************************
+  Calling paradigm:
+   . dictionary_open_parse_store() attaches a store to a dictionary.
+   . sentence_parse() calls parse_store_lookup() when the parse cache
+     has nothing for the sentence, and uses the entry it returns the
+     way it would use one from the cache.
+   . When the store can be added to, sentence_parse() builds every
+     linkage of a sentence it has just parsed, so that the entry has
+     all of their images, and calls parse_store_save().
+***********************************************************************/
+
+#ifndef _PARSESTOREH_
+#define _PARSESTOREH_
+
+Parse_store *       parse_store_open(const char *path, unsigned int identity);
+void                parse_store_delete(Parse_store *ps);
+int                 parse_store_writable(Parse_store *ps);
+Parse_cache_entry * parse_store_lookup(Parse_store *ps, Sentence sent, Parse_Options opts);
+void                parse_store_save(Parse_store *ps, Parse_cache_entry *e);
+
+#endif
@@ -17,7 +17,36 @@
 #include <memory.h>
 #include <link-grammar/api.h>
 
-#define PP_MAX_DOMAINS 128
+#define PP_LINK_TYPE_TABLE_SIZE 1024  /* chained, so just needs to be approximate */
+
+/* flags of a pp_link_type: the link sets of the knowledge file it is in */
+#define PP_LT_IGNORE               0x01
+#define PP_LT_DOMAIN_STARTER       0x02
+#define PP_LT_URFL_STARTER         0x04
+#define PP_LT_URFL_ONLY_STARTER    0x08
+#define PP_LT_LEFT_STARTER         0x10
+#define PP_LT_DOMAIN_CONTAINS      0x20
+#define PP_LT_RESTRICTED           0x40
+
+/* The rule bits of a link type are laid out as five bitsets, one bit per
+   rule: contains-one selectors, contains-one link sets, contains-none
+   selectors, contains-none link sets, and must-form-a-cycle link sets. */
+#define PP_WORD_BITS       (8*sizeof(unsigned long))
+#define PP_WORDS(n)        (((n)+PP_WORD_BITS-1)/PP_WORD_BITS)
+#define PP_BIT_SET(b, i)   ((b)[(i)/PP_WORD_BITS] |= 1UL << ((i)%PP_WORD_BITS))
+#define PP_BIT_TEST(b, i)  (((b)[(i)/PP_WORD_BITS] >> ((i)%PP_WORD_BITS)) & 1UL)
+
+#define ONE_SEL(pp, b)     (b)
+#define ONE_SET(pp, b)     ((b) + (pp)->one_words)
+#define NONE_SEL(pp, b)    ((b) + 2*(pp)->one_words)
+#define NONE_SET(pp, b)    ((b) + 2*(pp)->one_words + (pp)->none_words)
+#define CYCLE_SET(pp, b)   ((b) + 2*(pp)->one_words + 2*(pp)->none_words)
+#define RULE_WORDS(pp)     (2*(pp)->one_words + 2*(pp)->none_words + (pp)->cycle_words)
+
+/* the edges of the link graph out of word w */
+#define FIRST_EDGE(ppd, w) ((ppd)->edge + (ppd)->word_start[w])
+#define LAST_EDGE(ppd, w)  ((ppd)->edge + (ppd)->word_start[(w)+1])
+
 
 /***************** utility routines (not exported) ***********************/
 
@@ -45,26 +74,92 @@ static int find_domain_name(Postprocessor *pp, const char *link)
 		}
 }
 
-static int contained_in(Domain * d1, Domain * d2, Sublinkage *sublinkage)
+static int link_type_hash(const char *s)
 {
-	/* returns TRUE if domain d1 is contained in domain d2 */
-	char mark[MAX_LINKS];
-	List_o_links * lol;
-	memset(mark, 0, sublinkage->num_links*(sizeof mark[0]));
-	for (lol=d2->lol; lol != NULL; lol = lol->next)
-		mark[lol->link] = TRUE;
-	for (lol=d1->lol; lol != NULL; lol = lol->next)
-		if (!mark[lol->link]) return FALSE;
-	return TRUE;
+	unsigned int h = 0;
+	for (; *s != '\0'; s++) h = *s + 31*h;
+	return h % PP_LINK_TYPE_TABLE_SIZE;
 }
 
-static int link_in_domain(int link, Domain * d)
+/**
+ * Return the link type of the link name s, matching it against every
+ * link set and rule of the knowledge file the first time it is seen.
+ * From then on, asking whether a link is in a set or is relevant to a
+ * rule is a flag or bit test instead of a string comparison.
+ */
+static pp_link_type * link_type_of(Postprocessor *pp, const char *s)
 {
-	/* returns the predicate "the given link is in the given domain" */
-	List_o_links * lol;
-	for (lol = d->lol; lol != NULL; lol = lol->next)
-		if (lol->link == link) return TRUE;
-	return FALSE;
+	pp_knowledge *k = pp->knowledge;
+	pp_link_type *lt;
+	int h, r;
+
+	h = link_type_hash(s);
+	for (lt = pp->link_type_table[h]; lt != NULL; lt = lt->next)
+		if (strcmp(lt->name, s) == 0) return lt;
+
+	lt = (pp_link_type *) xalloc(sizeof(pp_link_type));
+	lt->name = string_set_add(s, k->string_set);
+	lt->flags = 0;
+	if (pp_linkset_match(k->ignore_these_links, s)) lt->flags |= PP_LT_IGNORE;
+	if (pp_linkset_match(k->domain_starter_links, s)) lt->flags |= PP_LT_DOMAIN_STARTER;
+	if (pp_linkset_match(k->urfl_domain_starter_links, s)) lt->flags |= PP_LT_URFL_STARTER;
+	if (pp_linkset_match(k->urfl_only_domain_starter_links, s)) lt->flags |= PP_LT_URFL_ONLY_STARTER;
+	if (pp_linkset_match(k->left_domain_starter_links, s)) lt->flags |= PP_LT_LEFT_STARTER;
+	if (pp_linkset_match(k->domain_contains_links, s)) lt->flags |= PP_LT_DOMAIN_CONTAINS;
+	if (pp_linkset_match(k->restricted_links, s)) lt->flags |= PP_LT_RESTRICTED;
+	lt->domain = find_domain_name(pp, s);
+
+	lt->bits = (unsigned long *) xalloc(RULE_WORDS(pp)*sizeof(unsigned long));
+	memset(lt->bits, 0, RULE_WORDS(pp)*sizeof(unsigned long));
+	for (r=0; r<k->n_contains_one_rules; r++) {
+		if (post_process_match(k->contains_one_rules[r].selector, s))
+			PP_BIT_SET(ONE_SEL(pp, lt->bits), r);
+		if (string_in_list(s, k->contains_one_rules[r].link_array))
+			PP_BIT_SET(ONE_SET(pp, lt->bits), r);
+	}
+	for (r=0; r<k->n_contains_none_rules; r++) {
+		if (post_process_match(k->contains_none_rules[r].selector, s))
+			PP_BIT_SET(NONE_SEL(pp, lt->bits), r);
+		if (string_in_list(s, k->contains_none_rules[r].link_array))
+			PP_BIT_SET(NONE_SET(pp, lt->bits), r);
+	}
+	for (r=0; r<k->n_form_a_cycle_rules; r++) {
+		if (pp_linkset_match(k->form_a_cycle_rules[r].link_set, s))
+			PP_BIT_SET(CYCLE_SET(pp, lt->bits), r);
+	}
+
+	lt->next = pp->link_type_table[h];
+	pp->link_type_table[h] = lt;
+	return lt;
+}
+
+static void free_link_types(Postprocessor *pp)
+{
+	pp_link_type *lt, *xlt;
+	int h;
+	for (h=0; h<PP_LINK_TYPE_TABLE_SIZE; h++) {
+		for (lt = pp->link_type_table[h]; lt != NULL; lt = xlt) {
+			xlt = lt->next;
+			xfree(lt->bits, RULE_WORDS(pp)*sizeof(unsigned long));
+			xfree(lt, sizeof(pp_link_type));
+		}
+	}
+	xfree(pp->link_type_table, PP_LINK_TYPE_TABLE_SIZE*sizeof(pp_link_type *));
+}
+
+static int contained_in(Postprocessor *pp, Domain * d1, Domain * d2,
+                        Sublinkage *sublinkage)
+{
+	/* returns TRUE if domain d1 is contained in domain d2 */
+	char *mark = pp->pp_data.mark;
+	int *dl = pp->pp_data.domain_links;
+	int i;
+	memset(mark, 0, sublinkage->num_links*(sizeof mark[0]));
+	for (i=d2->first; i<d2->first+d2->size; i++)
+		mark[dl[i]] = TRUE;
+	for (i=d1->first; i<d1->first+d1->size; i++)
+		if (!mark[dl[i]]) return FALSE;
+	return TRUE;
 }
 
 /* #define CHECK_DOMAIN_NESTING */
@@ -77,17 +172,17 @@ static int check_domain_nesting(Postprocessor *pp, int num_links)
 	/* returns TRUE if the domains actually form a properly nested structure */
 	Domain * d1, * d2;
 	int counts[4];
-	char mark[MAX_LINKS];
-	List_o_links * lol;
+	char *mark = pp->pp_data.mark;
+	int *dl = pp->pp_data.domain_links;
 	int i;
 	for (d1=pp->pp_data.domain_array; d1 < pp->pp_data.domain_array + pp->pp_data.N_domains; d1++) {
 		for (d2=d1+1; d2 < pp->pp_data.domain_array + pp->pp_data.N_domains; d2++) {
 			memset(mark, 0, num_links*(sizeof mark[0]));
-			for (lol=d2->lol; lol != NULL; lol = lol->next) {
-		mark[lol->link] = 1;
+			for (i=d2->first; i<d2->first+d2->size; i++) {
+		mark[dl[i]] = 1;
 			}
-			for (lol=d1->lol; lol != NULL; lol = lol->next) {
-		mark[lol->link] += 2;
+			for (i=d1->first; i<d1->first+d1->size; i++) {
+		mark[dl[i]] += 2;
 			}
 			counts[0] = counts[1] = counts[2] = counts[3] = 0;
 			for (i=0; i<num_links; i++)
@@ -101,71 +196,87 @@ static int check_domain_nesting(Postprocessor *pp, int num_links)
 #endif
 
 /** 
- * Free the list of links pointed to by lol
- * (does not free any strings)
+ * Gets called after every invocation of post_process().  The graph and
+ * the domains live in arrays that are reused from one linkage to the
+ * next, so there is nothing to free; this just empties them.
  */
-static void free_List_o_links(List_o_links *lol)
-{
-	List_o_links * xlol;
-	while(lol != NULL) {
-		xlol = lol->next;
-		xfree(lol, sizeof(List_o_links));
-		lol = xlol;
-	}
-}
-
-static void free_D_tree_leaves(DTreeLeaf *dtl)
+void post_process_free_data(PP_data * ppd)
 {
-	DTreeLeaf * xdtl;
-	while(dtl != NULL) {
-		xdtl = dtl->next;
-		xfree(dtl, sizeof(DTreeLeaf));
-		dtl = xdtl;
-	}
+	ppd->N_domains = 0;
+	ppd->N_domain_links = 0;
+	ppd->N_ignored = 0;
 }
 
-/** 
- * Gets called after every invocation of post_process()
+/**
+ * Hand the domains found by the last call to post_process() over to
+ * ppd, in arrays sized to fit.  The graph and the domain forest are
+ * only needed while the rules are being applied, so they stay behind.
  */
-void post_process_free_data(PP_data * ppd)
+void post_process_save_domains(Postprocessor * pp, PP_data * ppd)
 {
-	int w, d;
-	for (w = 0; w < ppd->length; w++)
+	PP_data *src = &pp->pp_data;
+	int d;
+
+	memset(ppd, 0, sizeof(PP_data));
+	if (src->N_domains > 0)
 	{
-		free_List_o_links(ppd->word_links[w]);
-		ppd->word_links[w] = NULL;
+		ppd->domain_array = (Domain *) xalloc(src->N_domains*sizeof(Domain));
+		ppd->da_size = src->N_domains;
+		ppd->N_domains = src->N_domains;
 	}
-	for (d = 0; d < ppd->N_domains; d++)
+	if (src->N_domain_links > 0)
 	{
-		free_List_o_links(ppd->domain_array[d].lol);
-		ppd->domain_array[d].lol = NULL;
-		free_D_tree_leaves(ppd->domain_array[d].child);
-		ppd->domain_array[d].child = NULL;
+		ppd->domain_links = (int *) xalloc(src->N_domain_links*sizeof(int));
+		ppd->dl_size = src->N_domain_links;
+		ppd->N_domain_links = src->N_domain_links;
+		memcpy(ppd->domain_links, src->domain_links, src->N_domain_links*sizeof(int));
 	}
-	free_List_o_links(ppd->links_to_ignore);
-	ppd->links_to_ignore = NULL;
+	for (d = 0; d < src->N_domains; d++)
+	{
+		ppd->domain_array[d] = src->domain_array[d];
+		ppd->domain_array[d].first_leaf = 0;
+		ppd->domain_array[d].N_leaves = 0;
+		ppd->domain_array[d].parent = NULL;
+	}
+	post_process_free_data(src);
+}
+
+/**
+ * Free the domains saved by post_process_save_domains(), and the
+ * arrays that held them.
+ */
+void post_process_free_domains(PP_data * ppd)
+{
+	if (ppd->domain_array != NULL)
+		xfree(ppd->domain_array, ppd->da_size*sizeof(Domain));
+	if (ppd->domain_links != NULL)
+		xfree(ppd->domain_links, ppd->dl_size*sizeof(int));
+	ppd->domain_array = NULL;
+	ppd->domain_links = NULL;
+	ppd->da_size = ppd->dl_size = 0;
+	ppd->N_domains = ppd->N_domain_links = 0;
 }
 
 static void connectivity_dfs(Postprocessor *pp, Sublinkage *sublinkage,
                              int w, pp_linkset *ls)
 {
-	List_o_links *lol;
+	PP_edge *e;
 	pp->visited[w] = TRUE;
-	for (lol = pp->pp_data.word_links[w]; lol != NULL; lol = lol->next)
+	for (e = FIRST_EDGE(&pp->pp_data, w); e < LAST_EDGE(&pp->pp_data, w); e++)
 	{
-		if (!pp->visited[lol->word] &&
-				!pp_linkset_match(ls, sublinkage->link[lol->link]->name))
-			connectivity_dfs(pp, sublinkage, lol->word, ls);
+		if (!pp->visited[e->word] &&
+				!pp_linkset_match(ls, sublinkage->link[e->link]->name))
+			connectivity_dfs(pp, sublinkage, e->word, ls);
 	}
 }
 
 static void mark_reachable_words(Postprocessor *pp, int w)
 {
-	List_o_links *lol;
+	PP_edge *e;
 	if (pp->visited[w]) return;
 	pp->visited[w] = TRUE;
-	for (lol = pp->pp_data.word_links[w]; lol != NULL; lol = lol->next)
-		mark_reachable_words(pp, lol->word);
+	for (e = FIRST_EDGE(&pp->pp_data, w); e < LAST_EDGE(&pp->pp_data, w); e++)
+		mark_reachable_words(pp, e->word);
 }
 
 static int is_connected(Postprocessor *pp)
@@ -175,7 +286,7 @@ static int is_connected(Postprocessor *pp)
 		 not to be thrown out. */
 	int i;
 	for (i=0; i<pp->pp_data.length; i++)
-		pp->visited[i] = (pp->pp_data.word_links[i] == NULL);
+		pp->visited[i] = (FIRST_EDGE(&pp->pp_data, i) == LAST_EDGE(&pp->pp_data, i));
 	mark_reachable_words(pp, 0);
 	for (i=0; i<pp->pp_data.length; i++)
 		if (!pp->visited[i]) return FALSE;
@@ -186,16 +297,26 @@ static int is_connected(Postprocessor *pp)
 static void build_type_array(Postprocessor *pp)
 {
 	D_type_list * dtl;
-	int d;
-	List_o_links * lol;
+	int d, i, *dl = pp->pp_data.domain_links;
+
+	/* One entry for every domain a link is in; they all come from a pool
+	   kept by the postprocessor, which is why callers copy them. */
+	if (pp->pp_data.N_domain_links > pp->dtp_size)
+	{
+		if (pp->d_type_pool != NULL)
+			xfree(pp->d_type_pool, pp->dtp_size*sizeof(D_type_list));
+		pp->dtp_size = pp->pp_data.N_domain_links;
+		pp->d_type_pool = (D_type_list *) xalloc(pp->dtp_size*sizeof(D_type_list));
+	}
+	dtl = pp->d_type_pool;
 	for (d=0; d<pp->pp_data.N_domains; d++)
 	{
-		for (lol=pp->pp_data.domain_array[d].lol; lol != NULL; lol = lol->next)
+		Domain *dom = &pp->pp_data.domain_array[d];
+		for (i=dom->first; i<dom->first+dom->size; i++, dtl++)
 		{
-			dtl = (D_type_list *) xalloc(sizeof(D_type_list));
-			dtl->next = pp->pp_node->d_type_array[lol->link];
-			pp->pp_node->d_type_array[lol->link] = dtl;
-			dtl->type = pp->pp_data.domain_array[d].type;
+			dtl->next = pp->pp_node->d_type_array[dl[i]];
+			pp->pp_node->d_type_array[dl[i]] = dtl;
+			dtl->type = dom->type;
 		}
 	}
 }
@@ -230,36 +351,181 @@ D_type_list * copy_d_type(D_type_list * dtl)
 	return dtlhead;
 }
 
-/** free the pp node from last time */
+/** free the pp node, along with the pool its type lists come from */
 static void free_pp_node(Postprocessor *pp)
 {
-	int i;
 	PP_node *ppn = pp->pp_node;
 	pp->pp_node = NULL;
+	if (pp->d_type_pool != NULL)
+		xfree(pp->d_type_pool, pp->dtp_size*sizeof(D_type_list));
+	pp->d_type_pool = NULL;
+	pp->dtp_size = 0;
 	if (ppn == NULL) return;
 
-	for (i=0; i<MAX_LINKS; i++)
+	if (ppn->d_type_array != NULL)
+		xfree((void*) ppn->d_type_array, pp->pp_node_size*sizeof(D_type_list *));
+	xfree((void*) ppn, sizeof(PP_node));
+	pp->pp_node_size = 0;
+}
+
+/**
+ * Clear out the pp node from last time for a linkage with num_links
+ * links, making it bigger first if need be.
+ */
+static void reset_pp_node(Postprocessor *pp, int num_links)
+{
+	PP_node *ppn;
+	int i;
+
+	if (pp->pp_node == NULL)
 	{
-		free_d_type(ppn->d_type_array[i]);
+		pp->pp_node = (PP_node *) xalloc(sizeof(PP_node));
+		pp->pp_node->d_type_array = NULL;
+		pp->pp_node_size = 0;
 	}
-	xfree((void*) ppn, sizeof(PP_node));
+	ppn = pp->pp_node;
+	if (num_links > pp->pp_node_size)
+	{
+		if (ppn->d_type_array != NULL)
+			xfree((void*) ppn->d_type_array, pp->pp_node_size*sizeof(D_type_list *));
+		ppn->d_type_array = (D_type_list **) xalloc(num_links*sizeof(D_type_list *));
+		pp->pp_node_size = num_links;
+	}
+	ppn->violation = NULL;
+	ppn->num_links = num_links;
+	for (i=0; i<num_links; i++)
+		ppn->d_type_array[i] = NULL;
+}
+
+/**
+ * Make sure the graph and domain arrays of the postprocessor are big
+ * enough for this sentence and sublinkage.  The arrays only ever grow,
+ * and are reused from one linkage to the next, so that post-processing
+ * a linkage does not normally allocate anything.
+ */
+static void size_pp_data(Postprocessor *pp, int length, int num_links)
+{
+	PP_data *ppd = &pp->pp_data;
+
+	if (length+1 > ppd->ws_size)
+	{
+		if (ppd->word_start != NULL)
+		{
+			xfree(ppd->word_start, ppd->ws_size*sizeof(int));
+			xfree(pp->visited, ppd->ws_size*sizeof(int));
+		}
+		ppd->ws_size = length+1;
+		ppd->word_start = (int *) xalloc(ppd->ws_size*sizeof(int));
+		pp->visited = (int *) xalloc(ppd->ws_size*sizeof(int));
+	}
+
+	/* Every domain is started by a distinct link, and a link has an edge
+	   at either end. */
+	if (num_links > ppd->link_size)
+	{
+		if (ppd->edge != NULL)
+		{
+			xfree(ppd->edge, 2*ppd->link_size*sizeof(PP_edge));
+			xfree(ppd->links_to_ignore, ppd->link_size*sizeof(int));
+			xfree(ppd->leaf_links, ppd->link_size*sizeof(int));
+			xfree(ppd->mark, ppd->link_size*sizeof(char));
+			xfree(ppd->domain_array, ppd->da_size*sizeof(Domain));
+			xfree(pp->link_type, ppd->link_size*sizeof(pp_link_type *));
+		}
+		ppd->link_size = ppd->da_size = num_links;
+		ppd->edge = (PP_edge *) xalloc(2*num_links*sizeof(PP_edge));
+		ppd->links_to_ignore = (int *) xalloc(num_links*sizeof(int));
+		ppd->leaf_links = (int *) xalloc(num_links*sizeof(int));
+		ppd->mark = (char *) xalloc(num_links*sizeof(char));
+		ppd->domain_array = (Domain *) xalloc(num_links*sizeof(Domain));
+		pp->link_type = (pp_link_type **) xalloc(num_links*sizeof(pp_link_type *));
+	}
+	post_process_free_data(ppd);
 }
 
+static void free_pp_data(Postprocessor *pp)
+{
+	PP_data *ppd = &pp->pp_data;
+
+	if (ppd->word_start != NULL)
+	{
+		xfree(ppd->word_start, ppd->ws_size*sizeof(int));
+		xfree(pp->visited, ppd->ws_size*sizeof(int));
+	}
+	if (ppd->edge != NULL)
+	{
+		xfree(ppd->edge, 2*ppd->link_size*sizeof(PP_edge));
+		xfree(ppd->links_to_ignore, ppd->link_size*sizeof(int));
+		xfree(ppd->leaf_links, ppd->link_size*sizeof(int));
+		xfree(ppd->mark, ppd->link_size*sizeof(char));
+		xfree(ppd->domain_array, ppd->da_size*sizeof(Domain));
+		xfree(pp->link_type, ppd->link_size*sizeof(pp_link_type *));
+	}
+	if (ppd->domain_links != NULL)
+		xfree(ppd->domain_links, ppd->dl_size*sizeof(int));
+}
 
-/** set up a fresh pp_node for later use */
-static void alloc_pp_node(Postprocessor *pp)
+/** Look up the type of every link of the sublinkage */
+static void find_link_types(Postprocessor *pp, Sublinkage *sublinkage)
 {
 	int i;
-	pp->pp_node=(PP_node *) xalloc(sizeof(PP_node));
-	pp->pp_node->violation = NULL;
-	for (i=0; i<MAX_LINKS; i++)
-		pp->pp_node->d_type_array[i] = NULL;
+	for (i=0; i<sublinkage->num_links; i++)
+	{
+		if (sublinkage->link[i]->l == -1)
+			pp->link_type[i] = NULL;
+		else
+			pp->link_type[i] = link_type_of(pp, sublinkage->link[i]->name);
+	}
 }
 
-static void reset_pp_node(Postprocessor *pp)
+/**
+ * Work out, for all of the contains rules at once, which of them the
+ * domains of this linkage violate.  A contains-one rule is violated by
+ * a domain whose leaves hold its selector but nothing from its link
+ * set, and a contains-none rule by one whose leaves hold its selector
+ * and something from its link set.
+ */
+static void find_violated_rules(Postprocessor *pp)
 {
-	free_pp_node(pp);
-	alloc_pp_node(pp);
+	unsigned long *b = pp->domain_bits, *v = pp->violated, *t;
+	Domain *dom;
+	int d, i, j;
+
+	memset(v, 0, (pp->one_words + pp->none_words)*sizeof(unsigned long));
+	for (d=0; d<pp->pp_data.N_domains; d++)
+	{
+		dom = &pp->pp_data.domain_array[d];
+		memset(b, 0, RULE_WORDS(pp)*sizeof(unsigned long));
+		for (j=dom->first_leaf; j<dom->first_leaf+dom->N_leaves; j++)
+		{
+			t = pp->link_type[pp->pp_data.leaf_links[j]]->bits;
+			for (i=0; i<RULE_WORDS(pp); i++) b[i] |= t[i];
+		}
+		for (i=0; i<pp->one_words; i++)
+			v[i] |= ONE_SEL(pp, b)[i] & ~ONE_SET(pp, b)[i];
+		for (i=0; i<pp->none_words; i++)
+			v[pp->one_words+i] |= NONE_SEL(pp, b)[i] & NONE_SET(pp, b)[i];
+	}
+}
+
+/**
+ * Like find_violated_rules(), for the contains-one rules applied to the
+ * linkage as a whole rather than to each domain.
+ */
+static void find_globally_violated_rules(Postprocessor *pp, Sublinkage *sublinkage)
+{
+	unsigned long *b = pp->domain_bits, *t;
+	int link, i;
+
+	memset(b, 0, 2*pp->one_words*sizeof(unsigned long));
+	for (link=0; link<sublinkage->num_links; link++)
+	{
+		if (pp->link_type[link] == NULL) continue;
+		t = pp->link_type[link]->bits;
+		for (i=0; i<2*pp->one_words; i++) b[i] |= t[i];
+	}
+	for (i=0; i<pp->one_words; i++)
+		pp->violated[i] = ONE_SEL(pp, b)[i] & ~ONE_SET(pp, b)[i];
 }
 
 /************************ rule application *******************************/
@@ -306,30 +572,8 @@ apply_contains_one(Postprocessor *pp, Sublinkage *sublinkage, pp_rule *rule)
 	/* returns TRUE if and only if all groups containing the specified link
 		 contain at least one from the required list.	(as determined by exact
 		 string matching) */
-	DTreeLeaf * dtl;
-	int d, count;
-	for (d=0; d<pp->pp_data.N_domains; d++)
-		{
-			for (dtl = pp->pp_data.domain_array[d].child;
-			 dtl != NULL &&
-				 !post_process_match(rule->selector,
-								 sublinkage->link[dtl->link]->name);
-			 dtl = dtl->next);
-			if (dtl != NULL)
-		{
-			/* selector link of rule appears in this domain */
-			count=0;
-			for (dtl = pp->pp_data.domain_array[d].child; dtl != NULL; dtl = dtl->next)
-				if (string_in_list(sublinkage->link[dtl->link]->name,
-									 rule->link_array))
-					{
-				count=1;
-				break;
-					}
-			if (count == 0) return FALSE;
-		}
-		}
-	return TRUE;
+	int r = rule - pp->knowledge->contains_one_rules;
+	return !PP_BIT_TEST(pp->violated, r);
 }
 
 
@@ -339,25 +583,8 @@ apply_contains_none(Postprocessor *pp,Sublinkage *sublinkage,pp_rule *rule)
 	/* returns TRUE if and only if:
 		 all groups containing the selector link do not contain anything
 		 from the link_array contained in the rule. Uses exact string matching. */
-	DTreeLeaf * dtl;
-	int d;
-	for (d=0; d<pp->pp_data.N_domains; d++)
-		{
-			for (dtl = pp->pp_data.domain_array[d].child;
-			 dtl != NULL &&
-				 !post_process_match(rule->selector,
-								 sublinkage->link[dtl->link]->name);
-			 dtl = dtl->next);
-			if (dtl != NULL)
-		{
-			/* selector link of rule appears in this domain */
-			for (dtl = pp->pp_data.domain_array[d].child; dtl != NULL; dtl = dtl->next)
-				if (string_in_list(sublinkage->link[dtl->link]->name,
-									 rule->link_array))
-					return FALSE;
-		}
-		}
-	return TRUE;
+	int r = rule - pp->knowledge->contains_none_rules;
+	return !PP_BIT_TEST(pp->violated + pp->one_words, r);
 }
 
 static int
@@ -366,25 +593,8 @@ apply_contains_one_globally(Postprocessor *pp,Sublinkage *sublinkage,pp_rule *ru
 	/* returns TRUE if and only if
 		 (1) the sentence doesn't contain the selector link for the rule, or
 		 (2) it does, and it also contains one or more from the rule's link set */
-
-	int i,j,count;
-	for (i=0; i<sublinkage->num_links; i++) {
-		if (sublinkage->link[i]->l == -1) continue;
-		if (post_process_match(rule->selector,sublinkage->link[i]->name)) break;
-	}
-	if (i==sublinkage->num_links) return TRUE;
-
-	/* selector link of rule appears in sentence */
-	count=0;
-	for (j=0; j<sublinkage->num_links && count==0; j++) {
-		if (sublinkage->link[j]->l == -1) continue;
-		if (string_in_list(sublinkage->link[j]->name, rule->link_array))
-			{
-		count=1;
-		break;
-			}
-	}
-	if (count==0) return FALSE; else return TRUE;
+	int r = rule - pp->knowledge->contains_one_rules;
+	return !PP_BIT_TEST(pp->violated, r);
 }
 
 static int
@@ -427,11 +637,11 @@ apply_connected_without(Postprocessor *pp,Sublinkage *sublinkage,pp_rule *rule)
 static void reachable_without_dfs(Postprocessor *pp, Sublinkage *sublinkage, int a, int b, int w) {
 		 /* This is a depth first search of words reachable from w, excluding any direct edge
 		between word a and word b. */
-		List_o_links *lol;
+		PP_edge *e;
 		pp->visited[w] = TRUE;
-		for (lol = pp->pp_data.word_links[w]; lol != NULL; lol = lol->next) {
-		if (!pp->visited[lol->word] && !(w == a && lol->word == b) && ! (w == b && lol->word == a)) {
-				reachable_without_dfs(pp, sublinkage, a, b, lol->word);
+		for (e = FIRST_EDGE(&pp->pp_data, w); e < LAST_EDGE(&pp->pp_data, w); e++) {
+		if (!pp->visited[e->word] && !(w == a && e->word == b) && ! (w == b && e->word == a)) {
+				reachable_without_dfs(pp, sublinkage, a, b, e->word);
 		}
 		}
 }
@@ -446,25 +656,26 @@ static void reachable_without_dfs(Postprocessor *pp, Sublinkage *sublinkage, int
 static int
 apply_must_form_a_cycle(Postprocessor *pp,Sublinkage *sublinkage,pp_rule *rule)
 {
-	List_o_links *lol;
-	int w;
+	PP_edge *e;
+	int i, link, w, r = rule - pp->knowledge->form_a_cycle_rules;
 	for (w=0; w<pp->pp_data.length; w++) {
-		for (lol = pp->pp_data.word_links[w]; lol != NULL; lol = lol->next) {
-				if (w > lol->word) continue;	/* only consider each edge once */
-				if (!pp_linkset_match(rule->link_set, sublinkage->link[lol->link]->name)) continue;
+		for (e = FIRST_EDGE(&pp->pp_data, w); e < LAST_EDGE(&pp->pp_data, w); e++) {
+				if (w > e->word) continue;	/* only consider each edge once */
+				if (!PP_BIT_TEST(CYCLE_SET(pp, pp->link_type[e->link]->bits), r)) continue;
 				memset(pp->visited, 0, pp->pp_data.length*(sizeof pp->visited[0]));
-				reachable_without_dfs(pp, sublinkage, w, lol->word, w);
-				if (!pp->visited[lol->word]) return FALSE;
+				reachable_without_dfs(pp, sublinkage, w, e->word, w);
+				if (!pp->visited[e->word]) return FALSE;
 		}
 	}
 
-	for (lol = pp->pp_data.links_to_ignore; lol != NULL; lol = lol->next) {
-		w = sublinkage->link[lol->link]->l;
-		/* (w, lol->word) are the left and right ends of the edge we're considering */
-		if (!pp_linkset_match(rule->link_set, sublinkage->link[lol->link]->name)) continue;
+	for (i=0; i<pp->pp_data.N_ignored; i++) {
+		link = pp->pp_data.links_to_ignore[i];
+		w = sublinkage->link[link]->l;
+		/* (w, r) are the left and right ends of the edge we're considering */
+		if (!PP_BIT_TEST(CYCLE_SET(pp, pp->link_type[link]->bits), r)) continue;
 		memset(pp->visited, 0, pp->pp_data.length*(sizeof pp->visited[0]));
-		reachable_without_dfs(pp, sublinkage, w, lol->word, w);
-		if (!pp->visited[lol->word]) return FALSE;
+		reachable_without_dfs(pp, sublinkage, w, sublinkage->link[link]->r, w);
+		if (!pp->visited[sublinkage->link[link]->r]) return FALSE;
 	}
 
 	return TRUE;
@@ -478,14 +689,15 @@ apply_bounded(Postprocessor *pp,Sublinkage *sublinkage,pp_rule *rule)
 	/* Checks to see that all domains with this name have the property that
 		 all of the words that touch a link in the domain are not to the left
 		 of the root word of the domain. */
-	int d, lw, d_type;
-	List_o_links * lol;
+	int d, i, lw, d_type;
+	Domain *dom;
 	d_type = rule->domain;
 	for (d=0; d<pp->pp_data.N_domains; d++) {
-		if (pp->pp_data.domain_array[d].type != d_type) continue;
-		lw = sublinkage->link[pp->pp_data.domain_array[d].start_link]->l;
-		for (lol = pp->pp_data.domain_array[d].lol; lol != NULL; lol = lol->next) {
-			if (sublinkage->link[lol->link]->l < lw) return FALSE;
+		dom = &pp->pp_data.domain_array[d];
+		if (dom->type != d_type) continue;
+		lw = sublinkage->link[dom->start_link]->l;
+		for (i=dom->first; i<dom->first+dom->size; i++) {
+			if (sublinkage->link[pp->pp_data.domain_links[i]]->l < lw) return FALSE;
 		}
 	}
 	return TRUE;
@@ -495,38 +707,45 @@ apply_bounded(Postprocessor *pp,Sublinkage *sublinkage,pp_rule *rule)
 
 static void build_graph(Postprocessor *pp, Sublinkage *sublinkage)
 {
-	/* fill in the pp->pp_data.word_links array with a list of words neighboring each
-		 word (actually a list of links).	The dir fields are not set, since this
-		 (after fat-link-extraction) is an undirected graph. */
-	int i, link;
-	List_o_links * lol;
-
-	for (i=0; i<pp->pp_data.length; i++)
-		pp->pp_data.word_links[i] = NULL;
-
+	/* fill in the edges of the (undirected, after fat-link-extraction)
+		 graph of the linkage: the edges out of each word are stored next to
+		 one another, the highest numbered link first. */
+	PP_data *ppd = &pp->pp_data;
+	int *start = ppd->word_start;
+	int w, link, l, r;
+
+	/* count the edges out of each word ... */
+	for (w=0; w<=ppd->length; w++)
+		start[w] = 0;
 	for (link=0; link<sublinkage->num_links; link++)
 		{
 			if (sublinkage->link[link]->l == -1) continue;
-			if (pp_linkset_match(pp->knowledge->ignore_these_links, sublinkage->link[link]->name)) {
-			lol = (List_o_links *) xalloc(sizeof(List_o_links));
-			lol->next = pp->pp_data.links_to_ignore;
-			pp->pp_data.links_to_ignore = lol;
-			lol->link = link;
-			lol->word = sublinkage->link[link]->r;
-			continue;
+			if (pp->link_type[link]->flags & PP_LT_IGNORE) {
+				ppd->links_to_ignore[ppd->N_ignored++] = link;
+				continue;
 			}
+			start[sublinkage->link[link]->l]++;
+			start[sublinkage->link[link]->r]++;
+		}
 
-			lol = (List_o_links *) xalloc(sizeof(List_o_links));
-			lol->next = pp->pp_data.word_links[sublinkage->link[link]->l];
-			pp->pp_data.word_links[sublinkage->link[link]->l] = lol;
-			lol->link = link;
-			lol->word = sublinkage->link[link]->r;
-
-			lol = (List_o_links *) xalloc(sizeof(List_o_links));
-			lol->next = pp->pp_data.word_links[sublinkage->link[link]->r];
-			pp->pp_data.word_links[sublinkage->link[link]->r] = lol;
-			lol->link = link;
-			lol->word = sublinkage->link[link]->l;
+	/* ... make start[w] the end of the edges of word w ... */
+	for (w=1; w<ppd->length; w++)
+		start[w] += start[w-1];
+	start[ppd->length] = (ppd->length > 0) ? start[ppd->length-1] : 0;
+
+	/* ... and fill them in backwards, which leaves start[w] at the first */
+	for (link=0; link<sublinkage->num_links; link++)
+		{
+			if (sublinkage->link[link]->l == -1) continue;
+			if (pp->link_type[link]->flags & PP_LT_IGNORE) continue;
+			l = sublinkage->link[link]->l;
+			r = sublinkage->link[link]->r;
+			start[l]--;
+			ppd->edge[start[l]].link = link;
+			ppd->edge[start[l]].word = r;
+			start[r]--;
+			ppd->edge[start[r]].link = link;
+			ppd->edge[start[r]].word = l;
 		}
 }
 
@@ -536,92 +755,102 @@ static void setup_domain_array(Postprocessor *pp,
 	/* set pp->visited[i] to FALSE */
 	memset(pp->visited, 0, pp->pp_data.length*(sizeof pp->visited[0]));
 	pp->pp_data.domain_array[n].string = string;
-	pp->pp_data.domain_array[n].lol    = NULL;
+	pp->pp_data.domain_array[n].first  = pp->pp_data.N_domain_links;
 	pp->pp_data.domain_array[n].size   = 0;
 	pp->pp_data.domain_array[n].start_link = start_link;
 }
 
 static void add_link_to_domain(Postprocessor *pp, int link)
 {
-	List_o_links *lol;
-	lol = (List_o_links *) xalloc(sizeof(List_o_links));
-	lol->next = pp->pp_data.domain_array[pp->pp_data.N_domains].lol;
-	pp->pp_data.domain_array[pp->pp_data.N_domains].lol = lol;
-	pp->pp_data.domain_array[pp->pp_data.N_domains].size++;
-	lol->link = link;
+	PP_data *ppd = &pp->pp_data;
+	int *dl;
+
+	/* The domains of a linkage are built one after another, each one's
+	   links following the last's.  This is the one array whose size isn't
+	   known beforehand; it keeps what it has when it grows. */
+	if (ppd->N_domain_links == ppd->dl_size)
+	{
+		dl = (int *) xalloc(2*(ppd->dl_size+16)*sizeof(int));
+		if (ppd->domain_links != NULL)
+		{
+			memcpy(dl, ppd->domain_links, ppd->N_domain_links*sizeof(int));
+			xfree(ppd->domain_links, ppd->dl_size*sizeof(int));
+		}
+		ppd->domain_links = dl;
+		ppd->dl_size = 2*(ppd->dl_size+16);
+	}
+	ppd->domain_links[ppd->N_domain_links++] = link;
+	ppd->domain_array[ppd->N_domains].size++;
 }
 
 static void depth_first_search(Postprocessor *pp, Sublinkage *sublinkage,
 									 int w, int root,int start_link)
 {
-	List_o_links *lol;
+	PP_edge *e;
 	pp->visited[w] = TRUE;
-	for (lol = pp->pp_data.word_links[w]; lol != NULL; lol = lol->next) {
-		if (lol->word < w && lol->link != start_link) {
-			add_link_to_domain(pp, lol->link);
+	for (e = FIRST_EDGE(&pp->pp_data, w); e < LAST_EDGE(&pp->pp_data, w); e++) {
+		if (e->word < w && e->link != start_link) {
+			add_link_to_domain(pp, e->link);
 		}
 	}
-	for (lol = pp->pp_data.word_links[w]; lol != NULL; lol = lol->next) {
-		if (!pp->visited[lol->word] && (lol->word != root) &&
-		!(lol->word < root && lol->word < w &&
-					pp_linkset_match(pp->knowledge->restricted_links,
-							 sublinkage->link[lol->link]->name)))
-			depth_first_search(pp, sublinkage, lol->word, root, start_link);
+	for (e = FIRST_EDGE(&pp->pp_data, w); e < LAST_EDGE(&pp->pp_data, w); e++) {
+		if (!pp->visited[e->word] && (e->word != root) &&
+		!(e->word < root && e->word < w &&
+					(pp->link_type[e->link]->flags & PP_LT_RESTRICTED)))
+			depth_first_search(pp, sublinkage, e->word, root, start_link);
 	}
 }
 
 static void bad_depth_first_search(Postprocessor *pp, Sublinkage *sublinkage,
 									 int w, int root, int start_link)
 {
-	List_o_links * lol;
+	PP_edge *e;
 	pp->visited[w] = TRUE;
-	for (lol = pp->pp_data.word_links[w]; lol != NULL; lol = lol->next) {
-		if ((lol->word < w)	&& (lol->link != start_link) && (w != root)) {
-			add_link_to_domain(pp, lol->link);
+	for (e = FIRST_EDGE(&pp->pp_data, w); e < LAST_EDGE(&pp->pp_data, w); e++) {
+		if ((e->word < w)	&& (e->link != start_link) && (w != root)) {
+			add_link_to_domain(pp, e->link);
 		}
 	}
-	for (lol = pp->pp_data.word_links[w]; lol != NULL; lol = lol->next) {
-		if ((!pp->visited[lol->word]) && !(w == root && lol->word < w) &&
-		!(lol->word < root && lol->word < w &&
-					pp_linkset_match(pp->knowledge->restricted_links,
-							 sublinkage->link[lol->link]->name)))
-			bad_depth_first_search(pp, sublinkage, lol->word, root, start_link);
+	for (e = FIRST_EDGE(&pp->pp_data, w); e < LAST_EDGE(&pp->pp_data, w); e++) {
+		if ((!pp->visited[e->word]) && !(w == root && e->word < w) &&
+		!(e->word < root && e->word < w &&
+					(pp->link_type[e->link]->flags & PP_LT_RESTRICTED)))
+			bad_depth_first_search(pp, sublinkage, e->word, root, start_link);
 	}
 }
 
 static void d_depth_first_search(Postprocessor *pp, Sublinkage *sublinkage,
 								 int w, int root, int right, int start_link)
 {
-	List_o_links * lol;
+	PP_edge *e;
 	pp->visited[w] = TRUE;
-	for (lol = pp->pp_data.word_links[w]; lol != NULL; lol = lol->next) {
-		if ((lol->word < w) && (lol->link != start_link) && (w != root)) {
-			add_link_to_domain(pp, lol->link);
+	for (e = FIRST_EDGE(&pp->pp_data, w); e < LAST_EDGE(&pp->pp_data, w); e++) {
+		if ((e->word < w) && (e->link != start_link) && (w != root)) {
+			add_link_to_domain(pp, e->link);
 		}
 	}
-	for (lol = pp->pp_data.word_links[w]; lol != NULL; lol = lol->next) {
-		if (!pp->visited[lol->word] && !(w == root && lol->word >= right) &&
-		!(w == root && lol->word < root) &&
-		!(lol->word < root && lol->word < w &&
-					pp_linkset_match(pp->knowledge->restricted_links,
-							 sublinkage->link[lol->link]->name)))
-			d_depth_first_search(pp,sublinkage,lol->word,root,right,start_link);
+	for (e = FIRST_EDGE(&pp->pp_data, w); e < LAST_EDGE(&pp->pp_data, w); e++) {
+		if (!pp->visited[e->word] && !(w == root && e->word >= right) &&
+		!(w == root && e->word < root) &&
+		!(e->word < root && e->word < w &&
+					(pp->link_type[e->link]->flags & PP_LT_RESTRICTED)))
+			d_depth_first_search(pp,sublinkage,e->word,root,right,start_link);
 	}
 }
 
 static void left_depth_first_search(Postprocessor *pp, Sublinkage *sublinkage,
 															 int w, int right,int start_link)
 {
-	List_o_links *lol;
+	PP_edge *e;
 	pp->visited[w] = TRUE;
-	for (lol = pp->pp_data.word_links[w]; lol != NULL; lol = lol->next) {
-		if (lol->word < w && lol->link != start_link) {
-			add_link_to_domain(pp, lol->link);
+	for (e = FIRST_EDGE(&pp->pp_data, w); e < LAST_EDGE(&pp->pp_data, w); e++) {
+		if (e->word < w && e->link != start_link) {
+			add_link_to_domain(pp, e->link);
 		}
 	}
-	for (lol = pp->pp_data.word_links[w]; lol != NULL; lol = lol->next) {
-		if (!pp->visited[lol->word] && (lol->word != right))
-			depth_first_search(pp, sublinkage, lol->word, right, start_link);
+	for (e = FIRST_EDGE(&pp->pp_data, w); e < LAST_EDGE(&pp->pp_data, w); e++) {
+		if (!pp->visited[e->word] && (e->word != right))
+			depth_first_search(pp, sublinkage, e->word, right, start_link);
 	}
 }
 
@@ -630,28 +859,28 @@ static int domain_compare(const Domain * d1, const Domain * d2)
 
 static void build_domains(Postprocessor *pp, Sublinkage *sublinkage)
 {
-	int link, i, d;
+	int link, i, d, f;
 	const char *s;
 	pp->pp_data.N_domains = 0;
 
 	for (link = 0; link<sublinkage->num_links; link++) {
 		if (sublinkage->link[link]->l == -1) continue;
 		s = sublinkage->link[link]->name;
+		f = pp->link_type[link]->flags;
 
-		if (pp_linkset_match(pp->knowledge->ignore_these_links, s)) continue;
-		if (pp_linkset_match(pp->knowledge->domain_starter_links, s))
+		if (f & PP_LT_IGNORE) continue;
+		if (f & PP_LT_DOMAIN_STARTER)
 			{
 		setup_domain_array(pp, pp->pp_data.N_domains, s, link);
-				if (pp_linkset_match(pp->knowledge->domain_contains_links, s))
+				if (f & PP_LT_DOMAIN_CONTAINS)
 			add_link_to_domain(pp, link);
 		depth_first_search(pp,sublinkage,sublinkage->link[link]->r,
 							 sublinkage->link[link]->l, link);
 
 		pp->pp_data.N_domains++;
-				assert(pp->pp_data.N_domains<PP_MAX_DOMAINS, "raise value of PP_MAX_DOMAINS");
 			}
 		else {
-			if (pp_linkset_match(pp->knowledge->urfl_domain_starter_links,s))
+			if (f & PP_LT_URFL_STARTER)
 		{
 			setup_domain_array(pp, pp->pp_data.N_domains, s, link);
 			/* always add the starter link to its urfl domain */
@@ -659,10 +888,9 @@ static void build_domains(Postprocessor *pp, Sublinkage *sublinkage)
 			bad_depth_first_search(pp,sublinkage,sublinkage->link[link]->r,
 								 sublinkage->link[link]->l,link);
 			pp->pp_data.N_domains++;
-			assert(pp->pp_data.N_domains<PP_MAX_DOMAINS,"raise PP_MAX_DOMAINS value");
 		}
 			else
-		if (pp_linkset_match(pp->knowledge->urfl_only_domain_starter_links,s))
+		if (f & PP_LT_URFL_ONLY_STARTER)
 			{
 				setup_domain_array(pp, pp->pp_data.N_domains, s, link);
 				/* do not add the starter link to its urfl_only domain */
@@ -670,17 +898,15 @@ static void build_domains(Postprocessor *pp, Sublinkage *sublinkage)
 								 sublinkage->link[link]->l,
 								 sublinkage->link[link]->r,link);
 				pp->pp_data.N_domains++;
-				assert(pp->pp_data.N_domains<PP_MAX_DOMAINS,"raise PP_MAX_DOMAINS value");
 			}
 		else
-			if (pp_linkset_match(pp->knowledge->left_domain_starter_links,s))
+			if (f & PP_LT_LEFT_STARTER)
 				{
 					setup_domain_array(pp, pp->pp_data.N_domains, s, link);
 					/* do not add the starter link to a left domain */
 					left_depth_first_search(pp,sublinkage, sublinkage->link[link]->l,
 									 sublinkage->link[link]->r,link);
 					pp->pp_data.N_domains++;
-					assert(pp->pp_data.N_domains<PP_MAX_DOMAINS,"raise PP_MAX_DOMAINS value");
 				}
 		}
 	}
@@ -693,7 +919,7 @@ static void build_domains(Postprocessor *pp, Sublinkage *sublinkage)
 
 	/* sanity check: all links in all domains have a legal domain name */
 	for (d=0; d<pp->pp_data.N_domains; d++) {
-		i = find_domain_name(pp, pp->pp_data.domain_array[d].string);
+		i = pp->link_type[pp->pp_data.domain_array[d].start_link]->domain;
 		if (i==-1)
 			 error("\tpost_process: Need an entry for %s in LINK_TYPE_TABLE",
 					 pp->pp_data.domain_array[d].string);
@@ -703,21 +929,22 @@ static void build_domains(Postprocessor *pp, Sublinkage *sublinkage)
 
 static void build_domain_forest(Postprocessor *pp, Sublinkage *sublinkage)
 {
-	int d, d1, link;
-	DTreeLeaf * dtl;
-	if (pp->pp_data.N_domains > 0)
-		pp->pp_data.domain_array[pp->pp_data.N_domains-1].parent = NULL;
-	for (d=0; d < pp->pp_data.N_domains-1; d++) {
-		for (d1 = d+1; d1 < pp->pp_data.N_domains; d1++) {
-			if (contained_in(&pp->pp_data.domain_array[d],&pp->pp_data.domain_array[d1],sublinkage))
+	PP_data *ppd = &pp->pp_data;
+	Domain *dom;
+	int d, d1, i, link, n;
+	if (ppd->N_domains > 0)
+		ppd->domain_array[ppd->N_domains-1].parent = NULL;
+	for (d=0; d < ppd->N_domains-1; d++) {
+		for (d1 = d+1; d1 < ppd->N_domains; d1++) {
+			if (contained_in(pp, &ppd->domain_array[d],&ppd->domain_array[d1],sublinkage))
 		{
-			pp->pp_data.domain_array[d].parent = &pp->pp_data.domain_array[d1];
+			ppd->domain_array[d].parent = &ppd->domain_array[d1];
 			break;
 		}
 		}
-		if (d1 == pp->pp_data.N_domains) {
+		if (d1 == ppd->N_domains) {
 			/* we know this domain is a root of a new tree */
-			pp->pp_data.domain_array[d].parent = NULL;
+			ppd->domain_array[d].parent = NULL;
 			/* It's now ok for this to happen.	It used to do:
 		 printf("I can't find a parent domain for this domain\n");
 		 print_domain(d);
@@ -725,36 +952,33 @@ static void build_domain_forest(Postprocessor *pp, Sublinkage *sublinkage)
 		}
 	}
 	/* the parent links of domain nodes have been established.
-		 now do the leaves */
-	for (d=0; d < pp->pp_data.N_domains; d++) {
-		pp->pp_data.domain_array[d].child = NULL;
-	}
-	for (link=0; link < sublinkage->num_links; link++) {
-		if (sublinkage->link[link]->l == -1) continue; /* probably not necessary */
-		for (d=0; d<pp->pp_data.N_domains; d++) {
-			if (link_in_domain(link, &pp->pp_data.domain_array[d])) {
-		dtl = (DTreeLeaf *) xalloc(sizeof(DTreeLeaf));
-		dtl->link = link;
-		dtl->parent = &pp->pp_data.domain_array[d];
-		dtl->next = pp->pp_data.domain_array[d].child;
-		pp->pp_data.domain_array[d].child = dtl;
-		break;
-			}
+		 now do the leaves: each link hangs off the first (smallest)
+		 domain that contains it */
+	memset(ppd->mark, 0, sublinkage->num_links*(sizeof ppd->mark[0]));
+	for (d=0, n=0; d < ppd->N_domains; d++) {
+		dom = &ppd->domain_array[d];
+		dom->first_leaf = n;
+		for (i=dom->first; i<dom->first+dom->size; i++) {
+			link = ppd->domain_links[i];
+			if (ppd->mark[link]) continue;
+			ppd->mark[link] = TRUE;
+			ppd->leaf_links[n++] = link;
 		}
+		dom->N_leaves = n - dom->first_leaf;
 	}
 }
 
 static int
 internal_process(Postprocessor *pp,Sublinkage *sublinkage,char **msg)
 {
-	int i;
+	find_link_types(pp, sublinkage);
+
 	/* quick test: try applying just the relevant global rules */
+	find_globally_violated_rules(pp, sublinkage);
 	if (!apply_relevant_rules(pp,apply_contains_one_globally,
 								sublinkage,
 								pp->knowledge->contains_one_rules,
 								pp->relevant_contains_one_rules, msg)) {
-		for (i=0; i<pp->pp_data.length; i++)
-			pp->pp_data.word_links[i] = NULL;
 		pp->pp_data.N_domains = 0;
 		return -1;
 	}
@@ -763,6 +987,7 @@ internal_process(Postprocessor *pp,Sublinkage *sublinkage,char **msg)
 	build_graph(pp, sublinkage);
 	build_domains(pp, sublinkage);
 	build_domain_forest(pp, sublinkage);
+	find_violated_rules(pp);
 
 #if defined(CHECK_DOMAIN_NESTING)
 	/* These messages were deemed to not be useful, so
@@ -860,7 +1085,23 @@ Postprocessor * post_process_open(char *path)
 	pp->relevant_contains_one_rules[0]	= -1;
 	pp->relevant_contains_none_rules[0] = -1;	
 	pp->pp_node = NULL;
-	pp->pp_data.links_to_ignore = NULL;
+	pp->visited = NULL;
+	memset(&pp->pp_data, 0, sizeof(PP_data));
+
+	/* link types get their rule bits as they are first seen */
+	pp->one_words = PP_WORDS(pp->knowledge->n_contains_one_rules);
+	pp->none_words = PP_WORDS(pp->knowledge->n_contains_none_rules);
+	pp->cycle_words = PP_WORDS(pp->knowledge->n_form_a_cycle_rules);
+	pp->link_type_table = (pp_link_type **)
+		xalloc(PP_LINK_TYPE_TABLE_SIZE*sizeof(pp_link_type *));
+	memset(pp->link_type_table, 0, PP_LINK_TYPE_TABLE_SIZE*sizeof(pp_link_type *));
+	pp->link_type = NULL;
+	pp->pp_node_size = 0;
+	pp->d_type_pool = NULL;
+	pp->dtp_size = 0;
+	pp->domain_bits = (unsigned long *) xalloc(RULE_WORDS(pp)*sizeof(unsigned long));
+	pp->violated = (unsigned long *)
+		xalloc((pp->one_words + pp->none_words)*sizeof(unsigned long));
 	pp->n_local_rules_firing	= 0;
 	pp->n_global_rules_firing = 0;
 	return pp;
@@ -879,8 +1120,12 @@ void post_process_close(Postprocessor *pp)
 	xfree(pp->relevant_contains_none_rules,
 		(1+pp->knowledge->n_contains_none_rules)
 		*(sizeof pp->relevant_contains_none_rules[0]));
+	free_link_types(pp);
+	xfree(pp->domain_bits, RULE_WORDS(pp)*sizeof(unsigned long));
+	xfree(pp->violated, (pp->one_words + pp->none_words)*sizeof(unsigned long));
 	pp_knowledge_close(pp->knowledge);
 	free_pp_node(pp);
+	free_pp_data(pp);
 	xfree(pp, sizeof(Postprocessor));
 }
 
@@ -895,7 +1140,6 @@ void post_process_close_sentence(Postprocessor *pp)
 	pp->n_global_rules_firing = 0;
 	pp->relevant_contains_one_rules[0]	= -1;
 	pp->relevant_contains_none_rules[0] = -1;	
-	free_pp_node(pp);
 }
 
 void post_process_scan_linkage(Postprocessor *pp, Parse_Options opts,
@@ -930,13 +1174,13 @@ PP_node *post_process(Postprocessor *pp, Parse_Options opts,
 
 	if (pp==NULL) return NULL;
 
-	pp->pp_data.links_to_ignore = NULL;
 	pp->pp_data.length = sent->length;
+	size_pp_data(pp, sent->length, sublinkage->num_links);
 
 	/* In the name of responsible memory management, we retain a copy of the
 	 * returned data structure pp_node as a field in pp, so that we can clear
 	 * it out after every call, without relying on the user to do so. */
-	reset_pp_node(pp);
+	reset_pp_node(pp, sublinkage->num_links);
 
 	/* The first time we see a sentence, prune the rules which we won't be
 	 * needing during postprocessing the linkages of this sentence */
@@ -31,6 +31,8 @@
 /* Postprocessor * post_process_open(char *path);  this is in api-prototypes.h */
 
 void     post_process_free_data(PP_data * ppd);
+void     post_process_save_domains(Postprocessor * pp, PP_data * ppd);
+void     post_process_free_domains(PP_data * ppd);
 void     post_process_close_sentence(Postprocessor *);
 void     post_process_scan_linkage(Postprocessor * pp, Parse_Options opts,
 				   Sentence sent , Sublinkage * sublinkage);
@@ -46,7 +46,6 @@ static void build_deletable(Sentence sent, int has_conjunction) {
 	int i,j,k;
 
 	free_deletable(sent);
-	assert(sent->length < MAX_SENTENCE, "sent->length too big");
 
 	sent->deletable = (char **) xalloc((sent->length+1)*sizeof(char *));
 	sent->deletable++;  /* we need to be able to access the [-1] position in this array */
@@ -91,9 +90,9 @@ void free_effective_dist(Sentence sent) {
 	int w;
 	if (sent->effective_dist != NULL) {
 		for (w=0; w<sent->length; w++) {
-			xfree((char *)sent->effective_dist[w],sizeof(char)*(sent->length+1));
+			xfree((char *)sent->effective_dist[w],sizeof(short)*(sent->length+1));
 		}
-		xfree((char *) sent->effective_dist, sizeof(char *)*(sent->length));
+		xfree((char *) sent->effective_dist, sizeof(short *)*(sent->length));
 		sent->effective_dist = NULL;
 	}
 }
@@ -122,10 +121,10 @@ static void build_effective_dist(Sentence sent, int has_conjunction) {
 	int i, j, diff;
 
 	free_effective_dist(sent);
-	sent->effective_dist = (char **) xalloc((sent->length)*sizeof(char *));
+	sent->effective_dist = (short **) xalloc((sent->length)*sizeof(short *));
 
 	for (i=0; i<sent->length; i++) {
-		sent->effective_dist[i] = (char *) xalloc(sent->length+1);
+		sent->effective_dist[i] = (short *) xalloc(sizeof(short)*(sent->length+1));
 	}
 	for (i=0; i<sent->length; i++) {
 		/* Fill in the silly part */
@@ -254,6 +253,155 @@ void free_sentence_disjuncts(Sentence sent) {
 }
 
 
+/** TRUE if e has a connector pointing in direction dir that matches s */
+static int exp_has_match(Exp * e, int dir, const char * s)
+{
+	E_list * l;
+
+	if (e->type == CONNECTOR_type) {
+		return ((e->dir == dir) && easy_match(e->u.string, s));
+	}
+	for (l = e->u.l; l != NULL; l = l->next) {
+		if (exp_has_match(l->e, dir, s)) return TRUE;
+	}
+	return FALSE;
+}
+
+/**
+ * How many of the connectors of e that point in direction dir could
+ * link to one of the words whose expressions are x.
+ */
+static int exp_links_to(Exp * e, int dir, X_node * x)
+{
+	E_list * l;
+	X_node * y;
+	int n;
+
+	if (e->type == CONNECTOR_type) {
+		if (e->dir != dir) return 0;
+		for (y = x; y != NULL; y = y->next) {
+			if (exp_has_match(y->exp, (dir == '+') ? '-' : '+', e->u.string)) return 1;
+		}
+		return 0;
+	}
+	n = 0;
+	for (l = e->u.l; l != NULL; l = l->next) {
+		n += exp_links_to(l->e, dir, x);
+	}
+	return n;
+}
+
+/**
+ * Ranks one of the categories an unknown word could be, from what it
+ * can see without building any disjuncts: how many of its connectors
+ * could link to the words either side of it, and, for a word that is
+ * capitalized anywhere but at the start, whether it's a noun.
+ */
+static int unknown_category_score(Sentence sent, int w, X_node * x)
+{
+	const char * t;
+	int score;
+
+	score = 0;
+	if (w > 0) score += exp_links_to(x->exp, '-', sent->word[w-1].x);
+	if (w < sent->length-1) score += exp_links_to(x->exp, '+', sent->word[w+1].x);
+	t = strrchr(x->string, '.');
+	if ((w > 1) && is_utf8_upper(sent->word[w].string) &&
+		(t != NULL) && (strcmp(t, ".n") == 0)) {
+		score += 2;
+	}
+	return score;
+}
+
+/**
+ * Cuts the disjuncts of an unknown word down to those of its best
+ * ranked categories, taking them in order of their rank for as long as
+ * there are no more than limit disjuncts in all.  The best one is kept
+ * however many it has.  Returns TRUE if any were cut.
+ */
+static int limit_unknown_word(Sentence sent, int w, int limit)
+{
+	X_node * x;
+	Disjunct *d, *next, *kept;
+	int *score, *count, *keep;
+	int n, i, k, best, total;
+
+	n = 0;
+	for (x = sent->word[w].x; x != NULL; x = x->next) n++;
+	if (n < 2) return FALSE;
+
+	score = (int *) xalloc(3 * n * sizeof(int));
+	count = score + n;
+	keep = count + n;
+	for (x = sent->word[w].x, i = 0; x != NULL; x = x->next, i++) {
+		score[i] = unknown_category_score(sent, w, x);
+		count[i] = 0;
+		keep[i] = FALSE;
+		for (d = sent->word[w].d; d != NULL; d = d->next) {
+			if (d->string == x->string) count[i]++;
+		}
+	}
+
+	/* Keep the best category left while the total allows */
+	total = 0;
+	for (k = 0; k < n; k++) {
+		best = -1;
+		for (i = 0; i < n; i++) {
+			if (!keep[i] && ((best < 0) || (score[i] > score[best]))) best = i;
+		}
+		if ((k > 0) && (total + count[best] > limit)) break;
+		keep[best] = TRUE;
+		total += count[best];
+	}
+
+	kept = NULL;
+	for (d = sent->word[w].d; d != NULL; d = next) {
+		next = d->next;
+		for (x = sent->word[w].x, i = 0; x != NULL; x = x->next, i++) {
+			if (d->string == x->string) break;
+		}
+		if ((x == NULL) || keep[i]) {
+			d->next = kept;
+			kept = d;
+		} else {
+			d->next = NULL;
+			free_disjuncts(d);
+		}
+	}
+	/* put them back in the order they were built in */
+	sent->word[w].d = NULL;
+	for (d = kept; d != NULL; d = next) {
+		next = d->next;
+		d->next = sent->word[w].d;
+		sent->word[w].d = d;
+	}
+
+	xfree(score, 3 * n * sizeof(int));
+	return (k < n);
+}
+
+/**
+ * Limits the disjuncts of the words that weren't in the dictionary,
+ * which get those of every category UNKNOWN-WORD has, to the options'
+ * unknown_word_disjuncts each.  They are known by the "[?]" in their
+ * names.  The number of words that were cut down is left in the
+ * sentence, so that the parser can fall back to the whole of them.
+ */
+static void limit_unknown_words(Sentence sent, Parse_Options opts)
+{
+	int w;
+
+	sent->unknown_words_limited = 0;
+	if (opts->unknown_word_disjuncts <= 0) return;
+	for (w = 0; w < sent->length; w++) {
+		if ((sent->word[w].x == NULL) ||
+			(strstr(sent->word[w].x->string, "[?]") == NULL)) continue;
+		if (limit_unknown_word(sent, w, opts->unknown_word_disjuncts)) {
+			sent->unknown_words_limited++;
+		}
+	}
+}
+
 /**
  * Assumes that the sentence expression lists have been generated.
  * This does all the necessary pruning and building of and structures.
@@ -262,7 +410,11 @@ void prepare_to_parse(Sentence sent, Parse_Options opts)
 {
 	int i, has_conjunction;
 
-	build_sentence_disjuncts(sent, opts->disjunct_cost);
+	if (sent->disjunct_stages != NULL) {
+		stage_sentence_disjuncts(sent, opts->disjunct_cost);
+	} else {
+		build_sentence_disjuncts(sent, opts->disjunct_cost);
+	}
 	if (verbosity > 2) {
 		printf("After expanding expressions into disjuncts:");
 		print_disjunct_counts(sent);
@@ -274,6 +426,8 @@ void prepare_to_parse(Sentence sent, Parse_Options opts)
 	}
 	print_time(opts, "Eliminated duplicate disjuncts");
 
+	limit_unknown_words(sent, opts);
+
 	if (verbosity > 2) {
 		printf("\nAfter expression pruning and duplicate elimination:\n");
 		print_disjunct_counts(sent);
@@ -16,43 +16,47 @@
 
 /* This is a "safe" append function, used here to build up a link diagram
    incrementally.  Because the diagram is built up a few characters at
-   a time, we keep around a pointer to the end of string to prevent
-   the algorithm from being quadratic. */
+   a time, we keep the length of the string, and double its room when it
+   runs out, to keep the algorithm from being quadratic.  Each append is
+   formatted straight into the string, however long it turns out to be. */
 
 String * String_create(void) {
     String * string;
     string = (String *) exalloc(sizeof(String));
     string->allocated = 1;
+    string->len = 0;
     string->p = (char *) exalloc(sizeof(char));
     string->p[0] = '\0';
-    string->eos = string->p;
     return string;
 }
 
 int append_string(String * string, const char *fmt, ...) {
-    char temp_string[1024];
     char * p;
-    int new_size;
+    unsigned int new_size;
+    int n;
     va_list args;
 
     va_start(args, fmt);
-    vsprintf(temp_string, fmt, args); 
+    n = vsnprintf(string->p + string->len, string->allocated - string->len, fmt, args);
     va_end(args);
+    if (n < 0) {
+	string->p[string->len] = '\0';
+	return -1;
+    }
 
-    if (string->allocated <= strlen(string->p)+strlen(temp_string)) {
-	new_size = 2*string->allocated+strlen(temp_string)+1;
+    if (string->len + n >= string->allocated) {
+	new_size = 2*string->allocated + n + 1;
 	p = exalloc(sizeof(char)*new_size);
-	strcpy(p, string->p);
-	strcat(p, temp_string);
+	memcpy(p, string->p, string->len);
 	exfree(string->p, sizeof(char)*string->allocated);
 	string->p = p;
-	string->eos = strchr(p,'\0');
 	string->allocated = new_size;
+
+	va_start(args, fmt);
+	vsnprintf(string->p + string->len, string->allocated - string->len, fmt, args);
+	va_end(args);
     }
-    else {
-	strcat(string->eos, temp_string);
-	string->eos += strlen(temp_string);
-    }
+    string->len += n;
 
     return 0;
 }
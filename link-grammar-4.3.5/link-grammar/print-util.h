@@ -23,8 +23,8 @@
 typedef struct String_s String;
 struct String_s {
     unsigned int allocated;  /* Unsigned so VC++ doesn't complain about comparisons */
+    unsigned int len;        /* strlen(p), kept so appends needn't count it */
     char * p;
-    char * eos;
 };
 
 String * String_create(void);
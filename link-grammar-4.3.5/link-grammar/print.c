@@ -15,34 +15,118 @@
 #include <stdarg.h>
 #include <link-grammar/api.h>
 
-static int center[MAX_SENTENCE];
-static int N_words_to_print;  /* version of N_words in this file for printing links */
 const char * trailer(int mode);
 const char * header(int mode);
 
-static void set_centers(Linkage linkage, int print_word_0)
+/**
+ * The layout of one linkage's diagram.  Each call that prints a
+ * linkage lays it out in one of these of its own, sized to that
+ * linkage, so that no layout is left behind for the next to trip over.
+ */
+typedef struct {
+	int N_words_to_print;  /* version of N_words for printing links */
+	int print_word_0;      /* whether the walls are printed */
+	int print_word_N;
+	int num_words;         /* how many words and links the arrays */
+	int num_links;         /* below have room for */
+	int *center;
+	int *link_heights;     /* tells the height of the links above the sentence */
+	int *row_starts;       /* the word beginning each row of the display */
+	int N_rows;            /* the number of rows */
+} Diagram;
+
+static void set_centers(Diagram * dg, Linkage linkage)
 {
-	int i, len, tot;
+	int i, c, nb, len, tot;
+	const char * s;
 	tot = 0;
-	if (print_word_0) i=0; else i=1;
-	for (; i<N_words_to_print; i++) {
+	if (dg->print_word_0) i=0; else i=1;
+	for (; i<dg->N_words_to_print; i++) {
 		/* Centers obtained by counting the characters, 
 		 * not the bytes in the string.
 		 * len = strlen(linkage->word[i]);
 		 */
-		len = mbstowcs(NULL, linkage->word[i], 0);
-		center[i] = tot + (len/2);
+		len = 0;
+		for (s = linkage->word[i]; (nb = utf8_next(s, &c)) != 0; len++) {
+			s += (nb > 0) ? nb : 1;
+		}
+		dg->center[i] = tot + (len/2);
 		tot += len+1;
 	}
 }
 
-/* the following are all for generating postscript */
-static int link_heights[MAX_LINKS];
-/* tells the height of the links above the sentence */
-static int row_starts[MAX_SENTENCE];
-/* the word beginning each row of the display */
-static int N_rows;
-/* the number of rows */
+/**
+ * Sizes the diagram's arrays to the words and links of this linkage,
+ * and decides whether its walls are to be printed.
+ */
+static void diagram_init(Diagram * dg, Linkage linkage)
+{
+	int j, N_wall_connectors, suppressor_used;
+	Sublinkage *sublinkage=&(linkage->sublinkage[linkage->current]);
+	int N_links = sublinkage->num_links;
+	Link *ppla = sublinkage->link;
+	Dictionary dict = linkage->dict;
+	Parse_Options opts = linkage->opts;
+
+	dg->num_words = linkage->num_words + 1;
+	dg->num_links = N_links;
+	dg->center = (int *) exalloc(dg->num_words*sizeof(int));
+	dg->row_starts = (int *) exalloc(dg->num_words*sizeof(int));
+	dg->link_heights = (int *) exalloc(dg->num_links*sizeof(int));
+	memset(dg->link_heights, 0, dg->num_links*sizeof(int));
+	dg->N_rows = 0;
+
+	dg->print_word_0 = 0;
+	dg->print_word_N = 0;
+
+	N_wall_connectors = 0;
+	if (dict->left_wall_defined) {
+		suppressor_used = FALSE;
+		if (!opts->display_walls) 
+			for (j=0; j<N_links; j++) {
+				if ((ppla[j]->l == 0)) {
+					if (ppla[j]->r == linkage->num_words-1) continue;
+					N_wall_connectors ++;
+					if (strcmp(ppla[j]->lc->string, LEFT_WALL_SUPPRESS)==0){
+						suppressor_used = TRUE;
+					}
+				}
+			}
+		dg->print_word_0 = (((!suppressor_used) && (N_wall_connectors != 0)) 
+						|| (N_wall_connectors > 1) || opts->display_walls);
+	} 
+	else {
+		dg->print_word_0 = TRUE;
+	}
+
+	N_wall_connectors = 0;
+	if (dict->right_wall_defined) {
+		suppressor_used = FALSE;
+		for (j=0; j<N_links; j++) {
+			if (ppla[j]->r == linkage->num_words-1) {
+				N_wall_connectors ++;
+				if (strcmp(ppla[j]->lc->string, RIGHT_WALL_SUPPRESS)==0){
+					suppressor_used = TRUE;
+				}
+			}
+		}
+		dg->print_word_N = (((!suppressor_used) && (N_wall_connectors != 0)) 
+						|| (N_wall_connectors > 1) || opts->display_walls);
+	} 
+	else {
+		dg->print_word_N = TRUE;
+	}
+
+	dg->N_words_to_print = linkage->num_words;
+	if (!dg->print_word_N) dg->N_words_to_print--;
+}
+
+static void diagram_free(Diagram * dg)
+{
+	exfree(dg->center, dg->num_words*sizeof(int));
+	exfree(dg->row_starts, dg->num_words*sizeof(int));
+	exfree(dg->link_heights, dg->num_links*sizeof(int));
+}
 
 /**
  * prints s then prints the last |t|-|s| characters of t.
@@ -63,8 +147,7 @@ static void left_append_string(String * string, const char * s, const char * t)
 
 static void print_a_link(String * s, Linkage linkage, int link)
 {
-	Sentence sent = linkage_get_sentence(linkage);
-	Dictionary dict = sent->dict;
+	Dictionary dict = linkage->dict;
 	int l, r;
 	const char *label, *llabel, *rlabel;
 	
@@ -135,66 +218,32 @@ char * linkage_print_links_and_domains(Linkage linkage)
 	return links_string; 
 }
 
+static void layout_diagram(Diagram * dg, Linkage linkage, String * string);
+
 static char * build_linkage_postscript_string(Linkage linkage) {
 	int link, i,j;
 	int d;
-	int print_word_0 = 0, print_word_N = 0, N_wall_connectors, suppressor_used;
 	Sublinkage *sublinkage=&(linkage->sublinkage[linkage->current]);
 	int N_links = sublinkage->num_links;
 	Link *ppla = sublinkage->link;
 	String  * string;
 	char * ps_string;
-	Dictionary dict = linkage->sent->dict;
-	Parse_Options opts = linkage->opts;
+	Diagram dg;
 
+	/* the link heights and rows come from laying out the diagram */
+	diagram_init(&dg, linkage);
 	string = String_create();
+	layout_diagram(&dg, linkage, string);
+	exfree(string->p, sizeof(char)*string->allocated);
+	exfree(string, sizeof(String));
 
-	N_wall_connectors = 0;
-	if (dict->left_wall_defined) {
-		suppressor_used = FALSE;
-		if (!opts->display_walls) 
-			for (j=0; j<N_links; j++) {
-				if (ppla[j]->l == 0) {
-					if (ppla[j]->r == linkage->num_words-1) continue;
-					N_wall_connectors ++;
-					if (strcmp(ppla[j]->lc->string, LEFT_WALL_SUPPRESS)==0) {
-						suppressor_used = TRUE;
-					}
-				}
-			}
-		print_word_0 = (((!suppressor_used) && (N_wall_connectors != 0)) 
-						|| (N_wall_connectors > 1) || opts->display_walls);
-	} else {
-		print_word_0 = TRUE;
-	}
-
-	N_wall_connectors = 0;
-	if (dict->right_wall_defined) {
-		suppressor_used = FALSE;
-		for (j=0; j<N_links; j++) {
-			if (ppla[j]->r == linkage->num_words-1) {
-				N_wall_connectors ++;
-				if (strcmp(ppla[j]->lc->string, RIGHT_WALL_SUPPRESS)==0){
-					suppressor_used = TRUE;
-				}
-			}
-		}
-		print_word_N = (((!suppressor_used) && (N_wall_connectors != 0)) 
-						|| (N_wall_connectors > 1) || opts->display_walls);
-	} 
-	else {
-		print_word_N = TRUE;
-	}
-
+	string = String_create();
 
-	if (print_word_0) d=0; else d=1;
+	if (dg.print_word_0) d=0; else d=1;
 
 	i = 0;
-	N_words_to_print = linkage->num_words;
-	if (!print_word_N) N_words_to_print--;
-
 	append_string(string, "[");
-	for (j=d; j<N_words_to_print; j++) {
+	for (j=d; j<dg.N_words_to_print; j++) {
 		if ((i%10 == 0) && (i>0)) append_string(string, "\n");
 		i++;
 		append_string(string, "(%s)", linkage->word[j]);
@@ -205,14 +254,14 @@ static char * build_linkage_postscript_string(Linkage linkage) {
 	append_string(string,"[");
 	j = 0;
 	for (link=0; link<N_links; link++) {
-		if (!print_word_0 && (ppla[link]->l == 0)) continue;
-		if (!print_word_N && (ppla[link]->r == linkage->num_words-1)) continue;
+		if (!dg.print_word_0 && (ppla[link]->l == 0)) continue;
+		if (!dg.print_word_N && (ppla[link]->r == linkage->num_words-1)) continue;
 		if (ppla[link]->l == -1) continue;
 		if ((j%7 == 0) && (j>0)) append_string(string,"\n");
 		j++;
 		append_string(string,"[%d %d %d",
 				ppla[link]->l-d, ppla[link]->r-d, 
-				link_heights[link]);
+				dg.link_heights[link]);
 		if (ppla[link]->lc->label < 0) {
 			append_string(string," (%s)]", ppla[link]->name);
 		} else {
@@ -222,11 +271,12 @@ static char * build_linkage_postscript_string(Linkage linkage) {
 	append_string(string,"]");
 	append_string(string,"\n");
 	append_string(string,"[");
-	for (j=0; j<N_rows; j++ ){
-		if (j>0) append_string(string, " %d", row_starts[j]);
-		else append_string(string,"%d", row_starts[j]);
+	for (j=0; j<dg.N_rows; j++ ){
+		if (j>0) append_string(string, " %d", dg.row_starts[j]);
+		else append_string(string,"%d", dg.row_starts[j]);
 	}
 	append_string(string,"]\n");
+	diagram_free(&dg);
 
 	ps_string = exalloc(strlen(string->p)+1);
 	strcpy(ps_string, string->p);
@@ -246,9 +296,11 @@ void compute_chosen_words(Sentence sent, Linkage linkage)
 	const char *t;
 	char * s, *u;
 	Parse_info pi = sent->parse_info;
-	const char * chosen_words[MAX_SENTENCE];
+	const char ** chosen_words;
 	Parse_Options opts = linkage->opts;
 
+	chosen_words = (const char **) xalloc(sent->length*sizeof(const char *));
+
 	for (i=0; i<sent->length; i++) {   /* get rid of those ugly ".Ixx" */
 		chosen_words[i] = sent->word[i].string;
 		if (pi->chosen_disjuncts[i] == NULL) {  
@@ -288,85 +340,71 @@ void compute_chosen_words(Sentence sent, Linkage linkage)
 		strcpy(s, chosen_words[i]);
 		linkage->word[i] = s;
 	}
+	xfree(chosen_words, sent->length*sizeof(const char *));
 }
 
 
-#define MAX_HEIGHT 30
+/**
+ * Makes sure the picture has room for rows rows of stride chars each,
+ * doubling it if not.  New rows are blank.
+ */
+static char * grow_picture(char * picture, int * room, int rows, int stride)
+{
+	char * p;
+	int new_room, row;
 
-static char picture[MAX_HEIGHT][MAX_LINE];
-static char xpicture[MAX_HEIGHT][MAX_LINE];
+	if (rows <= *room) return picture;
+	new_room = 2*(*room);
+	if (new_room < rows) new_room = rows;
+	p = (char *) exalloc(new_room*stride*sizeof(char));
+	if (picture != NULL) {
+		memcpy(p, picture, (*room)*stride*sizeof(char));
+		exfree(picture, (*room)*stride*sizeof(char));
+	}
+	for (row = *room; row < new_room; row++) {
+		memset(p + row*stride, ' ', stride-1);
+		p[row*stride + stride-1] = '\0';
+	}
+	*room = new_room;
+	return p;
+}
 
-/** 
- * String allocated with exalloc.  
- * Needs to be freed with linkage_free_diagram()
+/**
+ * Lays out the diagram of the linkage, and appends it to the string.
+ * The picture is as wide as the words and as high as the links need,
+ * so no linkage is too wide or too high to draw.
  */
-char * linkage_print_diagram(Linkage linkage)
+static void layout_diagram(Diagram * dg, Linkage linkage, String * string)
 {
 	int i, j, k, cl, cr, row, top_row, width, flag;
 	const char *s;
 	char *t;
-	int print_word_0 = 0, print_word_N = 0, N_wall_connectors, suppressor_used;
 	char connector[MAX_TOKEN_LENGTH];
 	int line_len, link_length;
 	Sublinkage *sublinkage=&(linkage->sublinkage[linkage->current]);
 	int N_links = sublinkage->num_links;
 	Link *ppla = sublinkage->link;
-	String * string;
-	char * gr_string;
-	Dictionary dict = linkage->sent->dict;
 	Parse_Options opts = linkage->opts;
 	int x_screen_width = parse_options_get_screen_width(opts);
+	int print_word_0 = dg->print_word_0, print_word_N = dg->print_word_N;
+	int N_words_to_print = dg->N_words_to_print;
+	char *picture, *xpicture, *line;
+	int picture_room, picture_stride, xpicture_rows, xpicture_stride;
 
-	string = String_create();
-
-	N_wall_connectors = 0;
-	if (dict->left_wall_defined) {
-		suppressor_used = FALSE;
-		if (!opts->display_walls) 
-			for (j=0; j<N_links; j++) {
-				if ((ppla[j]->l == 0)) {
-					if (ppla[j]->r == linkage->num_words-1) continue;
-					N_wall_connectors ++;
-					if (strcmp(ppla[j]->lc->string, LEFT_WALL_SUPPRESS)==0){
-						suppressor_used = TRUE;
-					}
-				}
-			}
-		print_word_0 = (((!suppressor_used) && (N_wall_connectors != 0)) 
-						|| (N_wall_connectors > 1) || opts->display_walls);
-	} 
-	else {
-		print_word_0 = TRUE;
-	}
+	set_centers(dg, linkage);
+	line_len = dg->center[N_words_to_print-1]+1;
 
-	N_wall_connectors = 0;
-	if (dict->right_wall_defined) {
-		suppressor_used = FALSE;
-		for (j=0; j<N_links; j++) {
-			if (ppla[j]->r == linkage->num_words-1) {
-				N_wall_connectors ++;
-				if (strcmp(ppla[j]->lc->string, RIGHT_WALL_SUPPRESS)==0){
-					suppressor_used = TRUE;
-				}
-			}
-		}
-		print_word_N = (((!suppressor_used) && (N_wall_connectors != 0)) 
-						|| (N_wall_connectors > 1) || opts->display_walls);
-	} 
-	else {
-		print_word_N = TRUE;
+	/* the words go into one line of xpicture, with a blank after each */
+	width = 0;
+	for (k = (print_word_0 ? 0 : 1); k<N_words_to_print; k++) {
+		width += strlen(linkage->word[k]) + 1;
 	}
 
-	N_words_to_print = linkage->num_words;
-	if (!print_word_N) N_words_to_print--;
-	
-	set_centers(linkage, print_word_0);
-	line_len = center[N_words_to_print-1]+1;
-	
-	for (k=0; k<MAX_HEIGHT; k++) {
-		for (j=0; j<line_len; j++) picture[k][j] = ' ';
-		picture[k][line_len] = '\0';
-	}
+	/* each row of the picture is line_len chars, and a link never
+	 * needs more than one row above the highest one so far */
+	picture_stride = line_len+1;
+	picture_room = 0;
+	picture = grow_picture(NULL, &picture_room, 2, picture_stride);
 	top_row = 0;
 	
 	for (link_length = 1; link_length < N_words_to_print; link_length++) {
@@ -380,32 +418,29 @@ char * linkage_print_diagram(Linkage linkage)
 			/* gets rid of the irrelevant link to the right wall */
 
 			/* put it into the lowest position */
-			cl = center[ppla[j]->l];
-			cr = center[ppla[j]->r];
-			for (row=0; row < MAX_HEIGHT; row++) {
+			cl = dg->center[ppla[j]->l];
+			cr = dg->center[ppla[j]->r];
+			for (row=0; row <= top_row; row++) {
+				line = picture + row*picture_stride;
 				for (k=cl+1; k<cr; k++) {
-					if (picture[row][k] != ' ') break;
+					if (line[k] != ' ') break;
 				}
 				if (k == cr) break;
 			}
 			/* we know it fits, so put it in this row */
 
-			link_heights[j] = row;
+			dg->link_heights[j] = row;
 			
-			if (2*row+2 > MAX_HEIGHT-1) {
-				append_string(string, "The diagram is too high.\n");
-				gr_string = exalloc(strlen(string->p)+1);
-				strcpy(gr_string, string->p);
-				exfree(string->p, sizeof(char)*string->allocated);
-				exfree(string, sizeof(String));
-				return gr_string; 
+			if (row > top_row) {
+				top_row = row;
+				picture = grow_picture(picture, &picture_room, top_row+2, picture_stride);
 			}
-			if (row > top_row) top_row = row;
+			line = picture + row*picture_stride;
 			
-			picture[row][cl] = '+';
-			picture[row][cr] = '+';
+			line[cl] = '+';
+			line[cr] = '+';
 			for (k=cl+1; k<cr; k++) {
-				picture[row][k] = '-';
+				line[k] = '-';
 			}
 			s = ppla[j]->name;
 			
@@ -428,9 +463,9 @@ char * linkage_print_diagram(Linkage linkage)
 			else
 				for (t=connector; isupper((int)*t); t++) k++; /* uppercase len of conn*/
 			if ((cl+cr-k)/2 + 1 <= cl) {
-				t = picture[row] + cl + 1;
+				t = line + cl + 1;
 			} else {
-				t = picture[row] + (cl+cr-k)/2 + 1;
+				t = line + (cl+cr-k)/2 + 1;
 			}
 			s = connector;
 			if (opts->display_link_subscripts)
@@ -440,19 +475,25 @@ char * linkage_print_diagram(Linkage linkage)
 
 			/* now put in the | below this one, where needed */
 			for (k=0; k<row; k++) {
-				if (picture[k][cl] == ' ') {
-					picture[k][cl] = '|';
+				line = picture + k*picture_stride;
+				if (line[cl] == ' ') {
+					line[cl] = '|';
 				}
-				if (picture[k][cr] == ' ') {
-					picture[k][cr] = '|';
+				if (line[cr] == ' ') {
+					line[cr] = '|';
 				}
 			}
 		}
 	}
 	
 	/* we have the link picture, now put in the words and extra "|"s */
+
+	if (opts->display_short) xpicture_rows = top_row+3;
+	else xpicture_rows = 2*top_row+3;
+	xpicture_stride = width+1;
+	xpicture = (char *) exalloc(xpicture_rows*xpicture_stride*sizeof(char));
 	
-	t = xpicture[0];
+	t = xpicture;
 	if (print_word_0) k = 0; else k = 1;
 	for (; k<N_words_to_print; k++) {
 		s = linkage->word[k];
@@ -466,40 +507,44 @@ char * linkage_print_diagram(Linkage linkage)
 	*t = '\0';
 	
 	if (opts->display_short) {
-		for (k=0; picture[0][k] != '\0'; k++) {
-			if ((picture[0][k] == '+') || (picture[0][k] == '|')) {
-				xpicture[1][k] = '|';
+		t = xpicture + xpicture_stride;
+		for (k=0; picture[k] != '\0'; k++) {
+			if ((picture[k] == '+') || (picture[k] == '|')) {
+				t[k] = '|';
 			} else {
-				xpicture[1][k] = ' ';
+				t[k] = ' ';
 			}
 		}
-		xpicture[1][k] = '\0';
+		t[k] = '\0';
 		for (row=0; row < top_row+1; row++) {
-			strcpy(xpicture[row+2],picture[row]);
+			strcpy(xpicture + (row+2)*xpicture_stride, picture + row*picture_stride);
 		}
 		top_row = top_row+2;
 	} else {
 		for (row=0; row < top_row+1; row++) {
-			strcpy(xpicture[2*row+2],picture[row]);
-			for (k=0; picture[row][k] != '\0'; k++) {
-				if ((picture[row][k] == '+') || (picture[row][k] == '|')) {
-					xpicture[2*row+1][k] = '|';
+			line = picture + row*picture_stride;
+			strcpy(xpicture + (2*row+2)*xpicture_stride, line);
+			t = xpicture + (2*row+1)*xpicture_stride;
+			for (k=0; line[k] != '\0'; k++) {
+				if ((line[k] == '+') || (line[k] == '|')) {
+					t[k] = '|';
 				} else {
-					xpicture[2*row+1][k] = ' ';
+					t[k] = ' ';
 				}
 			}
-			xpicture[2*row+1][k] = '\0';
+			t[k] = '\0';
 		}
 		top_row = 2*top_row + 2;
 	}
+	exfree(picture, picture_room*picture_stride*sizeof(char));
 	
 	/* we've built the picture, now print it out */
 	
 	if (print_word_0) i = 0; else i = 1;
 	k = 0;
-	N_rows = 0;
-	row_starts[N_rows] = 0;
-	N_rows++;
+	dg->N_rows = 0;
+	dg->row_starts[dg->N_rows] = 0;
+	dg->N_rows++;
 	while(i < N_words_to_print) {
 		append_string(string, "\n");
 		width = 0;
@@ -508,16 +553,17 @@ char * linkage_print_diagram(Linkage linkage)
 			i++;
 		} while((i<N_words_to_print) &&
 			  (width + ((int)strlen(linkage->word[i]))+1 < x_screen_width));
-		row_starts[N_rows] = i - (!print_word_0);    /* PS junk */
-		if (i<N_words_to_print) N_rows++;     /* same */
+		dg->row_starts[dg->N_rows] = i - (!print_word_0);    /* PS junk */
+		if (i<N_words_to_print) dg->N_rows++;     /* same */
 		for (row = top_row; row >= 0; row--) {
+			line = xpicture + row*xpicture_stride;
 			flag = TRUE;
-			for (j=k;flag&&(j<k+width)&&(xpicture[row][j]!='\0'); j++){
-				flag = flag && (xpicture[row][j] == ' ');
+			for (j=k;flag&&(j<k+width)&&(line[j]!='\0'); j++){
+				flag = flag && (line[j] == ' ');
 			}
 			if (!flag) {
-				for (j=k;(j<k+width)&&(xpicture[row][j]!='\0'); j++){
-					append_string(string, "%c", xpicture[row][j]);
+				for (j=k;(j<k+width)&&(line[j]!='\0'); j++){
+					append_string(string, "%c", line[j]);
 				}
 				append_string(string, "\n");
 			}
@@ -525,6 +571,24 @@ char * linkage_print_diagram(Linkage linkage)
 		append_string(string, "\n");
 		k += width;
 	}
+	exfree(xpicture, xpicture_rows*xpicture_stride*sizeof(char));
+}
+
+/** 
+ * String allocated with exalloc.  
+ * Needs to be freed with linkage_free_diagram()
+ */
+char * linkage_print_diagram(Linkage linkage)
+{
+	String * string;
+	char * gr_string;
+	Diagram dg;
+
+	string = String_create();
+	diagram_init(&dg, linkage);
+	layout_diagram(&dg, linkage, string);
+	diagram_free(&dg);
+
 	gr_string = exalloc(strlen(string->p)+1);
 	strcpy(gr_string, string->p);
 	exfree(string->p, sizeof(char)*string->allocated);
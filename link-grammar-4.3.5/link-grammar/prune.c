@@ -43,11 +43,11 @@ struct c_list_s
 typedef struct power_table_s power_table;
 struct power_table_s
 {
-	int power_table_size;
-	int l_table_size[MAX_SENTENCE];  /* the sizes of the hash tables */
-	int r_table_size[MAX_SENTENCE];
-	C_list ** l_table[MAX_SENTENCE];
-	C_list ** r_table[MAX_SENTENCE];
+	int power_table_size;  /* the number of words, and of each array below */
+	int *l_table_size;     /* the sizes of the hash tables */
+	int *r_table_size;
+	C_list *** l_table;
+	C_list *** r_table;
 };
 
 typedef struct cms_struct Cms;
@@ -70,7 +70,7 @@ struct prune_context_s
 {
 	int null_links;
 	char ** deletable;
-	char ** effective_dist;
+	short ** effective_dist;
 	int power_cost;
 	int power_prune_mode;  /* either GENTLE or RUTHLESS */
 	int N_changed;   /* counts the number of changes
@@ -1176,6 +1176,10 @@ static void power_table_delete(power_table *pt)
 		}
 		xfree((char *)pt->r_table[w], pt->r_table_size[w] * sizeof (C_list *));
 	}
+	xfree(pt->l_table_size, pt->power_table_size * sizeof(int));
+	xfree(pt->r_table_size, pt->power_table_size * sizeof(int));
+	xfree(pt->l_table, pt->power_table_size * sizeof(C_list **));
+	xfree(pt->r_table, pt->power_table_size * sizeof(C_list **));
 	free(pt);
 }
 
@@ -1238,6 +1242,10 @@ static power_table * power_table_new(Sentence sent)
 
 	pt = (power_table *) malloc (sizeof(power_table));
 	pt->power_table_size = sent->length;
+	pt->l_table_size = (int *) xalloc(sent->length * sizeof(int));
+	pt->r_table_size = (int *) xalloc(sent->length * sizeof(int));
+	pt->l_table = (C_list ***) xalloc(sent->length * sizeof(C_list **));
+	pt->r_table = (C_list ***) xalloc(sent->length * sizeof(C_list **));
 
    /* first we initialize the word fields of the connectors, and
 	  eliminate those disjuncts with illegal connectors */
@@ -1525,6 +1533,7 @@ int power_prune(Sentence sent, int mode, Parse_Options opts)
 		for (w = 0; w < sent->length; w++) {
 			if (parse_options_resources_exhausted(opts)) break;
 			for (d = sent->word[w].d; d != NULL; d = d->next) {
+				if (resources_check(opts->resources)) break;
 				if (d->left == NULL) continue;
 				if (left_connector_list_update(pc, d->left, w, w, TRUE) < 0) {
 					for (c=d->left  ;c!=NULL; c = c->next) c->word = BAD_WORD;
@@ -1560,6 +1569,7 @@ int power_prune(Sentence sent, int mode, Parse_Options opts)
 		for (w = sent->length-1; w >= 0; w--) {
 			if (parse_options_resources_exhausted(opts)) break;
 			for (d = sent->word[w].d; d != NULL; d = d->next) {
+				if (resources_check(opts->resources)) break;
 				if (d->right == NULL) continue;
 				if (right_connector_list_update(pc, sent, d->right,w,w,TRUE) >= sent->length){
 					for (c=d->right;c!=NULL; c = c->next) c->word = BAD_WORD;
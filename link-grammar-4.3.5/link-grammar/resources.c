@@ -37,18 +37,49 @@ int getrusage(int who, struct rusage *rusage);
 /* Declaration missing from sys/resource.h in sun operating systems (?) */
 #endif /* __sun__ */
 
-/** returns the current usage time clock in seconds */
+/** returns the CPU time used by this thread, in seconds.  Where
+    there is no clock for the thread alone, it's the CPU time used by
+    the whole process, which other threads' parses count against. */
 static double current_usage_time(void)
 {
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+	struct timespec t;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t) == 0) {
+		return (t.tv_sec + ((double) t.tv_nsec) / 1000000000.0);
+	}
+#endif
 #if !defined(_WIN32)
-	struct rusage u;
-	getrusage (RUSAGE_SELF, &u);
-	return (u.ru_utime.tv_sec + ((double) u.ru_utime.tv_usec) / 1000000.0);
+	{
+		struct rusage u;
+		getrusage (RUSAGE_SELF, &u);
+		return (u.ru_utime.tv_sec + ((double) u.ru_utime.tv_usec) / 1000000.0);
+	}
 #else
 	return ((double) clock())/CLOCKS_PER_SEC;
 #endif
 }
 
+/** returns the real time in seconds, from a clock that is never set
+    back */
+static double current_wall_time(void)
+{
+#if defined(CLOCK_MONOTONIC)
+	struct timespec t;
+	if (clock_gettime(CLOCK_MONOTONIC, &t) == 0) {
+		return (t.tv_sec + ((double) t.tv_nsec) / 1000000000.0);
+	}
+#endif
+#if !defined(_WIN32)
+	{
+		struct timeval t;
+		gettimeofday(&t, NULL);
+		return (t.tv_sec + ((double) t.tv_usec) / 1000000.0);
+	}
+#else
+	return ((double) time(NULL));
+#endif
+}
+
 void print_time(Parse_Options opts, const char * s)
 {
 	resources_print_time(opts->verbosity, opts->resources, s);
@@ -70,14 +101,19 @@ Resources resources_create(void)
 
 	r = (Resources) xalloc(sizeof(struct Resources_s));
 	r->max_parse_time = MAX_PARSE_TIME_DEFAULT;
+	r->max_wall_time = MAX_PARSE_TIME_DEFAULT;
 	r->when_created = current_usage_time();
 	r->when_last_called = current_usage_time();
 	r->time_when_parse_started = current_usage_time();
+	r->wall_when_parse_started = current_wall_time();
 	r->space_when_parse_started = space_in_use;
+	r->space_in_use = 0;
+	r->max_space_in_use = 0;
 	r->max_memory = MAX_MEMORY_DEFAULT;
 	r->cumulative_time = 0;
 	r->memory_exhausted = FALSE;
 	r->timer_expired = FALSE;
+	r->checks = 0;
 
 	return r;
 }
@@ -90,19 +126,26 @@ void resources_delete(Resources r)
 void resources_reset(Resources r)
 {
 	r->when_last_called = r->time_when_parse_started = current_usage_time();
+	r->wall_when_parse_started = current_wall_time();
 	r->space_when_parse_started = space_in_use;
+	r->space_in_use = 0;
+	r->max_space_in_use = 0;
 	r->timer_expired = FALSE;
 	r->memory_exhausted = FALSE;
+	r->checks = 0;
 }
 
 void resources_reset_time(Resources r)
 {
 	r->when_last_called = r->time_when_parse_started = current_usage_time();
+	r->wall_when_parse_started = current_wall_time();
 }
 
 void resources_reset_space(Resources r)
 {
 	r->space_when_parse_started = space_in_use;
+	r->space_in_use = 0;
+	r->max_space_in_use = 0;
 }
 
 int resources_exhausted(Resources r)
@@ -116,17 +159,39 @@ int resources_exhausted(Resources r)
 	return (r->timer_expired || r->memory_exhausted);
 }
 
+/** The limits are in milliseconds: max_parse_time of CPU time used by
+    this thread, and max_wall_time of real time, both since the parse
+    started. */
 int resources_timer_expired(Resources r)
 {
-	if (r->max_parse_time == MAX_PARSE_TIME_DEFAULT) return 0;
-	else return (r->timer_expired || 
-	     (current_usage_time() - r->time_when_parse_started > r->max_parse_time));
+	if (r->timer_expired) return 1;
+	if ((r->max_parse_time != MAX_PARSE_TIME_DEFAULT) &&
+		(1000.0 * (current_usage_time() - r->time_when_parse_started) > r->max_parse_time)) {
+		return 1;
+	}
+	if ((r->max_wall_time != MAX_PARSE_TIME_DEFAULT) &&
+		(1000.0 * (current_wall_time() - r->wall_when_parse_started) > r->max_wall_time)) {
+		return 1;
+	}
+	return 0;
+}
+
+/** returns how many msecs of r's max_wall_time are left since its
+    parse started, or MAX_PARSE_TIME_DEFAULT if it has no such limit */
+int resources_wall_time_left(Resources r)
+{
+	int left;
+
+	if (r->max_wall_time == MAX_PARSE_TIME_DEFAULT) return MAX_PARSE_TIME_DEFAULT;
+	left = r->max_wall_time - (int) (1000.0 * (current_wall_time() - r->wall_when_parse_started));
+	return (left > 0) ? left : 0;
 }
 
+/** Only the space charged to the parse counts against max_memory */
 int resources_memory_exhausted(Resources r)
 {
 	if (r->max_memory == MAX_MEMORY_DEFAULT) return 0;
-	else return (r->memory_exhausted || (space_in_use > r->max_memory));
+	else return (r->memory_exhausted || (r->space_in_use > r->max_memory));
 }
 
 /** print out the cpu ticks since this was last called */
@@ -13,6 +13,14 @@
 #define MAX_PARSE_TIME_DEFAULT -1
 #define MAX_MEMORY_DEFAULT 128000000
 
+/* resources_check(r) is resources_exhausted(r) for inner loops: it only
+   reads the clocks once every RESOURCES_CHECK_INTERVAL calls, and in
+   between returns what the last real check found. */
+#define RESOURCES_CHECK_INTERVAL 1024
+#define resources_check(r) \
+	((++(r)->checks % RESOURCES_CHECK_INTERVAL) ? \
+	 ((r)->timer_expired || (r)->memory_exhausted) : resources_exhausted(r))
+
 void      print_time(Parse_Options opts, const char * s);
 void      print_total_time(Parse_Options opts);
 void      print_total_space(Parse_Options opts);
@@ -24,6 +32,7 @@ void      resources_print_total_space(int verbosity, Resources r);
 void      resources_print_time(int verbosity, Resources r, const char * s);
 int       resources_timer_expired(Resources r);
 int       resources_memory_exhausted(Resources r);
+int       resources_wall_time_left(Resources r);
 int       resources_exhausted(Resources r);
 Resources resources_create(void); 
 void      resources_delete(Resources ti);
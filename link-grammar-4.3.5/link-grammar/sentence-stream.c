@@ -0,0 +1,390 @@
+/********************************************************************************/
+/* Copyright (c) 2004                                                           */
+/* Daniel Sleator, David Temperley, and John Lafferty                           */
+/* All rights reserved                                                          */
+/*                                                                              */
+/* Use of the link grammar parsing system is subject to the terms of the        */
+/* license set forth in the LICENSE file included with this software,           */
+/* and also available at http://www.link.cs.cmu.edu/link/license.html           */
+/* This license allows free redistribution and use in source and binary         */
+/* forms, with or without modification, subject to certain conditions.          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <link-grammar/api.h>
+#include <errno.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#else
+#include <io.h>
+#endif
+
+/* A sentence stream reads text from a file descriptor a chunk at a
+   time and breaks it into sentences, so that a document of any size
+   can be parsed while holding no more than a chunk of it and a few
+   sentences.
+
+   Where threads are available the reading and splitting is done by a
+   thread of its own, which keeps up to max_pending sentences ahead of
+   the caller; the caller parses one while the next ones are read.  The
+   parser itself is not reentrant, so all the parsing stays with the
+   caller.  For the same reason the reader does not use xalloc() or
+   exalloc(), whose counters belong to the parser; everything here is
+   malloc()ed.  The reader also writes a byte to a pipe each time it
+   queues a sentence or finishes, so a caller that mustn't block in
+   sentence_stream_next() can wait for the pipe with select() or the
+   like until sentence_stream_ready() says it won't.
+
+   A sentence ends at a blank line, or at a '.', '!' or '?' (and any
+   closing quotes or brackets) followed by white space and a capital, a
+   digit or an opening quote or bracket.  A '.' after a single letter,
+   after a word that already has a '.' in it, or after one of the
+   abbreviations below, does not end a sentence.  Runs of white space
+   become a single blank, and a sentence that gets longer than
+   SS_MAX_SENTENCE bytes is cut off there. */
+
+#define SS_CHUNK_SIZE    65536
+#define SS_MAX_SENTENCE  8192
+
+static const char * abbreviations[] = {
+	"Mr", "Mrs", "Ms", "Dr", "Prof", "St", "Jr", "Sr", "Mt", "Gen",
+	"Col", "Capt", "Lt", "Sgt", "Rev", "Hon", "vs", "No", "Fig", NULL
+};
+
+struct Sentence_stream_s {
+	int     fd;
+	char *  chunk;
+	int     chunk_len;
+	int     pos;             /* of the next byte of the chunk to split */
+	char *  cur;             /* the sentence being put together */
+	int     cur_len;
+	int     space_pending;   /* TRUE if white space follows cur */
+	int     newlines;        /* in that white space */
+	int     eof;
+	int     error;           /* errno of the read that failed, or 0 */
+	char *  last;            /* handed out by the last sentence_stream_next() */
+#ifndef _WIN32
+	int             threaded;
+	pthread_t       reader;
+	pthread_mutex_t lock;
+	pthread_cond_t  not_empty;
+	pthread_cond_t  not_full;
+	char **         queue;
+	int             max_pending;
+	int             head;
+	int             count;
+	int             done;    /* TRUE once the reader has queued its last */
+	char *          pending; /* split, but waiting for room in the queue */
+	int             wake[2]; /* readable when the reader has queued more */
+#endif
+};
+
+/*****************************************************************
+*
+*  Splitting
+*
+******************************************************************/
+
+static int is_closer(int c) {
+	return (c == '"') || (c == '\'') || (c == ')') || (c == ']');
+}
+
+static int is_opener(int c) {
+	return (c == '"') || (c == '\'') || (c == '(') || (c == '[');
+}
+
+/** Returns TRUE if the text in cur, followed by white space, may be
+    the end of a sentence. */
+static int ends_sentence(Sentence_stream ss) {
+	int end, start, i;
+
+	for (end = ss->cur_len; end > 0 && is_closer(ss->cur[end-1]); end--)
+		;
+	if (end == 0) return FALSE;
+	if (ss->cur[end-1] == '!' || ss->cur[end-1] == '?') return TRUE;
+	if (ss->cur[end-1] != '.') return FALSE;
+
+	end--;
+	for (start = end; start > 0 && ss->cur[start-1] != ' '; start--)
+		;
+	while (start < end && is_opener(ss->cur[start])) start++;
+	if (end - start == 1 && isalpha((unsigned char) ss->cur[start])) return FALSE;
+	for (i = start; i < end; i++) {
+		if (ss->cur[i] == '.') return FALSE;
+	}
+	for (i = 0; abbreviations[i] != NULL; i++) {
+		if (((int) strlen(abbreviations[i]) == end - start) &&
+			(strncmp(abbreviations[i], ss->cur + start, end - start) == 0)) return FALSE;
+	}
+	return TRUE;
+}
+
+static int starts_sentence(int c) {
+	return isupper(c) || isdigit(c) || is_opener(c);
+}
+
+/** Hands out the sentence in cur as a string of its own, and starts
+    the next one. */
+static char * take_sentence(Sentence_stream ss) {
+	char * s;
+
+	s = (char *) malloc(ss->cur_len + 1);
+	if (s == NULL) {
+		printf("Ran out of space.\n");
+		abort();
+	}
+	memcpy(s, ss->cur, ss->cur_len);
+	s[ss->cur_len] = '\0';
+	ss->cur_len = 0;
+	ss->space_pending = FALSE;
+	ss->newlines = 0;
+	return s;
+}
+
+/** Returns the next sentence of the input, reading more of it as
+    needed, or NULL at its end.  The caller frees the sentence. */
+static char * split_next(Sentence_stream ss) {
+	char * s;
+	int c, n;
+
+	for (;;) {
+		if (ss->pos == ss->chunk_len) {
+			if (ss->eof) break;
+			n = read(ss->fd, ss->chunk, SS_CHUNK_SIZE);
+			if (n < 0 && errno == EINTR) continue;
+#ifndef _WIN32
+			if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+				/* the descriptor is non-blocking: wait for it instead */
+				struct pollfd pfd;
+				pfd.fd = ss->fd;
+				pfd.events = POLLIN;
+				poll(&pfd, 1, -1);
+				continue;
+			}
+#endif
+			if (n <= 0) {
+				if (n < 0) ss->error = errno;
+				ss->eof = TRUE;
+				break;
+			}
+			ss->chunk_len = n;
+			ss->pos = 0;
+		}
+
+		c = (unsigned char) ss->chunk[ss->pos];
+		if (isspace(c)) {
+			ss->pos++;
+			if (ss->cur_len == 0) continue;
+			ss->space_pending = TRUE;
+			if (c == '\n' && ++ss->newlines == 2) return take_sentence(ss);
+			continue;
+		}
+
+		s = NULL;
+		if (ss->space_pending && ends_sentence(ss) && starts_sentence(c)) {
+			s = take_sentence(ss);
+		} else if (ss->cur_len + ss->space_pending + 1 > SS_MAX_SENTENCE) {
+			s = take_sentence(ss);
+		}
+		if (ss->space_pending) ss->cur[ss->cur_len++] = ' ';
+		ss->cur[ss->cur_len++] = c;
+		ss->space_pending = FALSE;
+		ss->newlines = 0;
+		ss->pos++;
+		if (s != NULL) return s;
+	}
+
+	if (ss->cur_len > 0) return take_sentence(ss);
+	return NULL;
+}
+
+/*****************************************************************
+*
+*  The reader
+*
+******************************************************************/
+
+#ifndef _WIN32
+
+static void unlock_stream(void * arg) {
+	pthread_mutex_unlock(&((Sentence_stream) arg)->lock);
+}
+
+static void * reader(void * arg) {
+	Sentence_stream ss = (Sentence_stream) arg;
+	char * s;
+
+	for (;;) {
+		s = split_next(ss);
+		pthread_mutex_lock(&ss->lock);
+		pthread_cleanup_push(unlock_stream, ss);
+		if (s == NULL) {
+			ss->done = TRUE;
+		} else {
+			ss->pending = s;
+			while (ss->count == ss->max_pending) {
+				pthread_cond_wait(&ss->not_full, &ss->lock);
+			}
+			ss->queue[(ss->head + ss->count) % ss->max_pending] = s;
+			ss->count++;
+			ss->pending = NULL;
+		}
+		pthread_cond_signal(&ss->not_empty);
+		pthread_cleanup_pop(1);
+		/* if the pipe is full, it's readable already */
+		while (write(ss->wake[1], "", 1) < 0 && errno == EINTR)
+			;
+		if (s == NULL) break;
+	}
+	return NULL;
+}
+
+#endif
+
+/*****************************************************************
+*
+*  The API
+*
+******************************************************************/
+
+/** Starts reading sentences from the file descriptor fd, keeping up
+    to max_pending of them read ahead of the caller. */
+Sentence_stream sentence_stream_create(int fd, int max_pending) {
+	Sentence_stream ss;
+
+	ss = (Sentence_stream) malloc(sizeof(struct Sentence_stream_s));
+	if (ss == NULL) return NULL;
+	memset(ss, 0, sizeof(struct Sentence_stream_s));
+	ss->fd = fd;
+	ss->chunk = (char *) malloc(SS_CHUNK_SIZE);
+	ss->cur = (char *) malloc(SS_MAX_SENTENCE);
+	if (ss->chunk == NULL || ss->cur == NULL) {
+		free(ss->chunk);
+		free(ss->cur);
+		free(ss);
+		return NULL;
+	}
+
+#ifndef _WIN32
+	if (max_pending < 1) max_pending = 1;
+	ss->max_pending = max_pending;
+	ss->queue = (char **) malloc(max_pending * sizeof(char *));
+	if (ss->queue != NULL && pipe(ss->wake) == 0) {
+		fcntl(ss->wake[0], F_SETFL, fcntl(ss->wake[0], F_GETFL) | O_NONBLOCK);
+		fcntl(ss->wake[1], F_SETFL, fcntl(ss->wake[1], F_GETFL) | O_NONBLOCK);
+		pthread_mutex_init(&ss->lock, NULL);
+		pthread_cond_init(&ss->not_empty, NULL);
+		pthread_cond_init(&ss->not_full, NULL);
+		if (pthread_create(&ss->reader, NULL, reader, ss) == 0) {
+			ss->threaded = TRUE;
+		} else {
+			pthread_mutex_destroy(&ss->lock);
+			pthread_cond_destroy(&ss->not_empty);
+			pthread_cond_destroy(&ss->not_full);
+			close(ss->wake[0]);
+			close(ss->wake[1]);
+		}
+	}
+#endif
+	return ss;
+}
+
+/** Returns the next sentence, or NULL once the input has run out.  The
+    string belongs to the stream, and lasts until the next call. */
+char * sentence_stream_next(Sentence_stream ss) {
+	free(ss->last);
+	ss->last = NULL;
+
+#ifndef _WIN32
+	if (ss->threaded) {
+		pthread_mutex_lock(&ss->lock);
+		while (ss->count == 0 && !ss->done) {
+			pthread_cond_wait(&ss->not_empty, &ss->lock);
+		}
+		if (ss->count > 0) {
+			ss->last = ss->queue[ss->head];
+			ss->head = (ss->head + 1) % ss->max_pending;
+			ss->count--;
+			pthread_cond_signal(&ss->not_full);
+		}
+		pthread_mutex_unlock(&ss->lock);
+		return ss->last;
+	}
+#endif
+
+	ss->last = split_next(ss);
+	return ss->last;
+}
+
+/** Returns TRUE if sentence_stream_next() would return without
+    waiting for the reader.  If not, the descriptor that
+    sentence_stream_wait_fd() returns becomes readable once it would. */
+int sentence_stream_ready(Sentence_stream ss) {
+	int ready = TRUE;
+
+#ifndef _WIN32
+	if (ss->threaded) {
+		char buf[64];
+
+		pthread_mutex_lock(&ss->lock);
+		ready = (ss->count > 0 || ss->done);
+		/* the reader can't queue anything until the lock is let go, so
+		   whatever is in the pipe now is for sentences already taken */
+		if (!ready) {
+			while (read(ss->wake[0], buf, sizeof(buf)) > 0)
+				;
+		}
+		pthread_mutex_unlock(&ss->lock);
+	}
+#endif
+	return ready;
+}
+
+/** Returns a descriptor to wait on for reading until
+    sentence_stream_ready() is TRUE, or -1 if the stream has no reader
+    of its own and never needs waiting for. */
+int sentence_stream_wait_fd(Sentence_stream ss) {
+#ifndef _WIN32
+	if (ss->threaded) return ss->wake[0];
+#endif
+	return -1;
+}
+
+/** Returns the errno of the read that ended the stream early, or 0 if
+    it has not failed.  Only meaningful once sentence_stream_next() has
+    returned NULL. */
+int sentence_stream_error(Sentence_stream ss) {
+	return ss->error;
+}
+
+/** Stops reading, and frees the stream.  The file descriptor is left
+    open. */
+void sentence_stream_delete(Sentence_stream ss) {
+	if (ss == NULL) return;
+
+#ifndef _WIN32
+	if (ss->threaded) {
+		pthread_cancel(ss->reader);
+		pthread_join(ss->reader, NULL);
+		while (ss->count > 0) {
+			free(ss->queue[ss->head]);
+			ss->head = (ss->head + 1) % ss->max_pending;
+			ss->count--;
+		}
+		free(ss->pending);
+		pthread_mutex_destroy(&ss->lock);
+		pthread_cond_destroy(&ss->not_empty);
+		pthread_cond_destroy(&ss->not_full);
+		close(ss->wake[0]);
+		close(ss->wake[1]);
+	}
+	free(ss->queue);
+#endif
+	free(ss->last);
+	free(ss->chunk);
+	free(ss->cur);
+	free(ss);
+}
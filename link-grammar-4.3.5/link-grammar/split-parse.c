@@ -0,0 +1,351 @@
+/********************************************************************************/
+/* Copyright (c) 2004                                                           */
+/* Daniel Sleator, David Temperley, and John Lafferty                           */
+/* All rights reserved                                                          */
+/*                                                                              */
+/* Use of the link grammar parsing system is subject to the terms of the        */
+/* license set forth in the LICENSE file included with this software,           */
+/* and also available at http://www.link.cs.cmu.edu/link/license.html           */
+/* This license allows free redistribution and use in source and binary         */
+/* forms, with or without modification, subject to certain conditions.          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <link-grammar/api.h>
+
+/* Parsing a long sentence in segments.
+
+   Text that is really several clauses strung together ("I came; I saw;
+   I conquered", or a list flattened onto one line) costs far more to
+   parse whole than its clauses do one at a time, since counting is
+   cubic in the length of the sentence.  With the split_length option
+   set, a sentence of at least that many words is cut at its split
+   words, each segment is parsed as a sentence of its own, and the best
+   linkage of each is stitched into one linkage of the whole.
+
+   A split word is one that the dictionary lets stand in for the left
+   wall: it links back to the wall with an Xx connector and starts the
+   next clause with a W connector, as ";" and ":" do in the English
+   dictionary.  In the stitched linkage each split word takes over the
+   links of its segment's left wall, and is joined to the split word
+   before it (or to the left wall) by an Xx link, which is how a whole
+   parse joins them too.  Links to a segment's right wall are kept only
+   for the last segment, whose right wall is the sentence's.
+
+   The stitched linkage is handed to the sentence the way the parse
+   cache hands over a cached one, as the image in an entry of its own
+   (see parse_cache_entry_of_linkage()).  That entry is never put in
+   the cache, since its key doesn't say the sentence was split, but
+   the segments are parsed like any other sentence and so are cached.
+   The sentence ends up with no parse set and just the one linkage.  If
+   any segment has no linkage at all, the sentence is left to be parsed
+   whole.
+
+   The segments are parsed with sentence_parse_segment(), which doesn't
+   reset the options' resources, so their time and memory limits are
+   for the whole sentence, and its peak memory is the most that all of
+   its segments had in use at once.  Once the resources run out no more
+   segments are parsed, and the sentence is left with no linkages.
+
+   The library keeps its parsing state in file statics, so the segments
+   are parsed one after another. */
+
+#define SPLIT_BACK_CON  "Xx"   /* to the wall or the previous split word */
+#define SPLIT_CLAUSE_CON "W"   /* to the head of the clause that follows */
+
+typedef struct {
+	Sentence   sent;
+	int        N_segments;
+	int *      start;       /* the first word of each segment in sent */
+	Sentence * segment;
+	Linkage *  linkage;     /* the best linkage of each segment */
+} Split;
+
+/* TRUE if the expression has a connector named s pointing in direction dir */
+static int exp_has_connector(Exp *e, const char *s, char dir)
+{
+	E_list *l;
+
+	if (e->type == CONNECTOR_type) {
+		return (e->dir == dir) && (strcmp(e->u.string, s) == 0);
+	}
+	for (l = e->u.l; l != NULL; l = l->next) {
+		if (exp_has_connector(l->e, s, dir)) return TRUE;
+	}
+	return FALSE;
+}
+
+static int is_split_word(Sentence sent, int w)
+{
+	Dict_node *dn, *dn_head;
+	int found;
+
+	found = FALSE;
+	dn_head = dictionary_lookup_list(sent->dict, sent->word[w].string);
+	for (dn = dn_head; dn != NULL; dn = dn->right) {
+		if (exp_has_connector(dn->exp, SPLIT_BACK_CON, '-') &&
+			exp_has_connector(dn->exp, SPLIT_CLAUSE_CON, '+')) {
+			found = TRUE;
+			break;
+		}
+	}
+	free_lookup_list(dn_head);
+	return found;
+}
+
+/**
+ * The word of the whole sentence that word w of segment k is, or -1
+ * for the right wall of a segment other than the last.
+ */
+static int whole_word(Split *sp, int k, int w)
+{
+	if (w == 0) return (k == 0) ? 0 : sp->start[k]-1;
+	if (w == sp->linkage[k]->num_words-1) {
+		return (k == sp->N_segments-1) ? sp->sent->length-1 : -1;
+	}
+	return sp->start[k] + w-1;
+}
+
+static Sublinkage * segment_sublinkage(Split *sp, int k, int i)
+{
+	Linkage linkage = sp->linkage[k];
+	if (i >= linkage->num_sublinkages) i = linkage->num_sublinkages-1;
+	return &linkage->sublinkage[i];
+}
+
+static char * excopy_string(const char *s)
+{
+	return strcpy((char *) exalloc(strlen(s)+1), s);
+}
+
+static void excopy_pp_info(PP_info *to, PP_info *from)
+{
+	int d;
+
+	to->num_domains = from->num_domains;
+	to->domain_name = NULL;
+	if (from->num_domains == 0) return;
+	to->domain_name = (char **) exalloc(from->num_domains*sizeof(char *));
+	for (d=0; d<from->num_domains; d++) {
+		to->domain_name[d] = excopy_string(from->domain_name[d]);
+	}
+}
+
+/* The Xx link that joins split word r to l, the one before it */
+static Link split_link(int l, int r)
+{
+	struct Link_s link;
+	Connector lc, rc;
+
+	init_connector(&lc);
+	lc.label = NORMAL_LABEL;
+	lc.priority = THIN_priority;
+	lc.multi = FALSE;
+	lc.word = r;
+	lc.next = NULL;
+	lc.string = SPLIT_BACK_CON;
+	rc = lc;
+	rc.word = l;
+
+	link.l = l;
+	link.r = r;
+	link.name = SPLIT_BACK_CON;
+	link.lc = &lc;
+	link.rc = &rc;
+	return excopy_link(&link);
+}
+
+/**
+ * Builds sublinkage i of the stitched linkage out of sublinkage i of
+ * every segment, or the last one a segment has if it has fewer.
+ */
+static void stitch_sublinkage(Split *sp, Sublinkage *to, int i)
+{
+	Sublinkage *s;
+	Link link;
+	int k, j, l, r, n, has_pp_info;
+
+	memset(to, 0, sizeof(Sublinkage));
+	n = sp->N_segments-1;
+	has_pp_info = FALSE;
+	for (k=0; k<sp->N_segments; k++) {
+		s = segment_sublinkage(sp, k, i);
+		if (s->pp_info != NULL) has_pp_info = TRUE;
+		if ((to->violation == NULL) && (s->violation != NULL)) {
+			to->violation = excopy_string(s->violation);
+		}
+		for (j=0; j<s->num_links; j++) {
+			if (whole_word(sp, k, s->link[j]->r) >= 0) n++;
+		}
+	}
+
+	to->num_links = n;
+	to->link = (Link *) exalloc(n*sizeof(Link));
+	if (has_pp_info) {
+		to->pp_info = (PP_info *) exalloc(n*sizeof(PP_info));
+		memset(to->pp_info, 0, n*sizeof(PP_info));
+	}
+
+	n = 0;
+	for (k=0; k<sp->N_segments; k++) {
+		if (k > 0) {
+			to->link[n++] = split_link(whole_word(sp, k-1, 0), whole_word(sp, k, 0));
+		}
+		s = segment_sublinkage(sp, k, i);
+		for (j=0; j<s->num_links; j++) {
+			l = whole_word(sp, k, s->link[j]->l);
+			r = whole_word(sp, k, s->link[j]->r);
+			if (r < 0) continue;
+			link = excopy_link(s->link[j]);
+			link->l = l;
+			link->r = r;
+			if ((to->pp_info != NULL) && (s->pp_info != NULL)) {
+				excopy_pp_info(&to->pp_info[n], &s->pp_info[j]);
+			}
+			to->link[n++] = link;
+		}
+	}
+}
+
+static void add_info(Linkage_info *to, Linkage_info *from)
+{
+	to->N_violations += from->N_violations;
+	to->null_cost += from->null_cost;
+	to->unused_word_cost += from->unused_word_cost;
+	to->disjunct_cost += from->disjunct_cost;
+	to->and_cost += from->and_cost;
+	to->link_cost += from->link_cost;
+	to->fat = to->fat || from->fat;
+	to->improper_fat_linkage = to->improper_fat_linkage || from->improper_fat_linkage;
+	to->inconsistent_domains = to->inconsistent_domains || from->inconsistent_domains;
+}
+
+static Linkage stitch_linkages(Split *sp, Parse_Options opts)
+{
+	Sentence sent = sp->sent;
+	Linkage linkage, seg;
+	int i, k, w;
+
+	linkage = (Linkage) exalloc(sizeof(struct Linkage_s));
+	linkage->num_words = sent->length;
+	linkage->word = (const char **) exalloc(linkage->num_words*sizeof(char *));
+	for (k=0; k<sp->N_segments; k++) {
+		seg = sp->linkage[k];
+		for (w=0; w<seg->num_words; w++) {
+			i = whole_word(sp, k, w);
+			if ((i < 0) || ((w == 0) && (k > 0))) continue;
+			linkage->word[i] = excopy_string(seg->word[w]);
+		}
+		if (k > 0) {
+			i = whole_word(sp, k, 0);
+			linkage->word[i] = excopy_string(sent->word[i].string);
+		}
+	}
+	linkage->current = 0;
+	linkage->unionized = FALSE;
+	linkage->sent = sent;
+	linkage->dict = sent->dict;
+	linkage->opts = opts;
+	linkage->constituent_tree = NULL;
+	linkage->constituent_string = NULL;
+
+	memset(&linkage->info, 0, sizeof(Linkage_info));
+	linkage->info.canonical = TRUE;
+	linkage->num_sublinkages = 1;
+	for (k=0; k<sp->N_segments; k++) {
+		add_info(&linkage->info, &sp->linkage[k]->info);
+		if (sp->linkage[k]->num_sublinkages > linkage->num_sublinkages) {
+			linkage->num_sublinkages = sp->linkage[k]->num_sublinkages;
+		}
+	}
+	linkage->sublinkage =
+		(Sublinkage *) exalloc(linkage->num_sublinkages*sizeof(Sublinkage));
+	for (i=0; i<linkage->num_sublinkages; i++) {
+		stitch_sublinkage(sp, &linkage->sublinkage[i], i);
+	}
+	return linkage;
+}
+
+/**
+ * Finds the split words of the sentence, and returns how many
+ * segments they cut it into, with the first word of each in start[].
+ * Every segment has at least one word.
+ */
+static int find_segments(Sentence sent, int *start)
+{
+	int w, n;
+
+	n = 0;
+	start[n++] = 1;
+	for (w=2; w<sent->length-2; w++) {
+		if ((w > start[n-1]) && is_split_word(sent, w)) start[n++] = w+1;
+	}
+	return n;
+}
+
+static void free_split(Split *sp)
+{
+	int k;
+
+	for (k=0; k<sp->N_segments; k++) {
+		if (sp->linkage[k] != NULL) linkage_delete(sp->linkage[k]);
+		if (sp->segment[k] != NULL) sentence_delete(sp->segment[k]);
+	}
+	xfree(sp->linkage, sp->sent->length*sizeof(Linkage));
+	xfree(sp->segment, sp->sent->length*sizeof(Sentence));
+	xfree(sp->start, sp->sent->length*sizeof(int));
+}
+
+/**
+ * Parses the sentence a segment at a time, and returns an entry with
+ * the stitched linkage for it, or NULL if the sentence has no split
+ * words or a segment has no linkage.
+ */
+Parse_cache_entry * split_parse(Sentence sent, Parse_Options opts)
+{
+	Split sp;
+	Linkage linkage;
+	Parse_cache_entry *e;
+	const char **tokens;
+	int k, i, end;
+
+	if (!sent->dict->left_wall_defined || !sent->dict->right_wall_defined) return NULL;
+
+	sp.sent = sent;
+	sp.start = (int *) xalloc(sent->length*sizeof(int));
+	sp.segment = (Sentence *) xalloc(sent->length*sizeof(Sentence));
+	sp.linkage = (Linkage *) xalloc(sent->length*sizeof(Linkage));
+	sp.N_segments = find_segments(sent, sp.start);
+	for (k=0; k<sp.N_segments; k++) {
+		sp.segment[k] = NULL;
+		sp.linkage[k] = NULL;
+	}
+	if (sp.N_segments == 1) {
+		free_split(&sp);
+		return NULL;
+	}
+
+	tokens = (const char **) xalloc(sent->length*sizeof(char *));
+	for (k=0; k<sp.N_segments; k++) {
+		end = (k == sp.N_segments-1) ? sent->length-1 : sp.start[k+1]-1;
+		for (i=sp.start[k]; i<end; i++) {
+			tokens[i-sp.start[k]] = sent->word[i].string;
+		}
+		sp.segment[k] = sentence_create_from_tokens(tokens, end-sp.start[k], sent->dict);
+		if (sp.segment[k] == NULL) break;
+		sentence_parse_segment(sp.segment[k], opts);
+		if (resources_exhausted(opts->resources)) break;
+		sp.linkage[k] = linkage_create(0, sp.segment[k], opts);
+		if (sp.linkage[k] == NULL) break;
+	}
+	xfree(tokens, sent->length*sizeof(char *));
+
+	e = NULL;
+	if (k == sp.N_segments) {
+		linkage = stitch_linkages(&sp, opts);
+		e = parse_cache_entry_of_linkage(sent, opts, linkage);
+		linkage_delete(linkage);
+	}
+	free_split(&sp);
+	return e;
+}
@@ -0,0 +1,30 @@
+/********************************************************************************/
+/* Copyright (c) 2004                                                           */
+/* Daniel Sleator, David Temperley, and John Lafferty                           */
+/* All rights reserved                                                          */
+/*                                                                              */
+/* Use of the link grammar parsing system is subject to the terms of the        */
+/* license set forth in the LICENSE file included with this software,           */
+/* and also available at http://www.link.cs.cmu.edu/link/license.html           */
+/* This license allows free redistribution and use in source and binary         */
+/* forms, with or without modification, subject to certain conditions.          */
+/*                                                                              */
+/********************************************************************************/
+/**********************************************************************
+  Calling paradigm:
+   . sentence_parse() calls split_parse() for a sentence of at least
+     split_length words that isn't in the parse cache.  If it gets an
+     entry back it restores the sentence from it with
+     parse_cache_restore(), otherwise it parses the sentence whole.
+   . split_parse() parses each segment with sentence_parse_segment(),
+     which charges it to the sentence's resources without resetting
+     them.
+***********************************************************************/
+
+#ifndef _SPLITPARSEH_
+#define _SPLITPARSEH_
+
+Parse_cache_entry * split_parse(Sentence sent, Parse_Options opts);
+int sentence_parse_segment(Sentence sent, Parse_Options opts);
+
+#endif
@@ -157,12 +157,13 @@ OBS #define AMPERSAND_WORD   ("AMPERSAND")
 /*      Some size definitions.  Reduce these for small machines */
 #define MAX_WORD 60           /* maximum number of chars in a word */
 #define MAX_LINE 1500         /* maximum number of chars in a sentence */
-#define MAX_SENTENCE 250      /* maximum number of words in a sentence */
-   /* This cannot be more than 254, because I use word MAX_SENTENCE+1 to
-      indicate that nothing can connect to this connector, and this
-      should fit in one byte (if the word field of a connector is an
-      unsigned char) */
-#define MAX_LINKS (2*MAX_SENTENCE-3) /* maximum number of links allowed */
+#define MAX_SENTENCE 32000    /* maximum number of words in a sentence */
+   /* Everything kept for each word is sized from the sentence itself;
+      this is only a bound.  It cannot be more than 32766, because I use
+      word MAX_SENTENCE+1 to indicate that nothing can connect to a
+      connector, and word numbers and distances are kept in shorts (see
+      the word field of a connector, and effective_dist) */
+#define MAX_LINKS(n) (2*(n))  /* more links than a linkage of n words has */
 #define MAX_TOKEN_LENGTH 50          /* maximum number of chars in a token */
 #define MAX_DISJUNCT_COST 10000
 
@@ -181,9 +182,9 @@ OBS #define AMPERSAND_WORD   ("AMPERSAND")
 #define NORMAL_LABEL  (-1) /* used for normal connectors            */
                            /* the labels >= 0 are used by fat links */
 
-#define UNLIMITED_LEN 255
+#define UNLIMITED_LEN 65535
 #define SHORT_LEN 6
-#define NO_WORD 255
+#define NO_WORD 65535
 
 #ifndef _MSC_VER
 typedef long long s64; /* signed 64-bit integer, even on 32-bit cpus */
@@ -198,17 +199,18 @@ typedef struct Connector_struct Connector;
 struct Connector_struct
 {
     short label;
-    unsigned char word;
+    unsigned short word;
                    /* The nearest word to my left (or right) that
                       this could connect to.  Computed by power pruning */
-    unsigned char length_limit;
+    unsigned short length_limit;
                   /* If this is a length limited connector, this
                      gives the limit of the length of the link
                      that can be used on this connector.  Since
                      this is strictly a funcion of the connector
                      name, efficiency is the only reason to store
-                     this.  If no limit, the value is set to 255. */
-  /*    unsigned char my_word; */  /* not used now */
+                     this.  If no limit, the value is set to
+                     UNLIMITED_LEN. */
+  /*    unsigned short my_word; */  /* not used now */
                   /* The word that this connector arises from */
     char priority;/* one of the three priorities above */
     char multi;   /* TRUE if this is a multi-connector */
@@ -226,6 +228,16 @@ struct Disjunct_struct
     Connector *left, *right;
 };
 
+/* A disjunct built for a parse that admits the costlier ones in
+   stages, with the cost that decides which stage admits it */
+typedef struct Staged_disjunct_struct Staged_disjunct;
+struct Staged_disjunct_struct
+{
+    Staged_disjunct *next;
+    int maxcost;
+    Disjunct *d;
+};
+
 typedef struct Link_s * Link;
 struct Link_s
 {
@@ -251,10 +263,11 @@ struct X_node_struct
 
 typedef struct Word_struct Word;
 struct Word_struct {
-    char string[MAX_WORD+1];
+    const char * string; /* in the sentence's string set */
     X_node * x;      /* sentence starts out with these */
     Disjunct * d;    /* eventually these get generated */
     int firstupper;
+    int post_quote;  /* TRUE if it came right after a quotation mark */
 };
 
 /* The E_list an Exp structures defined below comprise the expression      */
@@ -318,7 +331,8 @@ struct D_type_list_struct {
 
 typedef struct PP_node_struct PP_node;
 struct PP_node_struct {
-    D_type_list *d_type_array[MAX_LINKS];
+    D_type_list **d_type_array;    /* one list per link, num_links of them */
+    int num_links;
     char *violation;
 };
 
@@ -329,9 +343,9 @@ struct Andlist_struct {
     Andlist * next;
     int conjunction;
     int num_elements;
-    int element[MAX_SENTENCE];
+    int * element;
     int num_outside_words;
-    int outside_word[MAX_SENTENCE];
+    int * outside_word;
     int cost;
 };
 
@@ -345,9 +359,9 @@ struct Linkage_info_struct {
     char canonical;
     char improper_fat_linkage;
     char inconsistent_domains;
-    short N_violations, null_cost, unused_word_cost, disjunct_cost, and_cost, link_cost;
+    short N_violations, null_cost, unused_word_cost, disjunct_cost, and_cost;
+    int link_cost;
     Andlist * andlist;
-    int island[MAX_SENTENCE];
 };
 
 typedef struct List_o_links_struct List_o_links;
@@ -11,15 +11,11 @@
 /*                                                                       */
 /*************************************************************************/
 
-#ifndef _WIN32
-#include <langinfo.h>
-#endif
 #include <limits.h>
 #include <link-grammar/api.h>
 
 #define MAX_STRIP 10
 
-int post_quote[MAX_SENTENCE];
 /*static char * strip_left[] = {"(", "$", "``", NULL}; */
 /*static char * strip_right[] = {")", "%", ",", ".", ":", ";", "?", "!", "''", "'", "'s", NULL};*/
 
@@ -47,12 +43,13 @@ static int is_initials_word(const char * word)
  */
 static int is_number(const char * s)
 {
-	wchar_t c;
+	int c;
 	if (!is_utf8_digit(s)) return FALSE;
 
 	while (*s != 0)
 	{
-		int nb = mbtowc(&c, s, 4);
+		int nb = utf8_next(s, &c);
+		if (nb <= 0) return FALSE;
 		if (iswdigit(c)) { s += nb; }
 
 		/* U+00A0 no break space */
@@ -71,7 +68,7 @@ static int is_number(const char * s)
  */
 static int ishyphenated(const char * s)
 {
-	wchar_t c;
+	int c;
 	int hyp, nonalpha;
 	hyp = nonalpha = 0;
 
@@ -79,7 +76,8 @@ static int ishyphenated(const char * s)
 
 	while (*s != '\0')
 	{
-		int nb = mbtowc(&c, s, 4);
+		int nb = utf8_next(s, &c);
+		if (nb <= 0) return FALSE;
 
 		if (!iswalpha(c) && !iswdigit(c) && (*s!='.') && (*s!=',')
 			&& (*s!='-')) return FALSE;
@@ -131,6 +129,25 @@ static int is_ly_word(const char * s)
 	return FALSE;
 }
 
+/**
+ * Makes room for more words in the sentence.  The room doubles each
+ * time, so a short sentence only has room for a few words, and a long
+ * one doesn't copy them many times over.
+ */
+static void grow_words(Sentence sent)
+{
+	Word * old = sent->word;
+	int old_size = sent->word_size;
+
+	sent->word_size = (old_size == 0) ? 16 : 2*old_size;
+	if (sent->word_size > MAX_SENTENCE) sent->word_size = MAX_SENTENCE;
+	sent->word = (Word *) xalloc(sent->word_size*sizeof(Word));
+	if (old != NULL) {
+		memcpy(sent->word, old, sent->length*sizeof(Word));
+		xfree(old, old_size*sizeof(Word));
+	}
+}
+
 /** 
  * The string s is the next word of the sentence. 
  * Do not issue the empty string.  
@@ -151,7 +168,9 @@ static int issue_sentence_word(Sentence sent, const char * s)
 		return FALSE;
 	}
 
-	strcpy(sent->word[sent->length].string, s);
+	if (sent->length == sent->word_size) grow_words(sent);
+	sent->word[sent->length].string = string_set_add(s, sent->string_set);
+	sent->word[sent->length].post_quote = 0;
 
 	/* Now we record whether the first character of the word is upper-case.
 	   (The first character may be made lower-case
@@ -220,16 +239,16 @@ static int issue_sentence_word(Sentence sent, const char * s)
 static int downcase_is_in_dict(Dictionary dict, char * word)
 {
 	int i, rc;
-	char low[MB_LEN_MAX];
-	char save[MB_LEN_MAX];
-	wchar_t c;
+	char low[4];
+	char save[4];
+	int c;
 	int nbl, nbh;
 
 	if (!is_utf8_upper(word)) return FALSE;
 
-	nbh = mbtowc (&c, word, 4);
+	nbh = utf8_next(word, &c);
 	c = towlower(c);
-	nbl = wctomb(low, c);
+	nbl = utf8_put(low, c);
 	if (nbh != nbl)
 	{
 		fprintf(stderr, "Error: can't downcase multi-byte string!\n");
@@ -246,75 +265,101 @@ static int downcase_is_in_dict(Dictionary dict, char * word)
 	return rc; 
 }
 
-static int separate_word(Sentence sent, char *w, char *wend, int is_first_word, int quote_found)
+/**
+ * Sorts the entries of the dictionary's affix table by the connectors
+ * that say what they are for.  This is done once, when the dictionary
+ * is created, rather than for every word that is split up.
+ */
+void build_affix_lists(Dictionary dict)
 {
-	/* w points to a string, wend points to the char one after the end.  The
-	 * "word" w contains no blanks.  This function splits up the word if
-	 * necessary, and calls "issue_sentence_word()" on each of the resulting
-	 * parts.  The process is described above.  returns TRUE of OK, FALSE if
-	 * too many punctuation marks */
-	int i, j, k, l, len;
-	int r_strippable=0, l_strippable=0;
-	int s_strippable=0, p_strippable=0;
-	int  n_r_stripped, s_stripped;
-	int word_is_in_dict, s_ok;
-	int r_stripped[MAX_STRIP];  /* these were stripped from the right */
-	const char ** strip_left=NULL;
-	const char ** strip_right=NULL;
-	const char ** prefix=NULL;
-	const char ** suffix=NULL;
-	char word[MAX_WORD+1];
-	char newword[MAX_WORD+1];
+	int i, j, k, l;
 	Dict_node * dn, * dn2, * start_dn;
 	const char * rpunc_con = "RPUNC";
 	const char * lpunc_con = "LPUNC";
 	const char * suf_con = "SUF";
 	const char * pre_con = "PRE";
 
-	if (sent->dict->affix_table!=NULL)
+	dict->r_strippable = dict->l_strippable = 0;
+	dict->s_strippable = dict->p_strippable = 0;
+	dict->strip_right = dict->strip_left = NULL;
+	dict->suffix = dict->prefix = NULL;
+	if (dict->affix_table == NULL) return;
+
+	start_dn = list_whole_dictionary(dict->affix_table->root, NULL);
+	for (dn = start_dn; dn != NULL; dn = dn->right)
 	{
-		start_dn = list_whole_dictionary(sent->dict->affix_table->root, NULL);
-		for (dn = start_dn; dn != NULL; dn = dn->right)
-		{
-			if (word_has_connector(dn, rpunc_con, 0)) r_strippable++;
-			if (word_has_connector(dn, lpunc_con, 0)) l_strippable++;
-			if (word_has_connector(dn, suf_con, 0)) s_strippable++;
-			if (word_has_connector(dn, pre_con, 0)) p_strippable++;
-	  	}
-		strip_right = (const char **) xalloc(r_strippable * sizeof(char *));
-		strip_left = (const char **) xalloc(l_strippable * sizeof(char *));
-		suffix = (const char **) xalloc(s_strippable * sizeof(char *));
-		prefix = (const char **) xalloc(p_strippable * sizeof(char *));
-
-		i=0;
-		j=0;
-		k=0;
-		l=0;
-		dn = start_dn;
-		while (dn != NULL)
-		{
-			if(word_has_connector(dn, rpunc_con, 0)) {
-				strip_right[i] = dn->string;
-				i++;
-			}
-			if(word_has_connector(dn, lpunc_con, 0)) {
-				strip_left[j] = dn->string;
-				j++;
-			}
-			if(word_has_connector(dn, suf_con, 0)) {
-				suffix[k] = dn->string;
-				k++;
-			}
-			if(word_has_connector(dn, pre_con, 0)) {
-				prefix[l] = dn->string;
-				l++;
-			}
-			dn2 = dn->right;
-			dn->right = NULL;
-			xfree(dn, sizeof(Dict_node));
-			dn = dn2;
+		if (word_has_connector(dn, rpunc_con, 0)) dict->r_strippable++;
+		if (word_has_connector(dn, lpunc_con, 0)) dict->l_strippable++;
+		if (word_has_connector(dn, suf_con, 0)) dict->s_strippable++;
+		if (word_has_connector(dn, pre_con, 0)) dict->p_strippable++;
+	}
+	dict->strip_right = (const char **) xalloc(dict->r_strippable * sizeof(char *));
+	dict->strip_left = (const char **) xalloc(dict->l_strippable * sizeof(char *));
+	dict->suffix = (const char **) xalloc(dict->s_strippable * sizeof(char *));
+	dict->prefix = (const char **) xalloc(dict->p_strippable * sizeof(char *));
+
+	i=0;
+	j=0;
+	k=0;
+	l=0;
+	dn = start_dn;
+	while (dn != NULL)
+	{
+		if(word_has_connector(dn, rpunc_con, 0)) {
+			dict->strip_right[i] = dn->string;
+			i++;
+		}
+		if(word_has_connector(dn, lpunc_con, 0)) {
+			dict->strip_left[j] = dn->string;
+			j++;
 		}
+		if(word_has_connector(dn, suf_con, 0)) {
+			dict->suffix[k] = dn->string;
+			k++;
+		}
+		if(word_has_connector(dn, pre_con, 0)) {
+			dict->prefix[l] = dn->string;
+			l++;
+		}
+		dn2 = dn->right;
+		dn->right = NULL;
+		xfree(dn, sizeof(Dict_node));
+		dn = dn2;
 	}
+}
+
+void free_affix_lists(Dictionary dict)
+{
+	if (dict->affix_table == NULL) return;
+	xfree(dict->strip_right, dict->r_strippable * sizeof(char *));
+	xfree(dict->strip_left, dict->l_strippable * sizeof(char *));
+	xfree(dict->suffix, dict->s_strippable * sizeof(char *));
+	xfree(dict->prefix, dict->p_strippable * sizeof(char *));
+}
+
+static int split_word(Sentence sent, char *w, char *wend, int is_first_word, int *main_word)
+{
+	/* w points to a string, wend points to the char one after the end.  The
+	 * "word" w contains no blanks.  This function splits up the word if
+	 * necessary, and calls "issue_sentence_word()" on each of the resulting
+	 * parts.  The process is described above.  returns TRUE of OK, FALSE if
+	 * too many punctuation marks.  *main_word is set to the index in the
+	 * sentence of what is left once the affixes are stripped. */
+	int i, j, len;
+	int  n_r_stripped, s_stripped;
+	int word_is_in_dict, s_ok;
+	int r_stripped[MAX_STRIP];  /* these were stripped from the right */
+	Dictionary dict = sent->dict;
+	const int r_strippable = dict->r_strippable;
+	const int l_strippable = dict->l_strippable;
+	const int s_strippable = dict->s_strippable;
+	const int p_strippable = dict->p_strippable;
+	const char ** strip_left = dict->strip_left;
+	const char ** strip_right = dict->strip_right;
+	const char ** prefix = dict->prefix;
+	const char ** suffix = dict->suffix;
+	char word[MAX_WORD+1];
+	char newword[MAX_WORD+1];
 
 	for (;;) {
 		for (i=0; i<l_strippable; i++) {
@@ -443,7 +488,7 @@ static int separate_word(Sentence sent, char *w, char *wend, int is_first_word,
 		return FALSE;
 	} */
 
-	if (quote_found==1) post_quote[sent->length]=1;
+	*main_word = sent->length;
 
 	if (!issue_sentence_word(sent, word)) return FALSE;
 
@@ -470,16 +515,107 @@ static int separate_word(Sentence sent, char *w, char *wend, int is_first_word,
 		 */
 		if (!issue_sentence_word(sent, strip_right[r_stripped[i]])) return FALSE;
 	}
+	return TRUE;
+}
 
-	if(sent->dict->affix_table!=NULL) {
-	  xfree(strip_right, r_strippable * sizeof(char *));
-	  xfree(strip_left, l_strippable * sizeof(char *));
-	  xfree(suffix, s_strippable * sizeof(char *));
-	  xfree(prefix, p_strippable * sizeof(char *));
+/**
+ * Splits up the word from w to wend with split_word(), or as the word
+ * cache remembers it being split before.  The cache keeps the words it
+ * was split into, one after the other with a '\0' after each, after an
+ * int giving which of them was the main word.  The key says whether the
+ * word was first in the sentence, since that changes how it is split.
+ */
+static int separate_word(Sentence sent, char *w, char *wend, int is_first_word, int quote_found)
+{
+	char key[MAX_WORD+2];
+	char *val, *p;
+	int key_len, size, start, main_word, i;
+	Word_cache *wc = sent->dict->word_cache;
+
+	key_len = (int) (wend - w) + 1;
+	if ((wc == NULL) || (key_len > MAX_WORD+1)) {
+		if (!split_word(sent, w, wend, is_first_word, &main_word)) return FALSE;
+		if ((quote_found==1) && (main_word < sent->length)) sent->word[main_word].post_quote=1;
+		return TRUE;
 	}
+	key[0] = is_first_word ? 'F' : 'S';
+	memcpy(key+1, w, key_len-1);
+
+	start = sent->length;
+	val = word_cache_lookup(wc, key, key_len, &size);
+	if (val != NULL) {
+		memcpy(&main_word, val, sizeof(int));
+		main_word += start;
+		for (p = val + sizeof(int); p < val + size; p += strlen(p) + 1) {
+			if (!issue_sentence_word(sent, p)) break;
+		}
+		word_cache_value_delete(val, size);
+		if (p < val + size) return FALSE;
+	} else {
+		if (!split_word(sent, w, wend, is_first_word, &main_word)) return FALSE;
+
+		size = sizeof(int);
+		for (i=start; i<sent->length; i++) size += strlen(sent->word[i].string) + 1;
+		val = (char *) exalloc(size);
+		i = main_word - start;
+		memcpy(val, &i, sizeof(int));
+		for (p = val + sizeof(int), i=start; i<sent->length; i++) {
+			strcpy(p, sent->word[i].string);
+			p += strlen(p) + 1;
+		}
+		word_cache_add(wc, key, key_len, val, size);
+		exfree(val, size);
+	}
+
+	if ((quote_found==1) && (main_word < sent->length)) sent->word[main_word].post_quote=1;
 	return TRUE;
 }
 
+/*
+ * The sentence is split up as UTF-8 whatever the locale is, so that
+ * the splitting neither depends on setlocale() nor touches the shift
+ * state that mbtowc() keeps for the whole process.  A blank is
+ * anything iswspace() takes as one in a UTF-8 locale.
+ */
+
+static int is_blank(int c)
+{
+	if (c < 0x80) return (c == ' ') || ((c >= '\t') && (c <= '\r'));
+	return (c == 0x1680) || ((c >= 0x2000) && (c <= 0x200a) && (c != 0x2007)) ||
+		(c == 0x2028) || (c == 0x2029) || (c == 0x205f) || (c == 0x3000);
+}
+
+/* Byte-wise tests on a whole unsigned long at a time: ONES has 0x01 in
+   every byte, and HAS_ZERO(x) is non-zero if some byte of x is zero. */
+#define ONES           ((unsigned long) -1 / 0xff)
+#define HIGHS          (ONES * 0x80)
+#define HAS_LESS(x, n) (((x) - ONES * (n)) & ~(x) & HIGHS)
+#define HAS_ZERO(x)    HAS_LESS(x, 1)
+
+/**
+ * Returns the end of the word that starts at t: the first blank, quote
+ * or bad character, or end, which is where the string ends.  Words are
+ * nearly always plain ASCII, so the bytes are looked at a long at a
+ * time until one of them might be something other than a printable
+ * ASCII character.
+ */
+static char * word_end(char * t, const char * end)
+{
+	unsigned long x;
+	int c, nb;
+
+	while (end - t >= (int) sizeof(x)) {
+		memcpy(&x, t, sizeof(x));
+		if ((x & HIGHS) || HAS_LESS(x, 0x21) || HAS_ZERO(x ^ (ONES * '\"'))) break;
+		t += sizeof(x);
+	}
+	for (;;) {
+		nb = utf8_next(t, &c);
+		if ((nb <= 0) || is_blank(c) || (c == '\"')) return t;
+		t += nb;
+	}
+}
+
 /**
  * The string s has just been read in from standard input.
  * This function breaks it up into words and stores these words in
@@ -488,48 +624,38 @@ static int separate_word(Sentence sent, char *w, char *wend, int is_first_word,
  */
 int separate_sentence(char * s, Sentence sent)
 {
-	char *t;
-	int i, is_first, quote_found;
+	char *t, *start, *end;
+	int c, nb, is_first, quote_found;
 	Dictionary dict = sent->dict;
 
-	for(i=0; i<MAX_SENTENCE; i++) post_quote[i]=0;
 	sent->length = 0;
 
 	if (dict->left_wall_defined)
 		if (!issue_sentence_word(sent, LEFT_WALL_WORD)) return FALSE;
 
-	/* Reset the multibyte shift state to the initial state */
-	mbtowc(NULL, NULL, 4);
-
+	start = s;
+	end = s + strlen(s);
 	is_first = TRUE;
 	for(;;) 
 	{
-		wchar_t c;
-		int nb = mbtowc(&c, s, 4);
+		nb = utf8_next(s, &c);
 		quote_found = FALSE;
 
 		if (0 > nb) goto failure;
 
 		/* skip all whitespace */
-		while (iswspace(c) || (c == '\"'))
+		while (is_blank(c) || (c == '\"'))
 		{
 			s += nb;
 			if(*s == '\"') quote_found=TRUE;
-			nb = mbtowc(&c, s, 4);
+			nb = utf8_next(s, &c);
 			if (0 > nb) goto failure;
 		}
 
 		if (*s == '\0') break;
 
-		t = s;
-		nb = mbtowc(&c, t, 6);
-		if (0 > nb) goto failure;
-		while (!iswspace(c) && (c != '\"') && (c != 0) && (nb != 0))
-		{
-			t += nb;
-			nb = mbtowc(&c, t, 4);
-			if (0 > nb) goto failure;
-		}
+		t = word_end(s, end);
+		if (0 > utf8_next(t, &c)) { s = t; goto failure; }
 
 		if (!separate_word(sent, s, t, is_first, quote_found)) return FALSE;
 		is_first = FALSE;
@@ -543,12 +669,47 @@ int separate_sentence(char * s, Sentence sent)
 	return (sent->length > dict->left_wall_defined + dict->right_wall_defined);
 
 failure:
-#ifndef _WIN32
-	lperror(CHARSET, "%s\n", nl_langinfo(CODESET));
-#endif
+	lperror(CHARSET, "at byte %d\n", (int) (s - start));
 	return FALSE;
 }
 
+/**
+ * Like separate_sentence(), but for a sentence that has already been
+ * broken into words by the caller.  Each of the n tokens becomes one
+ * word of the sentence, as it is: no blanks or quotes are looked for,
+ * and no affixes are stripped, so word i+1 (after the left wall) is
+ * always tokens[i].  Returns TRUE if all is well, FALSE otherwise.
+ */
+int separate_tokens(const char ** tokens, int n, Sentence sent)
+{
+	const char *s;
+	int i, c, nb;
+	Dictionary dict = sent->dict;
+
+	sent->length = 0;
+
+	if (dict->left_wall_defined)
+		if (!issue_sentence_word(sent, LEFT_WALL_WORD)) return FALSE;
+
+	for (i=0; i<n; i++) {
+		if ((tokens[i] == NULL) || (*tokens[i] == '\0')) {
+			lperror(SEPARATE, ". Token %d is empty.\n", i);
+			return FALSE;
+		}
+		for (s = tokens[i]; (nb = utf8_next(s, &c)) > 0; s += nb) ;
+		if (nb < 0) {
+			lperror(CHARSET, "in token %d, at byte %d\n", i, (int) (s - tokens[i]));
+			return FALSE;
+		}
+		if (!issue_sentence_word(sent, tokens[i])) return FALSE;
+	}
+
+	if (dict->right_wall_defined)
+		if (!issue_sentence_word(sent, RIGHT_WALL_WORD)) return FALSE;
+
+	return (sent->length > dict->left_wall_defined + dict->right_wall_defined);
+}
+
 static int special_string(Sentence sent, int i, const char * s) {
 	X_node * e;
 	if (boolean_dictionary_lookup(sent->dict, s)) {
@@ -615,7 +776,7 @@ static int guessed_string(Sentence sent, int i, const char * s, const char * typ
 	}
 }
 
-static void handle_unknown_word(Sentence sent, int i, char * s) {
+static void handle_unknown_word(Sentence sent, int i, const char * s) {
   /* puts into word[i].x the expression for the unknown word */
   /* the parameter s is the word that was not in the dictionary */
   /* it massages the names to have the corresponding subscripts */
@@ -644,6 +805,112 @@ static void handle_unknown_word(Sentence sent, int i, char * s) {
 	}
 }
 
+/*
+ * The word cache keeps the expressions of a word as the Exp of each
+ * X_node in the dictionary, which lasts as long as the cache, and
+ * where its string comes from: the dictionary, the word itself, or a
+ * name made up for it, kept after the entries.  The key is the word,
+ * after an 'X'.
+ */
+typedef struct {
+	Exp *        exp;
+	const char * string;  /* in the dictionary, or NULL */
+	int          name;    /* offset of the made-up name, or 0 for the word */
+} Cached_expression;
+
+/**
+ * Builds the expressions of word i from the word cache, and returns
+ * TRUE, or returns FALSE if the cache doesn't have them.
+ */
+static int cached_word_expressions(Sentence sent, int i)
+{
+	char key[MAX_WORD+2];
+	char *val;
+	int key_len, size, n, j;
+	Cached_expression *ce;
+	X_node *x, **tail;
+
+	if (sent->dict->word_cache == NULL) return FALSE;
+	key[0] = 'X';
+	strcpy(key+1, sent->word[i].string);
+	key_len = strlen(key);
+	val = word_cache_lookup(sent->dict->word_cache, key, key_len, &size);
+	if (val == NULL) return FALSE;
+
+	memcpy(&n, val, sizeof(int));
+	ce = (Cached_expression *) (val + sizeof(Cached_expression));
+	tail = &sent->word[i].x;
+	for (j=0; j<n; j++) {
+		x = (X_node *) xalloc(sizeof(X_node));
+		x->exp = copy_Exp(ce[j].exp);
+		if (ce[j].string != NULL) x->string = ce[j].string;
+		else if (ce[j].name != 0) x->string = string_set_add(val + ce[j].name, sent->string_set);
+		else x->string = sent->word[i].string;
+		*tail = x;
+		tail = &x->next;
+	}
+	*tail = NULL;
+	word_cache_value_delete(val, size);
+	return TRUE;
+}
+
+/**
+ * Puts the expressions just built for word i, from the dictionary's
+ * entries for the word s, in the word cache.
+ */
+static void cache_word_expressions(Sentence sent, int i, const char * s)
+{
+	char key[MAX_WORD+2];
+	char *val, *p;
+	int key_len, size, n, j;
+	Cached_expression *ce;
+	Dict_node *dn, *dn_head;
+	X_node *x;
+
+	if (sent->dict->word_cache == NULL) return;
+	key[0] = 'X';
+	strcpy(key+1, sent->word[i].string);
+	key_len = strlen(key);
+
+	n = 0;
+	size = 0;
+	for (x = sent->word[i].x; x != NULL; x = x->next) {
+		n++;
+		size += strlen(x->string) + 1;
+	}
+	/* The first entry is taken up by the count, to keep the rest aligned */
+	size += (n+1)*sizeof(Cached_expression);
+	val = (char *) exalloc(size);
+	memcpy(val, &n, sizeof(int));
+	ce = (Cached_expression *) (val + sizeof(Cached_expression));
+	p = val + (n+1)*sizeof(Cached_expression);
+
+	/* build_word_expressions() lists the entries back to front */
+	dn_head = dictionary_lookup_list(sent->dict, s);
+	for (j=n-1, dn = dn_head; dn != NULL; j--, dn = dn->right) {
+		ce[j].exp = dn->exp;
+	}
+	for (j=0, x = sent->word[i].x; x != NULL; j++, x = x->next) {
+		ce[j].string = NULL;
+		ce[j].name = 0;
+		if (x->string == sent->word[i].string) continue;
+		for (dn = dn_head; dn != NULL; dn = dn->right) {
+			if (x->string == dn->string) break;
+		}
+		if (dn != NULL) {
+			ce[j].string = dn->string;
+		} else {
+			strcpy(p, x->string);
+			ce[j].name = p - val;
+			p += strlen(p) + 1;
+		}
+	}
+	free_lookup_list(dn_head);
+
+	word_cache_add(sent->dict->word_cache, key, key_len, val, size);
+	exfree(val, size);
+}
+
 /**
  * Corrects case of first word, fills in other proper nouns, and
  * builds the expression lists for the resulting words.
@@ -664,7 +931,9 @@ static void handle_unknown_word(Sentence sent, int i, char * s) {
 int build_sentence_expressions(Sentence sent)
 {
 	int i, first_word;  /* the index of the first word after the wall */
-	char *s, *u, temp_word[MAX_WORD+1];
+	const char *s, *u;
+	char temp_word[MAX_WORD+1];
+	const char *lookup;
 	X_node * e;
 	Dictionary dict = sent->dict;
 
@@ -679,27 +948,33 @@ int build_sentence_expressions(Sentence sent)
 	for (i=0; i<sent->length; i++)
 	{
 		s = sent->word[i].string;
+		if (cached_word_expressions(sent, i)) continue;
+		lookup = s;
 		if (boolean_dictionary_lookup(sent->dict, s))
 		{
 			sent->word[i].x = build_word_expressions(sent, s);
 		}
 		else if (is_utf8_upper(s) && is_s_word(s) && dict->pl_capitalized_word_defined) 
 		{
+			lookup = PL_PROPER_WORD;
 			if (!special_string(sent, i, PL_PROPER_WORD)) return FALSE;
 		}
 		else if (is_utf8_upper(s) && dict->capitalized_word_defined)
 		{
+			lookup = PROPER_WORD;
 			if (!special_string(sent, i, PROPER_WORD)) return FALSE;
 		}
 		else if (is_number(s) && dict->number_word_defined)
 		{
 			/* we know it's a plural number, or 1 */
 			/* if the string is 1, we'll only be here if 1's not in the dictionary */
+			lookup = NUMBER_WORD;
 			if (!special_string(sent, i, NUMBER_WORD)) return FALSE;
 		}
 		else if (ishyphenated(s) && dict->hyphenated_word_defined)
 		{
 			/* singular hyphenated */
+			lookup = HYPHENATED_WORD;
 			if (!special_string(sent, i, HYPHENATED_WORD)) return FALSE;
 		} 
 		/* XXX
@@ -710,22 +985,27 @@ int build_sentence_expressions(Sentence sent)
 		 */
 		else if (is_ing_word(s) && dict->ing_word_defined) 
 		{
+			lookup = ING_WORD;
 			if (!guessed_string(sent, i, s, ING_WORD)) return FALSE;
 		}
 		else if (is_s_word(s) && dict->s_word_defined)
 		{
+			lookup = S_WORD;
 			if (!guessed_string(sent, i, s, S_WORD)) return FALSE;
 		}
 		else if (is_ed_word(s) && dict->ed_word_defined)
 		{
+			lookup = ED_WORD;
 			if (!guessed_string(sent, i, s, ED_WORD)) return FALSE;
 		}
 		else if (is_ly_word(s) && dict->ly_word_defined)
 		{
+			lookup = LY_WORD;
 			if (!guessed_string(sent, i, s, LY_WORD)) return FALSE;
 		}
 		else if (dict->unknown_word_defined && dict->use_unknown_word)
 		{
+			lookup = UNKNOWN_WORD;
 			handle_unknown_word(sent, i, s);
 		}
 		else 
@@ -735,6 +1015,7 @@ int build_sentence_expressions(Sentence sent)
 			 */
 			assert(FALSE, "I should have found that word.");
 		}
+		cache_word_expressions(sent, i, lookup);
 	}
 
 	/* Under certain cases--if it's the first word of the sentence,
@@ -744,7 +1025,7 @@ int build_sentence_expressions(Sentence sent)
 	 */
 	for (i=0; i<sent->length; i++)
 	{
-		if (! (i==first_word || (i>0 && strcmp(":", sent->word[i-1].string)==0) || post_quote[i]==1) ) continue;
+		if (! (i==first_word || (i>0 && strcmp(":", sent->word[i-1].string)==0) || sent->word[i].post_quote==1) ) continue;
 		s = sent->word[i].string;
 
 		if (is_utf8_upper(s))
@@ -770,8 +1051,8 @@ int build_sentence_expressions(Sentence sent)
 					/* If the upper-case version isn't there,
 					 * replace the u.c. disjuncts with l.c. ones.
 					 */
-					safe_strcpy(s,u, MAX_WORD);
-					e = build_word_expressions(sent, s);
+					sent->word[i].string = u;
+					e = build_word_expressions(sent, u);
 					free_X_nodes(sent->word[i].x);
 					sent->word[i].x = e;
 				}
@@ -792,7 +1073,7 @@ int build_sentence_expressions(Sentence sent)
 int sentence_in_dictionary(Sentence sent)
 {
 	int w, ok_so_far;
-	char * s;
+	const char * s;
 	Dictionary dict = sent->dict;
 	char temp[1024];
 
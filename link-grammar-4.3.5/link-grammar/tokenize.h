@@ -10,6 +10,9 @@
 /* forms, with or without modification, subject to certain conditions.          */
 /*                                                                              */
 /********************************************************************************/
+void build_affix_lists(Dictionary dict);
+void free_affix_lists(Dictionary dict);
 int separate_sentence(char * s, Sentence sent);
+int separate_tokens(const char ** tokens, int n, Sentence sent);
 int build_sentence_expressions(Sentence sent);
 int sentence_in_dictionary(Sentence sent);
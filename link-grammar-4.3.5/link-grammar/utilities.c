@@ -17,6 +17,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 #ifdef ENABLE_BINRELOC
 #include "prefix.h"
@@ -129,18 +131,73 @@ strtok_r (char *s, const char *delim, char **saveptr)
 /* ============================================================= */
 /* UTF8 utilities */
 
+/**
+ * Decodes the UTF-8 character at s into *c.  Returns the number of
+ * bytes in it, 0 at the end of the string, or -1 if s doesn't hold
+ * a well-formed character.
+ */
+int utf8_next(const char * s, int * c)
+{
+	const unsigned char * u = (const unsigned char *) s;
+	int nb, i, min;
+
+	if (u[0] < 0x80) {
+		*c = u[0];
+		return (u[0] != 0);
+	}
+	if ((u[0] & 0xe0) == 0xc0) { nb = 2; min = 0x80; *c = u[0] & 0x1f; }
+	else if ((u[0] & 0xf0) == 0xe0) { nb = 3; min = 0x800; *c = u[0] & 0x0f; }
+	else if ((u[0] & 0xf8) == 0xf0) { nb = 4; min = 0x10000; *c = u[0] & 0x07; }
+	else return -1;
+
+	for (i=1; i<nb; i++) {
+		if ((u[i] & 0xc0) != 0x80) return -1;
+		*c = (*c << 6) | (u[i] & 0x3f);
+	}
+	if ((*c < min) || (*c > 0x10ffff) || ((*c >= 0xd800) && (*c <= 0xdfff))) return -1;
+	return nb;
+}
+
+/**
+ * Encodes the character c into s as UTF-8, and returns the number of
+ * bytes it took, at most four.  No terminating null is written.
+ */
+int utf8_put(char * s, int c)
+{
+	unsigned char * u = (unsigned char *) s;
+
+	if (c < 0x80) { u[0] = c; return 1; }
+	if (c < 0x800) {
+		u[0] = 0xc0 | (c >> 6);
+		u[1] = 0x80 | (c & 0x3f);
+		return 2;
+	}
+	if (c < 0x10000) {
+		u[0] = 0xe0 | (c >> 12);
+		u[1] = 0x80 | ((c >> 6) & 0x3f);
+		u[2] = 0x80 | (c & 0x3f);
+		return 3;
+	}
+	u[0] = 0xf0 | (c >> 18);
+	u[1] = 0x80 | ((c >> 12) & 0x3f);
+	u[2] = 0x80 | ((c >> 6) & 0x3f);
+	u[3] = 0x80 | (c & 0x3f);
+	return 4;
+}
+
 /**
  * Downcase the first letter of the word.
  */
 void downcase_utf8_str(char *to, const char * from, size_t usize)
 {
-	wchar_t c;
+	int c;
 	int i, nbl, nbh;
-	char low[MB_LEN_MAX];
+	char low[4];
 
-	nbh = mbtowc (&c, from, 4);
+	nbh = utf8_next(from, &c);
+	if (nbh <= 0) { safe_strcpy(to, from, usize); return; }
 	c = towlower(c);
-	nbl = wctomb(low, c);
+	nbl = utf8_put(low, c);
 
 	/* Check for error on an in-place copy */
 	if ((nbh < nbl) && (to == from))
@@ -165,13 +222,14 @@ void downcase_utf8_str(char *to, const char * from, size_t usize)
  */
 void upcase_utf8_str(char *to, const char * from, size_t usize)
 {
-	wchar_t c;
+	int c;
 	int i, nbl, nbh;
-	char low[MB_LEN_MAX];
+	char low[4];
 
-	nbh = mbtowc (&c, from, 4);
+	nbh = utf8_next(from, &c);
+	if (nbh <= 0) { safe_strcpy(to, from, usize); return; }
 	c = towupper(c);
-	nbl = wctomb(low, c);
+	nbl = utf8_put(low, c);
 
 	/* Check for error on an in-place copy */
 	if ((nbh < nbl) && (to == from))
@@ -198,6 +256,25 @@ int max_space_in_use;
 int space_in_use;
 int max_external_space_in_use;
 int external_space_in_use;
+Resources charged_resources;
+
+/**
+ * Adds size (which may be negative) to the space in use, both in all
+ * and by the parse under way, if there is one.  A parse is limited
+ * by what it has charged to it, so neither the dictionary nor any
+ * other sentence counts against its max_memory.
+ */
+void account_space(int size)
+{
+	space_in_use += size;
+	if (space_in_use > max_space_in_use) max_space_in_use = space_in_use;
+	if (charged_resources != NULL) {
+		charged_resources->space_in_use += size;
+		if (charged_resources->space_in_use > charged_resources->max_space_in_use) {
+			charged_resources->max_space_in_use = charged_resources->space_in_use;
+		}
+	}
+}
 
 /**
  * To allow printing of a nice error message, and keep track of the
@@ -206,8 +283,7 @@ int external_space_in_use;
 void * xalloc(int size)
 {
 	char * p = (char *) malloc(size);
-	space_in_use += size;
-	if (space_in_use > max_space_in_use) max_space_in_use = space_in_use;
+	account_space(size);
 	if ((p == NULL) && (size != 0)){
 		printf("Ran out of space.\n");
 		abort();
@@ -218,7 +294,7 @@ void * xalloc(int size)
 
 void xfree(void * p, int size)
 {
-	space_in_use -= size;
+	account_space(-size);
 	free(p);
 }
 
@@ -499,6 +575,26 @@ FILE *dictopen(const char *filename, const char *how)
 	return NULL;
 }
 
+/**
+ * file_identity() - fold the size and modification time of an open
+ * file into *identity.  Dictionaries use this to tell whether parses
+ * saved earlier were made from the same data files.
+ */
+void file_identity(FILE *fp, unsigned int *identity)
+{
+	struct stat st;
+	unsigned int val[2];
+	int i;
+
+	if (fstat(fileno(fp), &st) != 0) return;
+	val[0] = (unsigned int) st.st_size;
+	val[1] = (unsigned int) st.st_mtime;
+	for (i=0; i<2; i++) {
+		*identity ^= val[i];
+		*identity *= 16777619U;
+	}
+}
+
 /* ======================================================== */
 /* Random number stuff below. Can this be replaced by 
  * standard system API's ??
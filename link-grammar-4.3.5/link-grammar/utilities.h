@@ -61,35 +61,40 @@ char * strtok_r (char *s, const char *delim, char **saveptr);
 
 #endif /* _WIN32 */
 
+int utf8_next(const char * s, int * c);
+int utf8_put(char * s, int c);
+
+/* The is_utf8_*() tests decode s as UTF-8 whatever the locale, and
+   return the number of bytes in its first character if it is one. */
 static inline int is_utf8_upper(const char *s)
 {
-	wchar_t c;
-	int nbytes = mbtowc(&c, s, 4);
-	if (iswupper(c)) return nbytes;
+	int c;
+	int nbytes = utf8_next(s, &c);
+	if ((nbytes > 0) && iswupper(c)) return nbytes;
 	return 0;
 }
 
 static inline int is_utf8_alpha(const char *s)
 {
-	wchar_t c;
-	int nbytes = mbtowc(&c, s, 4);
-	if (iswalpha(c)) return nbytes;
+	int c;
+	int nbytes = utf8_next(s, &c);
+	if ((nbytes > 0) && iswalpha(c)) return nbytes;
 	return 0;
 }
 
 static inline int is_utf8_digit(const char *s)
 {
-	wchar_t c;
-	int nbytes = mbtowc(&c, s, 4);
-	if (iswdigit(c)) return nbytes;
+	int c;
+	int nbytes = utf8_next(s, &c);
+	if ((nbytes > 0) && iswdigit(c)) return nbytes;
 	return 0;
 }
 
 static inline int is_utf8_space(const char *s)
 {
-	wchar_t c;
-	int nbytes = mbtowc(&c, s, 4);
-	if (iswspace(c)) return nbytes;
+	int c;
+	int nbytes = utf8_next(s, &c);
+	if ((nbytes > 0) && iswspace(c)) return nbytes;
 	return 0;
 }
 
@@ -111,18 +116,18 @@ static inline const char * skip_utf8_upper(const char * s)
  */
 static inline int utf8_upper_match(const char * s, const char * t)
 {
-	wchar_t ws, wt;
+	int ws, wt;
 	int ns, nt;
 
-	ns = mbtowc(&ws, s, 4);
-	nt = mbtowc(&wt, t, 4);
-	while (iswupper(ws) || iswupper(wt))
+	ns = utf8_next(s, &ws);
+	nt = utf8_next(t, &wt);
+	while (((ns > 0) && iswupper(ws)) || ((nt > 0) && iswupper(wt)))
 	{
-		if (ws != wt) return FALSE;
+		if ((ns <= 0) || (nt <= 0) || (ws != wt)) return FALSE;
 		s += ns;
 		t += nt;
-		ns = mbtowc(&ws, s, 4);
-		nt = mbtowc(&wt, t, 4);
+		ns = utf8_next(s, &ws);
+		nt = utf8_next(t, &wt);
 	}
 	return TRUE;
 }
@@ -135,6 +140,7 @@ void safe_strcat(char *u, const char *v, size_t usize);
 char *safe_strdup(const char *u);
 
 void xfree(void *, int);
+void account_space(int);
 void exfree(void *, int);
 void init_randtable(void);
 int  next_power_of_two_up(int);
@@ -152,6 +158,7 @@ char * get_default_locale(void);
 char * join_path(const char * prefix, const char * suffix);
 
 FILE *dictopen(const char *filename, const char *how);
+void file_identity(FILE *fp, unsigned int *identity);
 void set_data_dir(const char * path);
 
 #endif
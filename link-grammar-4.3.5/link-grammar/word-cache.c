@@ -0,0 +1,298 @@
+/********************************************************************************/
+/* Copyright (c) 2004                                                           */
+/* Daniel Sleator, David Temperley, and John Lafferty                           */
+/* All rights reserved                                                          */
+/*                                                                              */
+/* Use of the link grammar parsing system is subject to the terms of the        */
+/* license set forth in the LICENSE file included with this software,           */
+/* and also available at http://www.link.cs.cmu.edu/link/license.html           */
+/* This license allows free redistribution and use in source and binary         */
+/* forms, with or without modification, subject to certain conditions.          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <link-grammar/api.h>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+/* A word cache remembers, for the words a dictionary has seen lately,
+   what the tokenizer made of them: how a token splits up into words,
+   and where the expressions of a word come from.  Text is mostly made
+   of the same few thousand words, so nearly every token is found here
+   and skips the affix stripping, the dictionary lookups and the
+   guessing of unknown words.
+
+   The cache only knows keys and values as blocks of bytes; what is in
+   them is up to tokenize.c.  A value may point into the dictionary,
+   which lasts as long as the cache does.  Lookups hand back a copy of
+   the value, so nothing is shared once the lock is let go.
+
+   Entries are kept on a list in order of use, and the least recently
+   used one is dropped whenever there are more than max_entries.
+
+   One lock serializes every word cache in the process. */
+
+#define WC_INITIAL_TABLE_SIZE 256
+
+typedef struct Word_cache_entry_s Word_cache_entry;
+struct Word_cache_entry_s {
+	Word_cache_entry * next;          /* hash chain */
+	Word_cache_entry * older, * newer;
+	unsigned int       hash;
+	int                key_len;
+	int                size;
+	char *             key;           /* followed by the value */
+};
+
+struct Word_cache_s {
+	int                  max_entries;
+	int                  N_entries;
+	long                 hits, misses;
+	int                  table_size;
+	Word_cache_entry **  table;
+	Word_cache_entry *   newest, * oldest;
+};
+
+#ifndef _WIN32
+static pthread_mutex_t word_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+#define LOCK_CACHE()   pthread_mutex_lock(&word_cache_lock)
+#define UNLOCK_CACHE() pthread_mutex_unlock(&word_cache_lock)
+#else
+#define LOCK_CACHE()
+#define UNLOCK_CACHE()
+#endif
+
+/***************************************************************
+*
+* The table and the use list.  The caller holds the lock.
+*
+****************************************************************/
+
+static void unlink_use(Word_cache *wc, Word_cache_entry *e)
+{
+	if (e->newer != NULL) e->newer->older = e->older;
+	else wc->newest = e->older;
+	if (e->older != NULL) e->older->newer = e->newer;
+	else wc->oldest = e->newer;
+	e->older = e->newer = NULL;
+}
+
+static void link_use(Word_cache *wc, Word_cache_entry *e)
+{
+	e->older = wc->newest;
+	e->newer = NULL;
+	if (wc->newest != NULL) wc->newest->newer = e;
+	else wc->oldest = e;
+	wc->newest = e;
+}
+
+static void free_entry(Word_cache_entry *e)
+{
+	exfree(e->key, e->key_len + e->size);
+	exfree(e, sizeof(Word_cache_entry));
+}
+
+static void evict(Word_cache *wc, Word_cache_entry *e)
+{
+	Word_cache_entry **p;
+
+	for (p = &wc->table[e->hash & (wc->table_size-1)]; *p != e; p = &(*p)->next)
+		;
+	*p = e->next;
+	unlink_use(wc, e);
+	wc->N_entries--;
+	free_entry(e);
+}
+
+static void trim(Word_cache *wc)
+{
+	while ((wc->N_entries > wc->max_entries) && (wc->oldest != NULL)) {
+		evict(wc, wc->oldest);
+	}
+}
+
+static void grow_table(Word_cache *wc)
+{
+	Word_cache_entry **table, *e, *next;
+	int i, size;
+
+	size = 2*wc->table_size;
+	table = (Word_cache_entry **) exalloc(size*sizeof(Word_cache_entry *));
+	for (i=0; i<size; i++) table[i] = NULL;
+	for (i=0; i<wc->table_size; i++) {
+		for (e = wc->table[i]; e != NULL; e = next) {
+			next = e->next;
+			e->next = table[e->hash & (size-1)];
+			table[e->hash & (size-1)] = e;
+		}
+	}
+	exfree(wc->table, wc->table_size*sizeof(Word_cache_entry *));
+	wc->table = table;
+	wc->table_size = size;
+}
+
+static Word_cache_entry * find(Word_cache *wc, const char *key, int key_len, unsigned int hash)
+{
+	Word_cache_entry *e;
+
+	for (e = wc->table[hash & (wc->table_size-1)]; e != NULL; e = e->next) {
+		if ((e->hash == hash) && (e->key_len == key_len) &&
+			(memcmp(e->key, key, key_len) == 0)) return e;
+	}
+	return NULL;
+}
+
+/***************************************************************
+*
+* Caches and entries
+*
+****************************************************************/
+
+Word_cache * word_cache_create(int max_entries)
+{
+	Word_cache *wc;
+	int i;
+
+	wc = (Word_cache *) exalloc(sizeof(Word_cache));
+	wc->max_entries = max_entries;
+	wc->N_entries = 0;
+	wc->hits = wc->misses = 0;
+	wc->table_size = WC_INITIAL_TABLE_SIZE;
+	wc->table = (Word_cache_entry **) exalloc(wc->table_size*sizeof(Word_cache_entry *));
+	for (i=0; i<wc->table_size; i++) wc->table[i] = NULL;
+	wc->newest = wc->oldest = NULL;
+	return wc;
+}
+
+void word_cache_delete(Word_cache *wc)
+{
+	if (wc == NULL) return;
+	LOCK_CACHE();
+	while (wc->oldest != NULL) evict(wc, wc->oldest);
+	UNLOCK_CACHE();
+	exfree(wc->table, wc->table_size*sizeof(Word_cache_entry *));
+	exfree(wc, sizeof(Word_cache));
+}
+
+/**
+ * Returns a copy of the value stored under the key, and its size in
+ * *size, or NULL if there is none.  The caller frees the copy with
+ * word_cache_value_delete().
+ */
+char * word_cache_lookup(Word_cache *wc, const char *key, int key_len, int *size)
+{
+	Word_cache_entry *e;
+	char *val = NULL;
+	unsigned int hash;
+
+	if (wc == NULL) return NULL;
+	hash = parse_cache_hash_key(key, key_len);
+
+	LOCK_CACHE();
+	e = find(wc, key, key_len, hash);
+	if (e != NULL) {
+		wc->hits++;
+		unlink_use(wc, e);
+		link_use(wc, e);
+		*size = e->size;
+		val = (char *) exalloc(e->size);
+		memcpy(val, e->key + e->key_len, e->size);
+	} else {
+		wc->misses++;
+	}
+	UNLOCK_CACHE();
+	return val;
+}
+
+void word_cache_value_delete(char *val, int size)
+{
+	exfree(val, size);
+}
+
+/**
+ * Stores a copy of the value under the key, unless the key is there
+ * already, and drops the least recently used entry if the cache is
+ * now too big.
+ */
+void word_cache_add(Word_cache *wc, const char *key, int key_len, const char *val, int size)
+{
+	Word_cache_entry *e;
+	unsigned int hash;
+
+	if (wc == NULL) return;
+	hash = parse_cache_hash_key(key, key_len);
+
+	LOCK_CACHE();
+	if (find(wc, key, key_len, hash) == NULL) {
+		e = (Word_cache_entry *) exalloc(sizeof(Word_cache_entry));
+		e->hash = hash;
+		e->key_len = key_len;
+		e->size = size;
+		e->key = (char *) exalloc(key_len + size);
+		memcpy(e->key, key, key_len);
+		memcpy(e->key + key_len, val, size);
+		e->next = wc->table[hash & (wc->table_size-1)];
+		wc->table[hash & (wc->table_size-1)] = e;
+		link_use(wc, e);
+		wc->N_entries++;
+		if (wc->N_entries > wc->table_size) grow_table(wc);
+		trim(wc);
+	}
+	UNLOCK_CACHE();
+}
+
+/***************************************************************
+*
+* The public interface
+*
+****************************************************************/
+
+/**
+ * Changes the number of words the dictionary's word cache holds.
+ * Zero or less removes the cache.  Do this before the dictionary is
+ * shared between threads.
+ */
+void dictionary_set_word_cache_size(Dictionary dict, int max_entries)
+{
+	if (max_entries <= 0) {
+		word_cache_delete(dict->word_cache);
+		dict->word_cache = NULL;
+		return;
+	}
+	if (dict->word_cache == NULL) {
+		dict->word_cache = word_cache_create(max_entries);
+		return;
+	}
+	LOCK_CACHE();
+	dict->word_cache->max_entries = max_entries;
+	trim(dict->word_cache);
+	UNLOCK_CACHE();
+}
+
+static long cache_stat(const long *field)
+{
+	long val;
+	LOCK_CACHE();
+	val = *field;
+	UNLOCK_CACHE();
+	return val;
+}
+
+int dictionary_get_word_cache_size(Dictionary dict)
+{
+	if (dict->word_cache == NULL) return 0;
+	return dict->word_cache->max_entries;
+}
+
+long dictionary_get_word_cache_hits(Dictionary dict)
+{
+	if (dict->word_cache == NULL) return 0;
+	return cache_stat(&dict->word_cache->hits);
+}
+
+long dictionary_get_word_cache_misses(Dictionary dict)
+{
+	if (dict->word_cache == NULL) return 0;
+	return cache_stat(&dict->word_cache->misses);
+}
@@ -0,0 +1,34 @@
+/********************************************************************************/
+/* Copyright (c) 2004                                                           */
+/* Daniel Sleator, David Temperley, and John Lafferty                           */
+/* All rights reserved                                                          */
+/*                                                                              */
+/* Use of the link grammar parsing system is subject to the terms of the        */
+/* license set forth in the LICENSE file included with this software,           */
+/* and also available at http://www.link.cs.cmu.edu/link/license.html           */
+/* This license allows free redistribution and use in source and binary         */
+/* forms, with or without modification, subject to certain conditions.          */
+/*                                                                              */
+/********************************************************************************/
+/**********************************************************************
+  Calling paradigm:
+   . dictionary_create() attaches a word cache to every dictionary;
+     dictionary_set_word_cache_size() resizes or removes it.
+   . separate_word() and build_sentence_expressions() in tokenize.c
+     call word_cache_lookup() with a key of their own, and on a miss
+     work the value out and hand it to word_cache_add().
+   . dictionary_delete() calls word_cache_delete().
+***********************************************************************/
+
+#ifndef _WORDCACHEH_
+#define _WORDCACHEH_
+
+#define WORD_CACHE_DEFAULT_SIZE 4096
+
+Word_cache * word_cache_create(int max_entries);
+void         word_cache_delete(Word_cache *wc);
+char *       word_cache_lookup(Word_cache *wc, const char *key, int key_len, int *size);
+void         word_cache_value_delete(char *val, int size);
+void         word_cache_add(Word_cache *wc, const char *key, int key_len, const char *val, int size);
+
+#endif
@@ -68,6 +68,8 @@ Dict_node * read_word_file(Dictionary dict, Dict_node * dn, char * filename)
 		return NULL;
 	}
 
+	file_identity(fp, &dict->identity);
+
 	/*printf("   Reading \"%s\"\n", file_name_copy);*/
 	/*printf("*"); fflush(stdout);*/
 
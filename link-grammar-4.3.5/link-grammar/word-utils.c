@@ -258,7 +258,7 @@ int sentence_contains(Sentence sent, const char * s) {
 
 void set_is_conjunction(Sentence sent) {
 	int w;
-	char * s;
+	const char * s;
 	for (w=0; w<sent->length; w++) {
 		s = sent->word[w].string;
 		sent->is_conjunction[w] = ((strcmp(s, "and")==0) || (strcmp(s, "or" )==0) ||
@@ -366,7 +366,7 @@ Dict_node * list_whole_dictionary(Dict_node *root, Dict_node *dn) {
 	return c;
 }
 
-static int easy_match(const char * s, const char * t) {
+int easy_match(const char * s, const char * t) {
 
 	/* This is like the basic "match" function in count.c - the basic connector-matching
 	   function used in parsing - except it ignores "priority" (used to handle fat links) */
@@ -30,6 +30,7 @@ BEGIN {
 	require basedir + "loadpath.rb"
 }
 
+require 'tmpdir'
 require 'spec/runner'
 require 'linkparser'
 
@@ -99,5 +100,152 @@ describe "An instance of LinkParser::Dictionary" do
 		sentence.options.verbosity.should == 0
 		sentence.options.echo_on?.should == true
 	end
+
+	it "compiles its options once, and shares them with the sentences it parses" do
+		@dict.parse_options.should be_an_instance_of( LinkParser::ParseOptions )
+		@dict.parse_options.should be_frozen()
+		@dict.parse_options.max_null_count.should == 18
+		@dict.parse( TEST_SENTENCE ).options.should equal( @dict.parse_options )
+	end
+
+	it "parses the sentences it reads from an IO, in order" do
+		reader, writer = IO.pipe
+		writer.write( "#{TEST_SENTENCE}  Mr. Smith saw\nit happen!\n\nThe cat sleeps" )
+		writer.close
+
+		sentences = []
+		@dict.parse_stream( reader ) {|sentence| sentences << sentence }
+		reader.close
+
+		sentences.should have(3).members
+		sentences.each {|sentence| sentence.should be_an_instance_of(LinkParser::Sentence) }
+		%w[dog Smith cat].zip( sentences ) {|word, sentence| sentence.to_s.should =~ /\b#{word}\b/ }
+		sentences.first.options.should equal( @dict.parse_options )
+	end
+
+	it "lets other threads run while it waits for a stream, so one of them can write it" do
+		reader, writer = IO.pipe
+		feeder = Thread.new do
+			3.times do
+				writer.write( "The cat sleeps.\n\n" )
+				sleep 0.05
+			end
+			writer.close
+		end
+
+		sentences = []
+		@dict.parse_stream( reader ) {|sentence| sentences << sentence }
+		feeder.join
+		reader.close
+
+		sentences.should have(3).members
+	end
+
+	it "raises an error if asked to parse a stream it can't read from" do
+		lambda {
+			@dict.parse_stream( TEST_SENTENCE ) {|sentence| }
+		}.should raise_error( TypeError )
+	end
+
+	it "doesn't keep a parse cache unless asked to" do
+		@dict.parse( TEST_SENTENCE )
+		@dict.cache_stats[:misses].should == 0
+		@dict.cache_stats[:bytes].should == 0
+	end
+
+	it "tokenizes the words of a repeated sentence from its word cache" do
+		first = @dict.parse( TEST_SENTENCE ).to_s
+		hits = @dict.word_cache_stats[:hits]
+
+		@dict.parse( TEST_SENTENCE ).to_s.should == first
+		@dict.word_cache_stats[:hits].should > hits
+		@dict.word_cache_stats[:max_entries].should == 4096
+	end
+
+	it "can be made without a word cache" do
+		dict = LinkParser::Dictionary.new( :verbosity => 0, :word_cache => 0 )
+		dict.options.should_not have_key( :word_cache )
+		dict.parse( TEST_SENTENCE )
+		dict.word_cache_stats[:misses].should == 0
+	end
+end
+
+describe "An instance of LinkParser::Dictionary with a parse cache" do
+
+	before( :each ) do
+		@dict = LinkParser::Dictionary.new( :verbosity => 0, :cache => 1024 * 1024 )
+	end
+
+
+	it "doesn't pass the cache size on to its sentences" do
+		@dict.options.should_not have_key( :cache )
+		lambda { @dict.parse(TEST_SENTENCE) }.should_not raise_error()
+	end
+
+	it "parses a repeated sentence from the cache" do
+		@dict.parse( TEST_SENTENCE )
+		@dict.parse( TEST_SENTENCE )
+
+		stats = @dict.cache_stats
+		stats[:max_bytes].should == 1024 * 1024
+		stats[:misses].should == 1
+		stats[:hits].should == 1
+		stats[:hit_rate].should == 0.5
+		stats[:entries].should == 1
+		stats[:bytes].should be > 0
+	end
+
+	it "gives the same linkages for a sentence from the cache" do
+		first = @dict.parse( TEST_SENTENCE ).linkages.collect {|l| l.links }
+		second = @dict.parse( TEST_SENTENCE ).linkages.collect {|l| l.links }
+
+		@dict.cache_stats[:hits].should == 1
+		second.should == first
+	end
+
+	it "doesn't hold more than its size" do
+		dict = LinkParser::Dictionary.new( :verbosity => 0, :cache => 1 )
+		dict.parse( TEST_SENTENCE )
+
+		dict.cache_stats[:entries].should == 0
+		dict.cache_stats[:evictions].should == 1
+	end
 end
 
+
+describe "An instance of LinkParser::Dictionary with a parse store" do
+
+	before( :each ) do
+		@path = File.join( Dir.tmpdir, "linkparser-spec-#{Process.pid}.lgstore" )
+		File.delete( @path ) if File.exist?( @path )
+	end
+
+	after( :each ) do
+		File.delete( @path ) if File.exist?( @path )
+	end
+
+
+	it "doesn't pass the store path on to its sentences" do
+		dict = LinkParser::Dictionary.new( :verbosity => 0, :store => @path )
+		dict.options.should_not have_key( :store )
+		File.exist?( @path ).should == true
+	end
+
+	it "gives the same linkages for a sentence from the store" do
+		writer = LinkParser::Dictionary.new( :verbosity => 0, :store => @path )
+		first = writer.parse( TEST_SENTENCE ).linkages.collect {|l| l.links }
+		writer.cache_stats[:store_records].should == 1
+
+		reader = LinkParser::Dictionary.new( :verbosity => 0, :store => @path )
+		second = reader.parse( TEST_SENTENCE ).linkages.collect {|l| l.links }
+
+		reader.cache_stats[:store_hits].should == 1
+		second.should == first
+	end
+
+	it "raises an error if the store can't be opened" do
+		lambda {
+			LinkParser::Dictionary.new( :verbosity => 0, :store => __FILE__ )
+		}.should raise_error( LinkParser::Error )
+	end
+end
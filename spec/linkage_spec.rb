@@ -64,7 +64,16 @@ describe LinkParser::Linkage do
 		@linkage.diagram.should =~ /-Ss-/
 		@linkage.diagram.should =~ /-Pa-/
 	end
-	
+
+	it "can build a diagram for a sentence wider than any one line" do
+		sentence = @dict.parse( "I know" + " that you know" * 90 + ".", :max_null_count => 0 )
+		diagram = sentence.linkages.first.diagram
+
+		diagram.should_not =~ /too wide/
+		diagram.scan( /\bthat\.c\b/ ).length.should == 90
+		sentence.linkages.first.postscript_diagram( false ).should =~ /\(that\.c\)/
+	end
+
 
 	 #       LEFT-WALL      Xp      <---Xp---->  Xp        .
 	 # (m)   LEFT-WALL      Wd      <---Wd---->  Wd        flag.n
@@ -272,6 +281,60 @@ describe LinkParser::Linkage do
 	end
 
 
+	it "builds its words and links once and freezes them" do
+		@linkage.words.should be_frozen()
+		@linkage.words.should equal( @linkage.words )
+		@linkage.links.should be_frozen()
+		@linkage.links.should equal( @linkage.links )
+		@linkage.links.each {|link| link.should be_frozen() }
+
+		@linkage.link( 3 ).should equal( @linkage.links[3] )
+		@linkage.link( 3 ).lword.should equal( @linkage.words[@linkage.link_lword(3)] )
+		@linkage.link( 3 ).desc.should == LinkParser::Linkage::LinkTypes[:S]
+	end
+
+
+	it "can be packed into a String and rebuilt from it" do
+		packed = @linkage.to_packed
+		packed.should be_a_kind_of( String )
+
+		linkage = LinkParser::Linkage.from_packed( packed, @dict )
+		linkage.words.should == @linkage.words
+		linkage.links.should == @linkage.links
+		linkage.diagram.should == @linkage.diagram
+		linkage.link_cost.should == @linkage.link_cost
+		linkage.violation_name.should == @linkage.violation_name
+		linkage.constituent_tree.should == []
+	end
+
+
+	it "refuses to rebuild itself from a String that isn't a packed linkage" do
+		lambda {
+			LinkParser::Linkage.from_packed( @linkage.to_packed[0..-2], @dict )
+		}.should raise_error( LinkParser::Error )
+	end
+
+	it "refuses to rebuild itself from a packed linkage whose counts run past its end" do
+		packed = @linkage.to_packed
+		# the image of the linkage starts with its own size, then its word count
+		image = (0...packed.length).step( 4 ).find {|i|
+			packed[i, 4].unpack( 'l' ).first == packed.length - i
+		}
+		packed[image + 4, 4] = [ 0x40000001 ].pack( 'l' )
+
+		lambda {
+			LinkParser::Linkage.from_packed( packed, @dict )
+		}.should raise_error( LinkParser::Error )
+	end
+
+
+	it "can give back its memory before it's collected" do
+		@linkage.memsize.should be > 0
+		@linkage.free
+		lambda { @linkage.diagram }.should raise_error( LinkParser::Error )
+	end
+
+
 	it "knows what word is the verb in the sentence" do
 		@linkage.verb.should == "was"
 	end
@@ -334,6 +397,20 @@ describe LinkParser::Linkage do
 		rval.first.children.collect {|n| n.label }.should include( 'NP', 'VP', '.' )
 	end
 	
+	it "returns its constituent tree flattened into an Array in pre-order" do
+		@linkage.constituents.should == [
+			[:S,     nil, 0, 4],
+			[:NP,    0,   0, 1],
+			["The",  1,   0, 0],
+			["flag", 1,   1, 1],
+			[:VP,    0,   2, 3],
+			["was",  4,   2, 2],
+			[:ADJP,  4,   3, 3],
+			["wet",  6,   3, 3],
+			[".",    0,   4, 4],
+		]
+	end
+
 	it "returns 0 as the number of the current sublinkage since it has no conjunctions" do
 		@linkage.current_sublinkage.should == 0
 	end
@@ -410,7 +487,16 @@ describe LinkParser::Linkage do
 			@linkage.current_sublinkage = 1
 			@linkage.object.should == 'curb'
 		end
-	
+
+
+		it "leaves the current sublinkage alone when working out its constituents" do
+			@linkage.current_sublinkage = 1
+			tree = @linkage.constituent_tree_string( 2 )
+			@linkage.current_sublinkage.should == 1
+			@linkage.constituents.first.should == [ :S, nil, 0, 10 ]
+			@linkage.constituent_tree_string( 2 ).should == tree
+		end
+
 	end
 
 
@@ -62,6 +62,52 @@ describe LinkParser::ParseOptions do
 		@opts.display_links?.should == false
 	end
 
+	it "can be frozen so it can be shared" do
+		@opts.freeze
+		lambda { @opts.verbosity = 0 }.should raise_error()
+		@opts.verbosity.should == 1
+	end
+
+	it "copies itself without changing the original when merged with a Hash" do
+		@opts.freeze
+		merged = @opts.merge( :verbosity => 0, :max_null_count => 3 )
+		merged.should_not be_frozen()
+		merged.verbosity.should == 0
+		merged.max_null_count.should == 3
+		@opts.verbosity.should == 1
+		@opts.max_null_count.should == 0
+	end
+
+	it "changes itself in place when merged with another ParseOptions, for the linkages using it" do
+		dict = LinkParser::Dictionary.new( :verbosity => 0 )
+		@opts.max_wall_msecs = 5000
+		linkage = dict.parse( "The cat runs.", @opts ).linkages.first
+		linkage.diagram.should_not =~ /RIGHT-WALL/
+
+		@opts.merge!( LinkParser::ParseOptions.new(:display_walls => true, :max_null_count => 2) )
+		@opts.max_null_count.should == 2
+		@opts.max_wall_msecs.should == -1
+		linkage.diagram.should =~ /RIGHT-WALL/
+	end
+
+	it "makes unfrozen copies" do
+		@opts.max_null_count = 4
+		copy = @opts.freeze.dup
+		copy.should_not be_frozen()
+		copy.max_null_count.should == 4
+	end
+
+	it "keeps its time limits in milliseconds" do
+		@opts.max_parse_time.should == -1
+		@opts.max_wall_msecs.should == -1
+		@opts.max_parse_time = 2
+		@opts.max_parse_msecs.should == 2000
+		@opts.max_parse_msecs = 250
+		@opts.max_parse_time.should == 1
+		@opts.max_wall_msecs = 500
+		@opts.max_wall_msecs.should == 500
+	end
+
 	it "supports all the members mentioned in the documentation" do
 		pending "some of them aren't implemented in the link-grammar library"
 		@opts.all_short?.should     == false	# Not in the API
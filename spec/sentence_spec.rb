@@ -30,6 +30,7 @@ BEGIN {
 	require basedir + 'loadpath.rb'
 }
 
+require 'rbconfig'
 require 'spec/runner'
 require 'linkparser'
 
@@ -74,6 +75,136 @@ describe LinkParser::Sentence do
 	end
 
 
+	it "gives up on a parse that runs out of time, without holding it against the next one" do
+		opts = @dict.parse_options.merge( :max_wall_msecs => 1, :max_null_count => 10 ).freeze
+		long = LinkParser::Sentence.new( "Although it had been raining for most of the " +
+			"afternoon, the children who lived in the old house at the end of the street " +
+			"decided that they would go outside and play in the mud with their dogs, which " +
+			"made their parents who were watching from the window very unhappy indeed " +
+			"because they had just cleaned the kitchen floor and the hallway", @dict )
+
+		start = Time.now
+		long.parse( opts )
+		( Time.now - start ).should be < 10
+
+		@sentence.parse( opts.merge(:max_wall_msecs => 5000) ).should == 1
+	end
+
+	it "can race its parse passes against one deadline instead of giving each its own" do
+		long = LinkParser::Sentence.new( "Although it had been raining for most of the " +
+			"afternoon, the children who lived in the old house at the end of the street " +
+			"decided that they would go outside and play in the mud with their dogs, which " +
+			"made their parents who were watching from the window very unhappy indeed " +
+			"because they had just cleaned the kitchen floor and the hallway", @dict )
+
+		start = Time.now
+		long.parse_racing( :max_wall_msecs => 1000, :allow_null => true )
+		( Time.now - start ).should be < 2
+
+		@sentence.parse_racing( :max_wall_msecs => 1000 ).should == 1
+	end
+
+	it "can be parsed again, trying the cheapest disjuncts first" do
+		opts = { :max_null_count => 0 }
+		sentence = LinkParser::Sentence.new( "Last week I saw a great movie", @dict )
+		sentence.parse( opts.merge(:disjunct_cost => 0) ).should == 0
+
+		count = sentence.reparse( opts.merge(:disjunct_cost => 2, :cost_staged => true) )
+		count.should be > 0
+		sentence.linkages.collect {|linkage| linkage.diagram }.should ==
+			@dict.parse( "Last week I saw a great movie", opts.merge(:disjunct_cost => 1) ).
+			linkages.collect {|linkage| linkage.diagram }
+	end
+
+	it "won't build the linkages it gave out before it was parsed again from the new parse" do
+		sentence = @dict.parse( "I saw the man with the telescope." )
+		linkages = sentence.linkages
+		diagram = linkages.last.diagram
+
+		sentence.reparse( :disjunct_cost => 1 )
+		lambda { linkages.first.diagram }.should raise_error( LinkParser::Error )
+		linkages.last.diagram.should == diagram
+		sentence.linkages.first.diagram.should =~ /telescope/
+	end
+
+	it "is left as it was if it can't be parsed again with the options it's given" do
+		sentence = @dict.parse( "I saw the man with the telescope." )
+		linkages = sentence.linkages
+		num_links = sentence.num_links
+
+		lambda { sentence.reparse( :verbosity => 'loud' ) }.should raise_error( TypeError )
+		sentence.should be_parsed()
+		sentence.num_links.should == num_links
+		linkages.first.diagram.should =~ /telescope/
+	end
+
+	it "parses unknown words with the categories that fit them best, falling back to the rest" do
+		stats = @dict.unknown_word_stats
+		sentence = LinkParser::Sentence.new( "The blorf ran to the gronk.", @dict )
+		sentence.parse( :unknown_word_disjuncts => 1 ).should == 1
+		sentence.linkages.first.words.should include( 'blorf[?].n', 'gronk[?].n' )
+
+		sentence = LinkParser::Sentence.new( "My friend grokked the snarfle that Bob " +
+			"gave to the wibbly glorp yesterday.", @dict )
+		sentence.parse( :unknown_word_disjuncts => 1, :max_null_count => 3 )
+		sentence.null_count.should == 1
+
+		@dict.unknown_word_stats[:limited].should == stats[:limited] + 2
+		@dict.unknown_word_stats[:fallbacks].should == stats[:fallbacks] + 1
+	end
+
+	it "knows the most memory its parse used, and is limited only by that" do
+		@sentence.parse( :max_memory => 1024 * 1024 )
+		@sentence.num_linkages_found.should == 1
+		@sentence.peak_memory.should be > 0
+		@sentence.peak_memory.should be < 1024 * 1024
+	end
+
+	it "doesn't take freeing its last parse off the memory the next one used" do
+		sentence = @dict.parse( "The cat and the dog ran to the big house." )
+		peak = sentence.peak_memory
+		sentence.linkages.first.diagram
+
+		sentence.reparse
+		sentence.peak_memory.should be >= peak
+	end
+
+	it "can let go of its parse, and parse again for linkages it hasn't built yet" do
+		sentence = @dict.parse( "The cat and the dog ran to the big house." )
+		diagrams = sentence.linkages.collect {|linkage| linkage.diagram }
+		memsize = sentence.memsize
+
+		sentence.compact!
+		sentence.memsize.should be < memsize
+		sentence.linkages.collect {|linkage| linkage.diagram }.should == diagrams
+	end
+
+	it "compacts itself once its options say enough linkages have been built" do
+		@sentence.parse( :compact_after => 1 )
+		memsize = @sentence.memsize
+		@sentence.linkages.first.diagram
+		@sentence.memsize.should be < memsize
+	end
+
+	it "can give back its memory before it's collected, leaving its linkages usable" do
+		@sentence.parse
+		@sentence.memsize.should be > 0
+		linkage = @sentence.linkages.first
+		linkage.diagram
+
+		@sentence.free
+		lambda { @sentence.num_linkages_found }.should raise_error( LinkParser::Error )
+		linkage.diagram.should =~ /LEFT-WALL/
+		lambda { linkage.constituent_tree }.should raise_error( LinkParser::Error )
+	end
+
+	it "uses a ParseOptions object given to it as it is" do
+		opts = @dict.parse_options.merge( :verbosity => 0 ).freeze
+		@sentence.parse( opts )
+		@sentence.options.should equal( opts )
+	end
+
+
 	it "knows how many words are in it, including walls and punctuation" do
 		@sentence.length == 6
 	end
@@ -96,6 +227,17 @@ describe LinkParser::Sentence do
 		@sentence.linkages.first.should be_an_instance_of( LinkParser::Linkage )
 	end
 
+	it "builds each of its linkages when it's first used" do
+		sentence = @dict.parse( "I saw the man with the telescope." )
+		linkages = sentence.linkages
+		linkages.length.should > 1
+
+		linkages.last.links.should == 
+			LinkParser::Linkage.new( linkages.length - 1, sentence ).links
+		linkages.first.links.should ==
+			LinkParser::Linkage.new( 0, sentence ).links
+	end
+
 	it "can return words at a specified position" do
 		@sentence.word( 0 ).should == 'LEFT-WALL'
 		@sentence[ -1 ].should == 'RIGHT-WALL'
@@ -106,7 +248,83 @@ describe LinkParser::Sentence do
 			'LEFT-WALL', 'the', 'cat', 'runs', '.', 'RIGHT-WALL'
 		]
 	end
-	
+
+	it "splits its words at UTF-8 blanks whatever the locale" do
+		sentence = LinkParser::Sentence.new( "The\xe3\x80\x80cat\xe2\x80\x83runs.", @dict )
+		sentence.words.should == @sentence.words
+	end
+
+	it "parses words that aren't ASCII in the C locale" do
+		ruby = File.join( RbConfig::CONFIG['bindir'], RbConfig::CONFIG['ruby_install_name'] )
+		includes = $LOAD_PATH.collect {|dir| "-I#{dir}" }.join( ' ' )
+		script = %q{
+			require 'linkparser'
+			dict = LinkParser::Dictionary.new( :verbosity => 0 )
+			sentence = LinkParser::Sentence.new( "The caf\xc3\xa9-owner paid 5\xe2\x82\xac.", dict )
+			puts sentence.length, sentence.parse, sentence.linkages.first.diagram.include?( '-owner' )
+		}
+
+		lc_all = ENV['LC_ALL']
+		ENV['LC_ALL'] = 'C'
+		begin
+			output = IO.popen( "#{ruby} #{includes}", 'r+' ) do |child|
+				child.write( script )
+				child.close_write
+				child.read
+			end
+		ensure
+			ENV['LC_ALL'] = lc_all
+		end
+
+		length, count, owner = output.split
+		length.should == '7'
+		count.to_i.should be > 0
+		owner.should == 'true'
+	end
+
+	it "can be made from words that are already tokenized, without splitting them again" do
+		sentence = LinkParser::Sentence.new( %w[The cat runs .], @dict )
+		sentence.words.should == @sentence.words
+		sentence.parse.should == 1
+
+		LinkParser::Sentence.new( %w[The cat's toy], @dict ).words.should ==
+			[ 'LEFT-WALL', 'the', "cat's", 'toy', 'RIGHT-WALL' ]
+		lambda {
+			LinkParser::Sentence.new( ['The', '', 'cat'], @dict )
+		}.should raise_error( LinkParser::Error )
+	end
+
+
+	it "can parse a sentence longer than 250 words" do
+		sentence = LinkParser::Sentence.new( "I know" + " that you know" * 90 + ".", @dict )
+		sentence.length.should == 275
+		sentence.parse( :max_null_count => 0 ).should == 1
+		sentence.num_links.should == 274
+	end
+
+	it "can parse a long run of clauses a clause at a time, linking them at their split words" do
+		sentence = LinkParser::Sentence.new( "I came; I saw; I won.", @dict )
+		sentence.parse( :split_length => 2, :max_null_count => 0 ).should == 1
+		sentence.null_count.should == 0
+		sentence.links.find {|link|
+			link.lword == 'LEFT-WALL' && link.rword == ';' && link.label == 'Xx'
+		}.should_not be_nil
+	end
+
+	it "limits a sentence it parses a clause at a time as a whole, not a clause at a time" do
+		opts = { :split_length => 2, :max_null_count => 0 }
+		clauses = "I came; I saw; I won; I ran; I sat; I ate; I slept."
+		short = LinkParser::Sentence.new( "I came; I saw.", @dict )
+		short.parse( opts ).should == 1
+
+		sentence = LinkParser::Sentence.new( clauses, @dict )
+		sentence.parse( opts ).should == 1
+		sentence.peak_memory.should be > short.peak_memory * 2
+
+		sentence = LinkParser::Sentence.new( clauses, @dict )
+		sentence.parse( opts.merge(:max_memory => short.peak_memory * 2) ).should == 0
+	end
+
 
 	it "knows that it doesn't have any superfluous words in it" do
 		@sentence.null_count == 0